@@ -18,6 +18,10 @@
 #include <string_view>
 
 #include "Globals.h"
+#include "InputInjection.h"
+#include "InputLatency.h"
+#include "PollTiming.h"
+#include "SharedMemoryTypes.h"
 
 namespace Xidi
 {
@@ -32,7 +36,16 @@ namespace Xidi
       Metadata,
 
       /// IImportFunctions
-      ImportFunctions
+      ImportFunctions,
+
+      /// IInputLatency
+      InputLatency,
+
+      /// IInputInjection
+      InputInjection,
+
+      /// IPollTiming
+      PollTiming
     };
 
     /// Xidi API base class. All API classes must inherit from this class.
@@ -95,6 +108,82 @@ namespace Xidi
       inline IImportFunctions(void) : IXidi(EClass::ImportFunctions) {}
     };
 
+    /// Xidi API class for obtaining measurements of the latency between external producers
+    /// capturing input and applications reading it. Latency is only measured for input that
+    /// producers timestamp with a high-resolution capture time.
+    class IInputLatency : public IXidi
+    {
+    public:
+
+      /// Retrieves a summary of the input latency measured for the specified controller since the
+      /// measurements were last reset.
+      /// @param [in] controllerIdentifier Zero-based identifier of the controller of interest.
+      /// @return Summary of the measured input latency, which is empty if no latency was measured
+      /// or if the controller identifier is invalid.
+      virtual InputLatency::SSummary GetSummary(unsigned int controllerIdentifier) const = 0;
+
+      /// Discards all of the input latency measurements for the specified controller.
+      /// @param [in] controllerIdentifier Zero-based identifier of the controller of interest.
+      virtual void ResetSummary(unsigned int controllerIdentifier) = 0;
+
+    protected:
+
+      inline IInputLatency(void) : IXidi(EClass::InputLatency) {}
+    };
+
+    /// Xidi API class for injecting input directly into the virtual controllers, as an alternative
+    /// to supplying it via shared memory. Intended for modules loaded into the same process.
+    /// Injected input is held separately from input supplied via shared memory and persists until
+    /// replaced by a later injected batch. The two are merged element by element using the merge
+    /// policies configured for shared memory channels, as though injected input came from an extra
+    /// channel with lower priority than all of them.
+    class IInputInjection : public IXidi
+    {
+    public:
+
+      /// Injects a batch of input for any number of controllers and, optionally, the keyboard and
+      /// mouse. The whole batch takes effect at once, and batches take effect in the order in which
+      /// they were injected. Never blocks, so it is safe to invoke from any thread.
+      /// @param [in] controllerInputs Array of controller input to inject, at most one element per
+      /// controller. Can be `nullptr` if the count is 0.
+      /// @param [in] controllerInputCount Number of elements in the controller input array.
+      /// @param [in] keyboardMouseInput Keyboard and mouse input to inject, or `nullptr` to inject
+      /// none. Relative mouse motion is interpreted as the amount of motion to apply, not as
+      /// running totals.
+      /// @return `true` if the batch was accepted, `false` if it identifies a controller that does
+      /// not exist or if too many batches are already waiting to take effect.
+      virtual bool SubmitInput(
+          const InputInjection::SControllerInput* controllerInputs,
+          unsigned int controllerInputCount,
+          const SharedMemory::SKeyboardMouseInput* keyboardMouseInput) = 0;
+
+    protected:
+
+      inline IInputInjection(void) : IXidi(EClass::InputInjection) {}
+    };
+
+    /// Xidi API class for obtaining measurements of how regularly and how quickly physical
+    /// controllers are polled, which helps to diagnose jitter and throughput problems.
+    class IPollTiming : public IXidi
+    {
+    public:
+
+      /// Retrieves a summary of the poll timing measured for the specified controller since the
+      /// measurements were last reset.
+      /// @param [in] controllerIdentifier Zero-based identifier of the controller of interest.
+      /// @return Summary of the measured poll timing, which is empty if the controller was not
+      /// polled or if the controller identifier is invalid.
+      virtual PollTiming::SSummary GetSummary(unsigned int controllerIdentifier) const = 0;
+
+      /// Discards all of the poll timing measurements for the specified controller.
+      /// @param [in] controllerIdentifier Zero-based identifier of the controller of interest.
+      virtual void ResetSummary(unsigned int controllerIdentifier) = 0;
+
+    protected:
+
+      inline IPollTiming(void) : IXidi(EClass::PollTiming) {}
+    };
+
     /// Pointer type definition for the XidiApiGetInterface exported function.
     using TGetInterfaceFunc = IXidi* (*)(EClass apiClass);
   } // namespace Api
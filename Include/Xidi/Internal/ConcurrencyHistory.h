@@ -0,0 +1,139 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file ConcurrencyHistory.h
+ *   Thread-safe wrapper around a bounded history of data values.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <shared_mutex>
+#include <stop_token>
+
+namespace Xidi
+{
+  /// Holds a bounded history of data values in a way that is concurrency-safe following a
+  /// single-producer multiple-consumer threading model. Whereas a concurrency wrapper only holds
+  /// the most recent value, a history allows each consumer to observe every value in the order in
+  /// which it was appended, provided that the consumer does not fall behind by more than the
+  /// capacity of the history. Each consumer tracks its own position using a sequence number, which
+  /// is the number of values that have been appended up to and including the value it last saw.
+  /// @tparam DataType Underlying wrapped data type.
+  /// @tparam kCapacity Maximum number of values retained.
+  template <typename DataType, unsigned int kCapacity> class ConcurrencyHistory
+  {
+    static_assert(kCapacity > 0, "History capacity must be positive.");
+
+  public:
+
+    /// Appends a new value in a concurrency-safe way and notifies all waiting threads. If the
+    /// history is full, the oldest value is discarded.
+    /// @param [in] newData New value to be appended.
+    inline void Append(const DataType& newData)
+    {
+      {
+        std::unique_lock lock(mutex);
+        history[appendCount % kCapacity] = newData;
+        appendCount += 1;
+      }
+
+      updateNotifier.notify_all();
+    }
+
+    /// Retrieves the most recently-appended value in a concurrency-safe way.
+    /// @param [out] sequence Filled in with the sequence number of the value that is returned,
+    /// which is 0 if no values have been appended.
+    /// @return Most recently-appended value, or a default-constructed value if no values have been
+    /// appended.
+    inline DataType GetLatest(uint64_t& sequence)
+    {
+      std::shared_lock lock(mutex);
+
+      sequence = appendCount;
+      if (0 == appendCount) return DataType();
+
+      return history[(appendCount - 1) % kCapacity];
+    }
+
+    /// Waits for a value to be appended after the one the caller last saw and retrieves it. If the
+    /// caller has fallen so far behind that the next value was already discarded, the oldest value
+    /// that is still retained is retrieved instead. This function is fully concurrency-safe. If
+    /// needed, the caller can interrupt the wait using a stop token.
+    /// @param [in,out] sequence On input, sequence number of the value the caller last saw. On
+    /// output, sequence number of the retrieved value.
+    /// @param [out] externalData Filled in with the retrieved value.
+    /// @param [in] stopToken Token that allows the wait to be interrupted.
+    /// @return `true` if the wait succeeded and a value was retrieved, `false` if the wait was
+    /// interrupted.
+    inline bool WaitForNext(uint64_t& sequence, DataType& externalData, std::stop_token stopToken)
+    {
+      std::shared_lock lock(mutex);
+
+      updateNotifier.wait(
+          lock,
+          stopToken,
+          [this, sequence]() -> bool
+          {
+            return (appendCount > sequence);
+          });
+
+      if (stopToken.stop_requested()) return false;
+
+      RetrieveNext(sequence, externalData);
+      return true;
+    }
+
+    /// Retrieves the value appended after the one the caller last saw, if there is one, without
+    /// waiting. If the caller has fallen so far behind that the next value was already discarded,
+    /// the oldest value that is still retained is retrieved instead. Concurrency-safe.
+    /// @param [in,out] sequence On input, sequence number of the value the caller last saw. On
+    /// output, sequence number of the retrieved value, or unchanged if there is none.
+    /// @param [out] externalData Filled in with the retrieved value, or unchanged if there is none.
+    /// @return `true` if a value was retrieved, `false` if the caller already saw every value.
+    inline bool GetNext(uint64_t& sequence, DataType& externalData)
+    {
+      std::shared_lock lock(mutex);
+
+      if (appendCount <= sequence) return false;
+
+      RetrieveNext(sequence, externalData);
+      return true;
+    }
+
+  private:
+
+    /// Retrieves the value appended after the one the caller last saw, or the oldest value that is
+    /// still retained if that one was already discarded. Must be invoked with the mutex held and
+    /// only if at least one such value exists.
+    /// @param [in,out] sequence On input, sequence number of the value the caller last saw. On
+    /// output, sequence number of the retrieved value.
+    /// @param [out] externalData Filled in with the retrieved value.
+    inline void RetrieveNext(uint64_t& sequence, DataType& externalData) const
+    {
+      const uint64_t oldestRetainedSequence =
+          ((appendCount > kCapacity) ? (appendCount - kCapacity + 1) : 1);
+
+      sequence = ((sequence < oldestRetainedSequence) ? oldestRetainedSequence : (sequence + 1));
+      externalData = history[(sequence - 1) % kCapacity];
+    }
+
+    /// Retained values, used as a circular buffer.
+    std::array<DataType, kCapacity> history;
+
+    /// Total number of values that have ever been appended.
+    uint64_t appendCount = 0;
+
+    /// Condition variable used to wait for values to be appended.
+    std::condition_variable_any updateNotifier;
+
+    /// Mutex for protecting against concurrent accesses to the underlying wrapped data.
+    std::shared_mutex mutex;
+  };
+} // namespace Xidi
@@ -0,0 +1,114 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file ConcurrencyQueue.h
+ *   Lock-free bounded queue of data values with multiple producers and a single consumer.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Xidi
+{
+  /// Holds a bounded first-in first-out queue of data values in a way that is concurrency-safe
+  /// following a multiple-producer single-consumer threading model. Neither pushing nor popping
+  /// ever blocks: producers claim slots using an atomic compare-and-exchange and publish them by
+  /// advancing a per-slot sequence number, which the consumer observes with acquire semantics.
+  /// If the queue is full, pushing fails rather than overwriting values the consumer has not yet
+  /// popped.
+  /// @tparam DataType Underlying data type. Must be copy-assignable.
+  /// @tparam kCapacity Maximum number of values held at once.
+  template <typename DataType, unsigned int kCapacity> class ConcurrencyQueue
+  {
+    static_assert(kCapacity > 0, "Queue capacity must be positive.");
+
+  public:
+
+    inline ConcurrencyQueue(void)
+    {
+      for (unsigned int i = 0; i < kCapacity; ++i)
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    /// Pops the oldest value from the queue. Must only be invoked by the single consumer.
+    /// @param [out] data Filled in with the popped value, if there is one.
+    /// @return `true` if a value was popped, `false` if the queue is empty.
+    inline bool Pop(DataType& data)
+    {
+      SSlot& slot = slots[popPosition % kCapacity];
+      if (slot.sequence.load(std::memory_order_acquire) != (popPosition + 1)) return false;
+
+      data = slot.data;
+      slot.sequence.store(popPosition + kCapacity, std::memory_order_release);
+      popPosition += 1;
+      return true;
+    }
+
+    /// Pushes a value onto the queue. Concurrency-safe and lock-free.
+    /// @param [in] data Value to be pushed.
+    /// @return `true` if the value was pushed, `false` if the queue is full.
+    inline bool Push(const DataType& data)
+    {
+      uint64_t position = pushPosition.load(std::memory_order_relaxed);
+      SSlot* slot = nullptr;
+
+      while (true)
+      {
+        slot = &slots[position % kCapacity];
+
+        const int64_t sequenceDifference =
+            (int64_t)slot->sequence.load(std::memory_order_acquire) - (int64_t)position;
+
+        if (0 == sequenceDifference)
+        {
+          if (true ==
+              pushPosition.compare_exchange_weak(
+                  position, position + 1, std::memory_order_relaxed))
+            break;
+        }
+        else if (sequenceDifference < 0)
+        {
+          return false;
+        }
+        else
+        {
+          position = pushPosition.load(std::memory_order_relaxed);
+        }
+      }
+
+      slot->data = data;
+      slot->sequence.store(position + 1, std::memory_order_release);
+      return true;
+    }
+
+  private:
+
+    /// Holds a single value along with the sequence number that coordinates access to it. A slot
+    /// whose sequence number equals a push position is free to be claimed for that push, and one
+    /// whose sequence number is one more than a pop position holds the value for that pop.
+    struct SSlot
+    {
+      /// Sequence number of this slot.
+      std::atomic<uint64_t> sequence;
+
+      /// Value held in this slot.
+      DataType data;
+    };
+
+    /// Slots that hold queued values, used as a circular buffer.
+    std::array<SSlot, kCapacity> slots;
+
+    /// Position of the next value to be pushed, shared among all producers.
+    std::atomic<uint64_t> pushPosition = 0;
+
+    /// Position of the next value to be popped, used only by the consumer.
+    uint64_t popPosition = 0;
+  };
+} // namespace Xidi
@@ -11,14 +11,19 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <shared_mutex>
 #include <stop_token>
+#include <type_traits>
 
 namespace Xidi
 {
   /// Wraps data in a way that is concurrency-safe following a single-producer multiple-consumer
-  /// threading model.
+  /// threading model. This general version uses a reader-writer lock and therefore supports any
+  /// copyable data type.
   /// @tparam DataType Underlying wrapped data type.
   template <typename DataType> class ConcurrencyWrapper
   {
@@ -97,4 +102,122 @@ namespace Xidi
     /// Mutex for protecting against concurrent accesses to the underlying wrapped data.
     std::shared_mutex mutex;
   };
+
+  /// Wraps data in a way that is concurrency-safe following a single-producer multiple-consumer
+  /// threading model. This version is used for trivially copyable data types and is implemented as
+  /// a sequence lock, so reads never write to shared memory and hence never contend with each
+  /// other. A read that overlaps with a write is simply retried. Threads that wait for updates do
+  /// so on the sequence number itself.
+  /// @tparam DataType Underlying wrapped data type.
+  template <typename DataType>
+    requires std::is_trivially_copyable_v<DataType>
+  class ConcurrencyWrapper<DataType>
+  {
+  public:
+
+    /// Retrieves and returns the stored data in a concurrency-safe way.
+    /// @return Underlying wrapped data.
+    inline DataType Get(void) const
+    {
+      DataType snapshot;
+      ReadSnapshot(snapshot);
+      return snapshot;
+    }
+
+    /// Writes to the stored data in a concurrency-safe way.
+    /// @param [in] newData New data to be stored.
+    inline void Set(const DataType& newData)
+    {
+      // An odd sequence number indicates that a write is in progress. The sequence number is only
+      // ever modified by atomic additions, so that interrupting a wait (which adds 2) cannot
+      // disturb its parity even if it happens concurrently with a write.
+      sequence.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      std::memcpy(&data, &newData, sizeof(DataType));
+      sequence.fetch_add(1, std::memory_order_release);
+    }
+
+    /// Updates the stored data in a concurrency-safe way and notifies all waiting threads of the
+    /// change. Operations are conditional on the new data being different than the currently-stored
+    /// data.
+    /// @param [in] newData New data to be stored.
+    /// @return `true` if the new data differ from the old and hence an update was performed,
+    /// `false` otherwise.
+    inline bool Update(const DataType& newData)
+    {
+      // This unguarded read is safe because by design only one thread, the one that produces
+      // updated data, ever invokes this method. All other threads use guarded reads.
+      if (newData != data)
+      {
+        Set(newData);
+        sequence.notify_all();
+        return true;
+      }
+
+      return false;
+    }
+
+    /// Waits for the stored data to be updated.
+    /// This function is fully concurrency-safe. If needed, the caller can interrupt the wait using
+    /// a stop token.
+    /// @param [in,out] externalData On input, used to identify the last-known data for the calling
+    /// thread. On output, filled in with the updated data.
+    /// @param [in] stopToken Token that allows the wait to be interrupted.
+    /// @return `true` if the wait succeeded and an update occurred, `false` if no updates were made
+    /// due to invalid parameter or interrupted wait.
+    inline bool WaitForUpdate(DataType& externalData, std::stop_token stopToken)
+    {
+      // Waiting threads only wake up when the sequence number changes, so interrupting the wait
+      // requires changing it without affecting its parity.
+      std::stop_callback stopCallback(
+          stopToken,
+          [this]() -> void
+          {
+            sequence.fetch_add(2, std::memory_order_relaxed);
+            sequence.notify_all();
+          });
+
+      while (false == stopToken.stop_requested())
+      {
+        DataType snapshot;
+        const uint32_t snapshotSequence = ReadSnapshot(snapshot);
+
+        if (snapshot != externalData)
+        {
+          externalData = snapshot;
+          return true;
+        }
+
+        sequence.wait(snapshotSequence, std::memory_order_relaxed);
+      }
+
+      return false;
+    }
+
+  private:
+
+    /// Reads a consistent snapshot of the stored data, retrying for as long as the read overlaps
+    /// with a write.
+    /// @param [out] snapshot Filled in with a copy of the stored data.
+    /// @return Sequence number that corresponds to the snapshot.
+    inline uint32_t ReadSnapshot(DataType& snapshot) const
+    {
+      while (true)
+      {
+        const uint32_t sequenceBefore = sequence.load(std::memory_order_acquire);
+        if (0 != (sequenceBefore & 1)) continue;
+
+        std::memcpy(&snapshot, &data, sizeof(DataType));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (sequenceBefore == sequence.load(std::memory_order_relaxed)) return sequenceBefore;
+      }
+    }
+
+    /// Sequence number, which is incremented once at the start and once at the end of each write.
+    std::atomic<uint32_t> sequence = 0;
+
+    /// Wrapped data.
+    DataType data;
+  };
 } // namespace Xidi
@@ -23,9 +23,19 @@ namespace Xidi
   {
     /// Number of physical controllers that the underlying system supports.
     /// Not all will necessarily be physically present at any given time.
-    /// Maximum allowable controller identifier is one less than this value.
+    /// Controllers whose identifiers are less than this value are backed by physical hardware.
     inline constexpr uint16_t kPhysicalControllerCount = 4;
 
+    /// Maximum number of controllers that can be configured, which sizes all fixed-size
+    /// per-controller data structures. Controllers beyond the ones backed by physical hardware
+    /// receive input only from external producers. Maximum allowable controller identifier is one
+    /// less than this value.
+    inline constexpr uint16_t kMaxControllerCount = 16;
+
+    /// Number of controllers that are presented to applications if the configuration does not
+    /// specify otherwise.
+    inline constexpr uint16_t kDefaultControllerCount = kPhysicalControllerCount;
+
     /// Maximum possible reading from an XInput controller's analog stick.
     /// Value taken from XInput documentation.
     inline constexpr int32_t kAnalogValueMax = 32767;
@@ -52,7 +62,7 @@ namespace Xidi
     inline constexpr int32_t kTriggerValueMid = (kTriggerValueMax + kTriggerValueMin) / 2;
 
     /// Integer type used to identify physical controllers to the underlying system interfaces.
-    using TControllerIdentifier = std::remove_const_t<decltype(kPhysicalControllerCount)>;
+    using TControllerIdentifier = std::remove_const_t<decltype(kMaxControllerCount)>;
 
     /// Enumerates all supported axis types using DirectInput terminology.
     /// It is not necessarily the case that all of these axes are present in a virtual controller.
@@ -541,6 +551,52 @@ namespace Xidi
 
     static_assert(sizeof(SState) <= 56, "Data structure size constraint violation.");
 
+    /// Partial virtual controller state supplied by a source other than the physical controller,
+    /// such as an external producer writing to shared memory. Only those elements that are marked
+    /// as present are meaningful, and applying an overlay to a state replaces exactly those
+    /// elements and leaves all others untouched.
+    struct SStateOverlay
+    {
+      /// Element values. Only those elements marked as present are meaningful.
+      SState values;
+
+      /// Axes supplied by this overlay, one bit per axis.
+      std::bitset<static_cast<int>(EAxis::Count)> axisPresent;
+
+      /// Buttons supplied by this overlay, one bit per button.
+      std::bitset<static_cast<int>(EButton::Count)> buttonPresent;
+
+      /// POV directions supplied by this overlay, one bit per POV direction.
+      std::bitset<static_cast<int>(EPovDirection::Count)> povDirectionPresent;
+
+      constexpr bool operator==(const SStateOverlay& other) const = default;
+
+      /// Determines if this overlay supplies no elements at all.
+      /// @return `true` if applying this overlay would have no effect, `false` otherwise.
+      inline bool IsEmpty(void) const
+      {
+        return (axisPresent.none() && buttonPresent.none() && povDirectionPresent.none());
+      }
+
+      /// Replaces elements of the specified state with the elements supplied by this overlay.
+      /// @param [in,out] state State to be modified.
+      inline void ApplyTo(SState& state) const
+      {
+        for (int i = 0; i < static_cast<int>(EAxis::Count); ++i)
+        {
+          if (true == axisPresent[i]) state.axis[i] = values.axis[i];
+        }
+
+        state.button = ((state.button & ~buttonPresent) | (values.button & buttonPresent));
+
+        for (int i = 0; i < static_cast<int>(EPovDirection::Count); ++i)
+        {
+          if (true == povDirectionPresent[i])
+            state.povDirection.components[i] = values.povDirection.components[i];
+        }
+      }
+    };
+
     /// Enumerates possible statuses for physical controller devices.
     enum class EPhysicalDeviceStatus : uint8_t
     {
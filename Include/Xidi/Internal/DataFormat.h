@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <limits>
 #include <map>
 #include <memory>
@@ -269,4 +271,36 @@ namespace Xidi
     /// Complete description of the application's data format.
     const SDataFormatSpec dataFormatSpec;
   };
+
+  /// Holds an application data packet that is rendered ahead of time, whenever virtual controller
+  /// state changes, so that supplying it to the application only requires copying it. Two buffers
+  /// are used so that a packet can be rendered without disturbing the one being read.
+  class DataPacketBuffer
+  {
+  public:
+
+    /// Copies the most recently rendered data packet to the specified buffer. Concurrency-safe and
+    /// lock-free, and never blocked by a packet being rendered. If no packet was ever rendered,
+    /// the copied bytes are all 0.
+    /// @param [out] packetBuffer Buffer to which to copy the data packet.
+    /// @param [in] packetSizeBytes Number of bytes to copy, which must not exceed the maximum
+    /// allowed data packet size.
+    void Read(void* packetBuffer, TOffset packetSizeBytes) const;
+
+    /// Renders the specified virtual controller state as an application data packet and makes it
+    /// available to be read. Not concurrency-safe with respect to other renders, so the caller
+    /// must ensure that only one thread renders at a time.
+    /// @param [in] dataFormat Application data format with which to render the data packet.
+    /// @param [in] controllerState Virtual controller state to render.
+    void Render(const DataFormat& dataFormat, const Controller::SState& controllerState);
+
+  private:
+
+    /// Number of data packets rendered so far. Its least significant bit identifies the buffer
+    /// that holds the most recently rendered data packet.
+    std::atomic<uint32_t> sequence = 0;
+
+    /// Data packet buffers, which are written alternately.
+    uint8_t packet[2][DataFormat::kMaxDataPacketSizeBytes] = {};
+  };
 } // namespace Xidi
@@ -0,0 +1,93 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file InputInjection.h
+ *   Declaration of functionality for accepting input injected directly by other modules loaded
+ *   into the same process.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "SharedMemoryTypes.h"
+
+namespace Xidi
+{
+  namespace InputInjection
+  {
+    /// Maximum number of injected batches of input that can be pending at once, waiting to be
+    /// passed on to the virtual controllers.
+    inline constexpr unsigned int kPendingInputCapacity = 64;
+
+    /// Input injected for a single controller.
+    struct SControllerInput
+    {
+      /// Identifier of the controller that receives the input.
+      Controller::TControllerIdentifier controllerIdentifier;
+
+      /// Elements of the controller's state to be replaced, along with their new values. Elements
+      /// not marked as present keep the values produced by the mapper.
+      Controller::SStateOverlay overlay;
+    };
+
+    /// Single batch of injected input, as passed on to the virtual controllers.
+    struct SInjectedInput
+    {
+      /// Controllers for which input was injected, one bit per controller.
+      std::bitset<Controller::kMaxControllerCount> controllerPresent;
+
+      /// Input for each controller for which input was injected, one element per controller.
+      std::array<Controller::SStateOverlay, Controller::kMaxControllerCount> controller;
+
+      /// Indicates whether keyboard and mouse input was injected.
+      bool keyboardMousePresent;
+
+      /// Keyboard and mouse input, if injected. Relative mouse motion is applied exactly once.
+      SharedMemory::SKeyboardMouseInput keyboardMouse;
+
+      /// Time at which the input was injected, using the same clock as the `timeGetTime` function.
+      uint32_t timestamp;
+
+      /// High-resolution time at which the input was injected, in the same form as returned by
+      /// `InputLatency::CaptureTimeNow`.
+      uint32_t captureTime;
+    };
+
+    /// Retrieves the event that is signalled whenever input is injected, so that the thread that
+    /// passes it on can wait for it along with other sources of input.
+    /// @return Handle to an auto-reset event, or `nullptr` if it could not be created.
+    HANDLE GetSignalEvent(void);
+
+    /// Retrieves the oldest batch of injected input that was not yet passed on to the virtual
+    /// controllers. Not concurrency-safe, as it is intended to be invoked only by the single
+    /// thread that passes external input on to the virtual controllers.
+    /// @param [out] injectedInput Filled in with the batch of injected input, if there is one.
+    /// @return `true` if a batch of injected input was retrieved, `false` if none is pending.
+    bool ReadInjectedInput(SInjectedInput& injectedInput);
+
+    /// Injects a batch of input for any number of controllers and, optionally, the keyboard and
+    /// mouse. The whole batch is passed on to the virtual controllers at once, in the order in
+    /// which batches were injected. Concurrency-safe and lock-free.
+    /// @param [in] controllerInputs Array of controller input to inject, at most one element per
+    /// controller. Can be `nullptr` if the count is 0.
+    /// @param [in] controllerInputCount Number of elements in the controller input array.
+    /// @param [in] keyboardMouseInput Keyboard and mouse input to inject, or `nullptr` to inject
+    /// none. Relative mouse motion is interpreted as the amount of motion to apply, not as running
+    /// totals.
+    /// @return `true` if the batch was accepted, `false` if it identifies a controller that does
+    /// not exist or if too many batches are already pending.
+    bool SubmitInput(
+        const SControllerInput* controllerInputs,
+        unsigned int controllerInputCount,
+        const SharedMemory::SKeyboardMouseInput* keyboardMouseInput);
+  } // namespace InputInjection
+} // namespace Xidi
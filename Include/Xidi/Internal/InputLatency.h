@@ -0,0 +1,135 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file InputLatency.h
+ *   Declaration of functionality for measuring the latency between external producers capturing
+ *   input and applications reading it.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+#include "ControllerTypes.h"
+
+namespace Xidi
+{
+  namespace InputLatency
+  {
+    /// Number of histogram buckets into which each power of two is subdivided, expressed as a
+    /// power of two. Determines the precision of the reported latency values, which are accurate
+    /// to within 25% of the true value.
+    inline constexpr unsigned int kSubBucketBits = 2;
+
+    /// Number of histogram buckets into which each power of two is subdivided.
+    inline constexpr unsigned int kSubBucketCount = (1u << kSubBucketBits);
+
+    /// Total number of histogram buckets, enough to cover every 32-bit latency value.
+    inline constexpr unsigned int kBucketCount = (kSubBucketCount * (33 - kSubBucketBits));
+
+    /// Number of latency samples recorded for a controller between successive messages that
+    /// summarize its latency in the log.
+    inline constexpr uint64_t kSamplesPerLogMessage = 1000;
+
+    /// Summary of the latency samples recorded in a histogram. All latency values are expressed
+    /// in microseconds.
+    struct SSummary
+    {
+      /// Number of latency samples recorded.
+      uint64_t sampleCount;
+
+      /// Median latency.
+      uint32_t p50;
+
+      /// 99th percentile latency.
+      uint32_t p99;
+
+      /// Largest latency recorded.
+      uint32_t max;
+
+      bool operator==(const SSummary& other) const = default;
+    };
+
+    /// Histogram of latency samples, using buckets whose width grows logarithmically with the
+    /// latency value they hold. Recording samples and computing summaries are both lock-free, so
+    /// the thread that records a sample is never blocked by a thread that reads a summary.
+    class Histogram
+    {
+    public:
+
+      /// Computes the index of the bucket that holds the specified latency value.
+      /// @param [in] latency Latency value, in microseconds.
+      /// @return Index of the bucket that holds the latency value.
+      static unsigned int BucketIndex(uint32_t latency);
+
+      /// Computes the largest latency value held by the specified bucket.
+      /// @param [in] bucketIndex Index of the bucket of interest.
+      /// @return Largest latency value held by the bucket, in microseconds.
+      static uint32_t BucketUpperBound(unsigned int bucketIndex);
+
+      /// Computes a summary of all the latency samples recorded in this histogram. Concurrent
+      /// recording of samples can cause the summary to omit some of them but never makes it
+      /// inconsistent.
+      /// @return Summary of the recorded latency samples.
+      SSummary GetSummary(void) const;
+
+      /// Records a single latency sample in this histogram.
+      /// @param [in] latency Latency value to record, in microseconds.
+      /// @return Number of latency samples that have been recorded, including this one.
+      uint64_t Record(uint32_t latency);
+
+      /// Discards all the latency samples recorded in this histogram.
+      void Reset(void);
+
+    private:
+
+      /// Number of latency samples recorded in each bucket.
+      std::array<std::atomic<uint32_t>, kBucketCount> bucketCounts = {};
+
+      /// Total number of latency samples recorded.
+      std::atomic<uint64_t> sampleCount = 0;
+
+      /// Largest latency value recorded.
+      std::atomic<uint32_t> maxLatency = 0;
+    };
+
+    /// Retrieves the current high-resolution time in the same form as producers use to timestamp
+    /// the input they capture, which is the low 32 bits of a `QueryPerformanceCounter` value.
+    /// @return Current high-resolution time, which is never 0.
+    uint32_t CaptureTimeNow(void);
+
+    /// Computes the time that has elapsed since the specified high-resolution time. Elapsed times
+    /// are computed modulo 2^32 and therefore remain correct across wraparound.
+    /// @param [in] captureTime High-resolution time in the same form as returned by
+    /// #CaptureTimeNow.
+    /// @return Elapsed time in microseconds, or an empty value if the specified time appears to be
+    /// in the future.
+    std::optional<uint32_t> ElapsedMicrosecondsSince(uint32_t captureTime);
+
+    /// Computes a summary of the latency samples recorded for the specified controller.
+    /// Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the controller of interest.
+    /// @return Summary of the recorded latency samples, which is empty if the controller
+    /// identifier is invalid.
+    SSummary GetSummary(Controller::TControllerIdentifier controllerIdentifier);
+
+    /// Records the latency between the specified high-resolution capture time and the current time
+    /// for the specified controller. Periodically outputs a summary of the latency samples recorded
+    /// for the controller to the log. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the controller whose input was read.
+    /// @param [in] captureTime High-resolution time at which the input was captured, in the same
+    /// form as returned by #CaptureTimeNow.
+    void RecordSample(Controller::TControllerIdentifier controllerIdentifier, uint32_t captureTime);
+
+    /// Discards the latency samples recorded for the specified controller. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the controller of interest.
+    void ResetSummary(Controller::TControllerIdentifier controllerIdentifier);
+  } // namespace InputLatency
+} // namespace Xidi
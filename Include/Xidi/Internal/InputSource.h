@@ -0,0 +1,332 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file InputSource.h
+ *   Declaration of sources of controller input, which are driven by the physical controller
+ *   subsystem and which produce the state that every application-facing interface reads.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include "ControllerTypes.h"
+#include "InputInjection.h"
+#include "SharedMemoryTypes.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    /// Interface for receiving the input produced by input sources. Implementations decide where
+    /// the input is stored and how interested parties are notified of it.
+    class IInputSink
+    {
+    public:
+
+      virtual ~IInputSink(void) = default;
+
+      /// Receives newly-read physical controller state for a single controller.
+      /// @param [in] controllerIdentifier Identifier of the controller whose state was read.
+      /// @param [in] physicalState Physical state that was read.
+      virtual void PublishPhysicalState(
+          TControllerIdentifier controllerIdentifier, const SPhysicalState& physicalState) = 0;
+
+      /// Receives changed input supplied externally for a single controller, meant to be applied
+      /// on top of processed virtual controller state.
+      /// @param [in] controllerIdentifier Identifier of the controller that receives the input.
+      /// @param [in] overlay Virtual controller state overlay holding the input.
+      /// @param [in] timestamp Time at which the input was captured, using the same clock as the
+      /// `timeGetTime` function.
+      /// @param [in] captureTime High-resolution time at which the input was captured, or 0 if none
+      /// is available.
+      virtual void PublishExternalInput(
+          TControllerIdentifier controllerIdentifier,
+          const SStateOverlay& overlay,
+          uint32_t timestamp,
+          uint32_t captureTime) = 0;
+    };
+
+    /// Enumerates the ways in which input sources are scheduled to be read.
+    enum class EInputSourceScheduling
+    {
+      /// Source is read periodically by the scheduler, at a period the source chooses.
+      Polled,
+
+      /// Source runs on a thread of its own, which alternates between waiting for the source to be
+      /// signalled and reading it. The scheduler periodically wakes the source, at a period the
+      /// source chooses, in case input arrives without a signal.
+      Signalled
+    };
+
+    /// Default polling period, in milliseconds, used by adaptive polling while input is changing.
+    inline constexpr unsigned int kAdaptivePollingDefaultActivePeriodMilliseconds = 1;
+
+    /// Default polling period, in milliseconds, to which adaptive polling decays once input stops
+    /// changing.
+    inline constexpr unsigned int kAdaptivePollingDefaultIdlePeriodMilliseconds = 20;
+
+    /// Default number of milliseconds without any input changes after which adaptive polling
+    /// starts to decay towards the idle polling period.
+    inline constexpr unsigned int kAdaptivePollingDefaultIdleDelayMilliseconds = 1000;
+
+    /// Parameters that govern adaptive polling, which polls quickly while input is changing and
+    /// slowly while it is not.
+    struct SAdaptivePollingParameters
+    {
+      /// Whether or not adaptive polling is enabled. If not, a fixed polling period is used.
+      bool enabled = false;
+
+      /// Polling period, in milliseconds, used while input is changing.
+      unsigned int activePeriodMilliseconds = kAdaptivePollingDefaultActivePeriodMilliseconds;
+
+      /// Polling period, in milliseconds, to which polling decays once input stops changing.
+      unsigned int idlePeriodMilliseconds = kAdaptivePollingDefaultIdlePeriodMilliseconds;
+
+      /// Number of milliseconds without any input changes after which polling starts to decay.
+      unsigned int idleDelayMilliseconds = kAdaptivePollingDefaultIdleDelayMilliseconds;
+    };
+
+    /// Statistics that describe a single period of active polling, from the first input change
+    /// until polling started to decay.
+    struct SAdaptivePollingStatistics
+    {
+      /// Number of milliseconds for which polling was active.
+      uint32_t durationMilliseconds;
+
+      /// Number of polls that took place while polling was active.
+      uint32_t pollCount;
+
+      /// Number of those polls that observed changed input.
+      uint32_t changedPollCount;
+    };
+
+    /// Chooses polling periods based on how recently input changed. Polls at the active period as
+    /// soon as input changes, and once input stays unchanged for long enough, doubles the period
+    /// with every poll until it reaches the idle period. Not concurrency-safe.
+    class AdaptivePollingRate
+    {
+    public:
+
+      AdaptivePollingRate(const SAdaptivePollingParameters& parameters);
+
+      /// Retrieves the polling period most recently chosen.
+      /// @return Polling period, in milliseconds.
+      inline unsigned int GetPeriodMilliseconds(void) const
+      {
+        return currentPeriodMilliseconds;
+      }
+
+      /// Retrieves statistics about the current or most recent period of active polling.
+      /// @return Active polling statistics.
+      inline SAdaptivePollingStatistics GetStatistics(void) const
+      {
+        return statistics;
+      }
+
+      /// Specifies whether or not polling is active, meaning that input changed recently enough
+      /// that polling has not started to decay.
+      /// @return `true` if polling is active, `false` otherwise.
+      inline bool IsActive(void) const
+      {
+        return active;
+      }
+
+      /// Records the outcome of a poll and chooses the period until the next poll.
+      /// @param [in] inputChanged Whether or not the poll observed changed input.
+      /// @param [in] currentTime Time at which the poll took place, in milliseconds, using the
+      /// same clock as the `timeGetTime` function.
+      /// @return Polling period, in milliseconds, until the next poll.
+      unsigned int Update(bool inputChanged, uint32_t currentTime);
+
+    private:
+
+      /// Parameters that govern how polling periods are chosen.
+      const SAdaptivePollingParameters parameters;
+
+      /// Polling period most recently chosen, in milliseconds.
+      unsigned int currentPeriodMilliseconds;
+
+      /// Time at which input most recently changed.
+      uint32_t lastChangeTime;
+
+      /// Time at which polling most recently became active.
+      uint32_t activeStartTime;
+
+      /// Whether or not polling is active.
+      bool active;
+
+      /// Statistics about the current or most recent period of active polling.
+      SAdaptivePollingStatistics statistics;
+    };
+
+    /// Interface for a single source of controller input. Sources decide for themselves how they
+    /// are scheduled, and both polled and signalled sources pass their input on in the same way.
+    class IInputSource
+    {
+    public:
+
+      virtual ~IInputSource(void) = default;
+
+      /// Retrieves the number of milliseconds to wait between reads of this input source. Polled
+      /// input sources are read at this period, and signalled input sources are woken at this
+      /// period in case their input arrives without a signal.
+      /// @return Polling period, in milliseconds.
+      virtual unsigned int GetPollingPeriodMilliseconds(void) const = 0;
+
+      /// Specifies how this input source is scheduled to be read.
+      /// @return Scheduling type of this input source.
+      virtual EInputSourceScheduling GetScheduling(void) const = 0;
+
+      /// Reads all input that is available from this input source and passes it on to the
+      /// specified sink. Each piece of input is read once, no matter how many interested parties
+      /// eventually consume it.
+      /// @param [in] sink Sink that receives the input.
+      virtual void ReadInput(IInputSink& sink) = 0;
+
+      /// Blocks until this input source is signalled or a timeout elapses, whichever happens
+      /// first. Only invoked for signalled input sources, so polled input sources need not
+      /// override it.
+      virtual void WaitForInput(void) {}
+
+      /// Ends a wait for input that is in progress or, if there is none, makes the next one end
+      /// immediately. Only invoked for signalled input sources, so polled input sources need not
+      /// override it.
+      virtual void WakeInput(void) {}
+    };
+
+    /// Input source that polls a single physical controller using XInput.
+    class XInputSource : public IInputSource
+    {
+    public:
+
+      inline XInputSource(
+          TControllerIdentifier controllerIdentifier,
+          const SAdaptivePollingParameters& adaptivePollingParameters = {})
+          : IInputSource(),
+            controllerIdentifier(controllerIdentifier),
+            adaptivePollingEnabled(adaptivePollingParameters.enabled),
+            adaptivePollingRate(adaptivePollingParameters),
+            lastPhysicalState({.deviceStatus = EPhysicalDeviceStatus::Ok})
+      {}
+
+      /// Reads the current physical state of the controller associated with this input source,
+      /// without passing it on to any sink.
+      /// @return Physical state of the controller.
+      SPhysicalState ReadPhysicalState(void) const;
+
+      // IInputSource
+      unsigned int GetPollingPeriodMilliseconds(void) const override;
+      EInputSourceScheduling GetScheduling(void) const override;
+      void ReadInput(IInputSink& sink) override;
+
+    private:
+
+      /// Identifier of the controller that this input source polls.
+      const TControllerIdentifier controllerIdentifier;
+
+      /// Whether or not the polling period adapts to how recently input changed.
+      const bool adaptivePollingEnabled;
+
+      /// Chooses polling periods if adaptive polling is enabled.
+      AdaptivePollingRate adaptivePollingRate;
+
+      /// Physical state from the most recent read. Used to detect input changes and to back off
+      /// after an error or while the controller is disconnected.
+      SPhysicalState lastPhysicalState;
+    };
+
+    /// Input source for input supplied by external producers via shared memory or injected by
+    /// other modules loaded into the same process. Covers all controllers at once, so that each
+    /// frame is decoded once no matter how many controllers it affects. Keyboard and mouse input
+    /// is submitted directly to the virtual keyboard and mouse.
+    class ExternalInputSource : public IInputSource
+    {
+    public:
+
+      ExternalInputSource(void);
+
+      ExternalInputSource(const ExternalInputSource& other) = delete;
+
+      ~ExternalInputSource(void) override;
+
+      // IInputSource
+      unsigned int GetPollingPeriodMilliseconds(void) const override;
+      EInputSourceScheduling GetScheduling(void) const override;
+      void ReadInput(IInputSink& sink) override;
+      void WaitForInput(void) override;
+      void WakeInput(void) override;
+
+    private:
+
+      /// Enumerates the sources of external input, in priority order, highest priority first.
+      /// Used as indices into the array that holds the most recent input from each source.
+      enum class ESource : uint8_t
+      {
+        /// Input supplied via shared memory, already merged across all configured channels.
+        SharedMemory,
+
+        /// Input injected by modules loaded into the same process.
+        Injection,
+
+        /// Sentinel value, total number of sources.
+        Count
+      };
+
+      /// Merges the most recent input from all sources and passes on whatever changed as a result.
+      /// Relative mouse motion is passed on exactly once, so afterwards it is removed from the
+      /// input held for each source.
+      /// @param [in] sink Sink that receives the input.
+      /// @param [in] timestamp Time at which the input that caused the change was captured.
+      /// @param [in] captureTime High-resolution time at which the input that caused the change was
+      /// captured, or 0.
+      void PublishMergedInput(IInputSink& sink, uint32_t timestamp, uint32_t captureTime);
+
+      /// Passes on input for a single controller, unless it is unchanged from the input most
+      /// recently passed on for the same controller.
+      /// @param [in] sink Sink that receives the input.
+      /// @param [in] controllerIdentifier Identifier of the controller that receives the input.
+      /// @param [in] overlay Virtual controller state overlay holding the input.
+      /// @param [in] timestamp Time at which the input was captured.
+      /// @param [in] captureTime High-resolution time at which the input was captured, or 0.
+      void PublishControllerInput(
+          IInputSink& sink,
+          TControllerIdentifier controllerIdentifier,
+          const SStateOverlay& overlay,
+          uint32_t timestamp,
+          uint32_t captureTime);
+
+      /// Submits keyboard and mouse input to the virtual keyboard and mouse. Relative mouse motion
+      /// is consumed exactly once, so any that the input carries is always submitted. Other
+      /// keyboard and mouse input persists until replaced, so it is only submitted when it
+      /// changes.
+      /// @param [in,out] keyboardMouseInput Keyboard and mouse input to submit. On output, no
+      /// longer holds any relative mouse motion.
+      void PublishKeyboardMouseInput(SharedMemory::SKeyboardMouseInput& keyboardMouseInput);
+
+      /// Buffer into which batches of injected input are read.
+      InputInjection::SInjectedInput injectedInput;
+
+      /// Most recent input from each source, one element per source. Each source's input persists
+      /// until that same source replaces it.
+      SharedMemory::SFrameInput sourceInput[static_cast<int>(ESource::Count)];
+
+      /// Input from all sources, merged using the configured merge policies.
+      SharedMemory::SFrameInput mergedInput;
+
+      /// Keyboard and mouse input most recently submitted.
+      SharedMemory::SKeyboardMouseInput lastKeyboardMouseInput;
+
+      /// Merged overlay most recently passed on for each controller.
+      SStateOverlay lastOverlay[kMaxControllerCount];
+
+      /// Auto-reset event that ends a wait for input when signalled, or `nullptr` if it could not
+      /// be created.
+      HANDLE wakeEventHandle;
+    };
+  } // namespace Controller
+} // namespace Xidi
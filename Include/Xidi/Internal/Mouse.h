@@ -93,5 +93,12 @@ namespace Xidi
     /// mouse axis.
     /// @param [in] sourceIdentifier Opaque identifier for the source of the mouse movement event.
     void SubmitMouseMovement(EMouseAxis axis, int mouseMovementUnits, uint32_t sourceIdentifier);
+
+    /// Submits relative mouse movement, which is added to any relative movement not yet sent to the
+    /// system and sent exactly once, irrespective of the mouse movement contributions.
+    /// @param [in] axis Mouse axis that is affected.
+    /// @param [in] mouseMovementPixels Amount of movement along the target mouse axis, in pixels
+    /// for pointer axes or in wheel units for wheel axes.
+    void SubmitMouseRelativeMovement(EMouseAxis axis, int mouseMovementPixels);
   } // namespace Mouse
 } // namespace Xidi
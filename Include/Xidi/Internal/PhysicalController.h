@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <stop_token>
 
 #include "ApiWindows.h"
@@ -28,16 +29,55 @@ namespace Xidi
     /// Number of milliseconds to wait between force feedback actuation passes.
     inline constexpr unsigned int kPhysicalForceFeedbackPeriodMilliseconds = 5;
 
+    /// Maximum number of milliseconds to wait between reads of input supplied by external producers
+    /// via shared memory. Producers that signal after writing cause reads to happen sooner.
+    inline constexpr unsigned int kExternalInputPollingPeriodMilliseconds = 5;
+
+    /// Number of changes to the input supplied by external producers that are retained for each
+    /// controller. Virtual controllers that fall further behind than this miss the oldest changes.
+    inline constexpr unsigned int kExternalInputHistoryCapacity = 64;
+
     /// Number of milliseconds to wait between attempts to communicate with the physical hardware if
     /// the last attempt resulted in an error, such as the controller being disconnected.
     inline constexpr unsigned int kPhysicalErrorBackoffPeriodMilliseconds = 100;
 
+    /// Input supplied by external producers for a single controller, along with the time at which
+    /// it was captured.
+    struct SExternalInput
+    {
+      /// Virtual controller state overlay holding the externally-supplied input.
+      SStateOverlay overlay;
+
+      /// Time at which the input was captured, using the same clock as the `timeGetTime` function.
+      uint32_t timestamp;
+
+      /// High-resolution time at which the input was captured, as the low 32 bits of a
+      /// `QueryPerformanceCounter` value, or 0 if the producer did not supply one.
+      uint32_t captureTime;
+    };
+
     /// Retrieves and returns the capabilities of the controller layout implemented by the mapper
     /// associated with the specified physical controller. Controller capabilities act as metadata
     /// that are used internally and can be presented to applications. Concurrency-safe.
     /// @return Capabilities associated with the specified physical controller.
     SCapabilities GetControllerCapabilities(TControllerIdentifier controllerIdentifier);
 
+    /// Retrieves and returns the number of controllers presented to applications. This value is
+    /// read from the configuration file once and does not change for the lifetime of the process.
+    /// Valid controller identifiers are less than this value. Concurrency-safe.
+    /// @return Number of controllers, between 1 and #kMaxControllerCount inclusive.
+    TControllerIdentifier GetControllerCount(void);
+
+    /// Retrieves the input that external producers most recently supplied for the specified
+    /// controller. This input is applied on top of processed virtual controller state, after all
+    /// properties are applied. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [out] sequence Filled in with the sequence number of the returned input, which can be
+    /// used as the starting point for waiting for subsequent changes.
+    /// @return Virtual controller state overlay holding the externally-supplied input.
+    SStateOverlay GetCurrentExternalInputOverlay(
+        TControllerIdentifier controllerIdentifier, uint64_t& sequence);
+
     /// Retrieves the instantaneous physical state of the specified controller. Concurrency-safe.
     /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
     /// @return Physical controller state data.
@@ -49,8 +89,30 @@ namespace Xidi
     /// @return Raw virtual controller state data.
     SState GetCurrentRawVirtualControllerState(TControllerIdentifier controllerIdentifier);
 
+    /// Registers the specified virtual controller as a consumer of the specified physical
+    /// controller's input. Registered virtual controllers have their state refreshed, and their
+    /// state change events signalled, whenever the input changes. Physical controllers are only
+    /// polled while at least one virtual controller is registered, and registering the first one
+    /// refreshes the physical controller's state right away so that it is current. Before this
+    /// function returns, the virtual controller's state is refreshed to match the current input.
+    /// Has no effect if the virtual controller is already registered. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [in] virtualController Pointer to the virtual controller of interest.
+    void PhysicalControllerInputRegister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController);
+
+    /// Unregisters the specified virtual controller as a consumer of the specified physical
+    /// controller's input, if it is currently registered. Once this function returns, the virtual
+    /// controller is no longer accessed and can safely be destroyed. Polling stops once the last
+    /// virtual controller is unregistered. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [in] virtualController Pointer to the virtual controller of interest.
+    void PhysicalControllerInputUnregister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController);
+
     /// Attempts to register the specified virtual controller for force feedback with the specified
-    /// physical controller. Concurrency-safe.
+    /// physical controller. Force feedback effects are only actuated while at least one virtual
+    /// controller is registered. Concurrency-safe.
     /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
     /// @param [in] virtualController Pointer to the virtual controller of interest.
     /// @return Pointer to the device buffer object if successful, `nullptr` otherwise. This
@@ -60,12 +122,32 @@ namespace Xidi
         TControllerIdentifier controllerIdentifier, const VirtualController* virtualController);
 
     /// Unregisters the specified virtual controller for force feedback if it is currently
-    /// registered with the specified physical controller. Concurrency-safe.
+    /// registered with the specified physical controller. Once the last virtual controller is
+    /// unregistered, actuation stops and the physical actuators are stopped. Concurrency-safe.
     /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
     /// @param [in] virtualController Pointer to the virtual controller of interest.
     void PhysicalControllerForceFeedbackUnregister(
         TControllerIdentifier controllerIdentifier, const VirtualController* virtualController);
 
+    /// Waits for the input that external producers supply for the specified controller to change.
+    /// When it does, retrieves and returns the next change. Every change is retrieved, in order,
+    /// unless the caller falls behind by more than #kExternalInputHistoryCapacity changes. This
+    /// function is fully concurrency-safe. If needed, the caller can interrupt the wait using a
+    /// stop token.
+    /// @param [in] controllerIdentifier Identifier of the physical controller of interest.
+    /// @param [in,out] sequence On input, sequence number of the last-known externally-supplied
+    /// input for the calling thread. On output, sequence number of the retrieved input.
+    /// @param [out] input Filled in with the retrieved externally-supplied input.
+    /// @param [in] stopToken Token that allows the wait to be interrupted. Defaults to an empty
+    /// token that does not allow interruption.
+    /// @return `true` if the wait succeeded and the output structure was updated, `false` if no
+    /// updates were made due to invalid parameter or interrupted wait.
+    bool WaitForExternalInputChange(
+        TControllerIdentifier controllerIdentifier,
+        uint64_t& sequence,
+        SExternalInput& input,
+        std::stop_token stopToken = std::stop_token());
+
     /// Waits for the specified physical controller's state to change. When it does, retrieves and
     /// returns the new state. This function is fully concurrency-safe. If needed, the caller can
     /// interrupt the wait using a stop token.
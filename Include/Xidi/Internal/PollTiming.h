@@ -0,0 +1,88 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file PollTiming.h
+ *   Declaration of functionality for measuring how regularly and how quickly physical controllers
+ *   are polled.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include "ControllerTypes.h"
+#include "InputLatency.h"
+
+namespace Xidi
+{
+  namespace PollTiming
+  {
+    /// Summary of the poll timing measurements recorded for a single controller. Timing values are
+    /// summarized using the same histograms as input latency and are expressed in microseconds.
+    struct SSummary
+    {
+      /// Time between the starts of consecutive polls.
+      InputLatency::SSummary pollInterval;
+
+      /// Time taken to read the physical controller state.
+      InputLatency::SSummary readDuration;
+
+      /// Time taken to map changed physical controller state to virtual controller state. Polls
+      /// that observe no changes do not map anything and are therefore not measured.
+      InputLatency::SSummary mapDuration;
+
+      /// Number of polls that observed changed physical controller state.
+      uint64_t changedPollCount;
+
+      /// Number of notifications sent to threads waiting for physical or raw virtual controller
+      /// state to change.
+      uint64_t notificationCount;
+
+      bool operator==(const SSummary& other) const = default;
+    };
+
+    /// Computes a summary of the poll timing measurements recorded for the specified controller.
+    /// Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the controller of interest.
+    /// @return Summary of the recorded measurements, which is empty if the controller identifier
+    /// is invalid.
+    SSummary GetSummary(Controller::TControllerIdentifier controllerIdentifier);
+
+    /// Outputs a summary of the poll timing measurements recorded for every controller that was
+    /// polled at least once. Concurrency-safe.
+    void OutputSummaries(void);
+
+    /// Records that a poll observed changed physical controller state, along with how long it
+    /// took to map that state and how many notifications resulted. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the controller that was polled.
+    /// @param [in] mapDuration Time taken to map the changed state, in microseconds.
+    /// @param [in] notificationCount Number of notifications sent to waiting threads.
+    void RecordChangedPoll(
+        Controller::TControllerIdentifier controllerIdentifier,
+        uint32_t mapDuration,
+        unsigned int notificationCount);
+
+    /// Records the time between the starts of two consecutive polls of the specified controller.
+    /// Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the controller that was polled.
+    /// @param [in] pollInterval Time between the starts of the two polls, in microseconds.
+    void RecordPollInterval(
+        Controller::TControllerIdentifier controllerIdentifier, uint32_t pollInterval);
+
+    /// Records the time taken to read the physical state of the specified controller.
+    /// Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the controller that was polled.
+    /// @param [in] readDuration Time taken to read the state, in microseconds.
+    void RecordReadDuration(
+        Controller::TControllerIdentifier controllerIdentifier, uint32_t readDuration);
+
+    /// Discards the poll timing measurements recorded for the specified controller.
+    /// Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the controller of interest.
+    void ResetSummary(Controller::TControllerIdentifier controllerIdentifier);
+  } // namespace PollTiming
+} // namespace Xidi
@@ -0,0 +1,68 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file Scheduler.h
+ *   Declaration of the scheduler that runs all periodic tasks on a single thread.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace Xidi
+{
+  namespace Scheduler
+  {
+    /// Clock used to track task deadlines.
+    using TClock = std::chrono::steady_clock;
+
+    /// Type used to identify periodic tasks. Identifiers are never reused.
+    using TTaskIdentifier = uint64_t;
+
+    /// Function that performs one invocation of a periodic task. Returns the number of
+    /// milliseconds from the deadline of this invocation to the deadline of the next, which allows
+    /// each task to vary its own period, for example to back off after an error.
+    using TTaskFunction = std::function<unsigned int(void)>;
+
+    /// Shortest period, in milliseconds, at which a task can run. Tasks that request a shorter
+    /// period are run at this period instead.
+    inline constexpr unsigned int kMinimumPeriodMilliseconds = 1;
+
+    /// Adds a periodic task to the scheduler, starting the scheduler thread if it is not already
+    /// running. All tasks run on the same thread, one at a time, so task functions should return
+    /// quickly. Concurrency-safe.
+    /// @param [in] initialPeriodMilliseconds Number of milliseconds from now until the first
+    /// invocation of the task.
+    /// @param [in] taskFunction Function to be invoked each time the task is due.
+    /// @return Identifier of the newly-added task, which can be used to remove it.
+    TTaskIdentifier AddTask(unsigned int initialPeriodMilliseconds, TTaskFunction taskFunction);
+
+    /// Computes the deadline of the next invocation of a periodic task. Deadlines advance by
+    /// exactly one period each time, so that lateness in one invocation does not accumulate into
+    /// drift. If the task fell behind by more than a whole period, the missed invocations are
+    /// skipped rather than run back-to-back.
+    /// @param [in] previousDeadline Deadline of the invocation that just completed.
+    /// @param [in] periodMilliseconds Period requested by the task for its next invocation.
+    /// @param [in] now Current time.
+    /// @param [out] missedInvocations Filled in with the number of invocations that were skipped.
+    /// @return Deadline of the next invocation.
+    TClock::time_point NextDeadline(
+        TClock::time_point previousDeadline,
+        unsigned int periodMilliseconds,
+        TClock::time_point now,
+        unsigned int& missedInvocations);
+
+    /// Removes a periodic task from the scheduler. Once this function returns, the task is not
+    /// invoked again, although an invocation that is already in progress on the scheduler thread
+    /// is allowed to complete. Can be invoked from within the task itself. Concurrency-safe.
+    /// @param [in] taskIdentifier Identifier of the task to remove. Ignored if it does not
+    /// identify a task that was added and not yet removed.
+    void RemoveTask(TTaskIdentifier taskIdentifier);
+  } // namespace Scheduler
+} // namespace Xidi
@@ -0,0 +1,170 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file SharedMemoryInput.h
+ *   Declaration of functionality for reading input supplied by external producers via shared
+ *   memory.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "SharedMemoryTypes.h"
+
+namespace Xidi
+{
+  namespace SharedMemory
+  {
+    /// Number of milliseconds to wait between attempts to open the shared memory mapping if the
+    /// last attempt failed, for example because no producer has created it yet.
+    inline constexpr unsigned int kMappingOpenRetryPeriodMilliseconds = 1000;
+
+    /// Maximum number of additional events, beyond those of the shared memory channels, that can
+    /// end a wait for a frame signal.
+    inline constexpr unsigned int kMaxAdditionalSignalEventCount = 2;
+
+    /// Decodes a shared memory input frame. Frames can use either the versioned layout, with a
+    /// binary, JSON, or ring payload, or the legacy layout consisting only of JSON text. For ring
+    /// payloads, the most recent frame in the ring is decoded, and if it is a delta frame, its
+    /// complete input is reconstructed from the most recent full frame still held in the ring.
+    /// @param [in] frame Pointer to the start of the frame.
+    /// @param [in] frameSizeBytes Number of readable bytes starting at the frame pointer. No bytes
+    /// beyond this bound are accessed.
+    /// @param [out] frameInput Filled in with the input supplied by the frame for all controllers,
+    /// the keyboard, and the mouse. Controllers for which the frame supplies no input are left
+    /// empty.
+    /// @return `true` if the frame was recognized and decoded successfully, `false` otherwise. On
+    /// failure, the output is left empty.
+    bool DecodeFrame(const void* frame, size_t frameSizeBytes, SFrameInput& frameInput);
+
+    /// Decodes a single frame held in a ring payload. Concurrency-safe with respect to a producer
+    /// that is writing to the ring.
+    /// @param [in] frame Pointer to the start of the frame that holds the ring payload.
+    /// @param [in] frameSizeBytes Number of readable bytes starting at the frame pointer. No bytes
+    /// beyond this bound are accessed.
+    /// @param [in] frameNumber Number of the frame within the ring to decode.
+    /// @param [in] previousFrameInput Input decoded from the frame that immediately precedes the
+    /// requested frame. Used only if the requested frame is a delta frame, in which case the
+    /// changes it supplies are applied on top of this input. Must not be the same object as the
+    /// output.
+    /// @param [out] frameInput Filled in with the input supplied by the frame, including its
+    /// timestamp.
+    /// @return `true` if the requested frame was decoded successfully, `false` if the frame does
+    /// not hold a valid ring payload, if the ring does not hold the requested frame, either
+    /// because it was not written yet or because it was already overwritten, or if the requested
+    /// frame is a malformed delta frame. On failure, the output is left empty.
+    bool DecodeRingFrame(
+        const void* frame,
+        size_t frameSizeBytes,
+        uint32_t frameNumber,
+        const SFrameInput& previousFrameInput,
+        SFrameInput& frameInput);
+
+    /// Converts the relative mouse motion running totals supplied by a producer into the motion
+    /// accumulated since the totals were last drained using the same cursor, and advances the
+    /// cursor. Totals wrap around modulo 2^32. The first total observed for each axis only
+    /// establishes the cursor, so motion accumulated before Xidi started reading is discarded.
+    /// @param [in,out] keyboardMouseInput On input, holds the running totals. On output, holds the
+    /// accumulated motion, with axes that did not move marked as not supplied.
+    /// @param [in,out] cursor Consumer cursor for the producer that supplied the totals.
+    void DrainMouseMotion(SKeyboardMouseInput& keyboardMouseInput, SMouseMotionCursor& cursor);
+
+    /// Reads the generation counter of a shared memory input frame. Concurrency-safe with respect
+    /// to a producer that is modifying the frame.
+    /// @param [in] frame Pointer to the start of the frame.
+    /// @param [in] frameSizeBytes Number of readable bytes starting at the frame pointer.
+    /// @return Generation counter value, or 0 if the frame does not carry a generation counter.
+    uint32_t GetFrameGeneration(const void* frame, size_t frameSizeBytes);
+
+    /// Reads the producer instance identifier of a shared memory input frame.
+    /// @param [in] frame Pointer to the start of the frame.
+    /// @param [in] frameSizeBytes Number of readable bytes starting at the frame pointer.
+    /// @return Producer instance identifier, or 0 if the frame does not carry one.
+    uint32_t GetFrameInstanceIdentifier(const void* frame, size_t frameSizeBytes);
+
+    /// Parses a merge policy from its configuration file representation, ignoring case.
+    /// @param [in] policyString String representation of the merge policy.
+    /// @return Merge policy if the string is recognized, or no value otherwise.
+    std::optional<EMergePolicy> MergePolicyFromString(std::wstring_view policyString);
+
+    /// Retrieves the policies used to merge input from multiple sources, as read from the
+    /// configuration file. Reads the configuration the first time it is invoked.
+    /// @return Merge policies that govern how each element is merged.
+    const SMergePolicy& GetMergePolicy(void);
+
+    /// Merges input decoded from multiple channels into a single frame's worth of input. Each
+    /// element is merged using the configured policy, considering only the channels that supply
+    /// it, and elements that no channel supplies are left absent from the result. Channels are
+    /// given in priority order, highest priority first.
+    /// @param [in] channelFrameInputs Input most recently decoded from each channel.
+    /// @param [in] channelFrameInputCount Number of channels whose input is to be merged.
+    /// @param [in] mergePolicy Policies that govern how each element is merged.
+    /// @param [out] mergedFrameInput Filled in with the merged input, except for the timestamp,
+    /// which is set to 0.
+    void MergeFrameInputs(
+        const SFrameInput* channelFrameInputs,
+        unsigned int channelFrameInputCount,
+        const SMergePolicy& mergePolicy,
+        SFrameInput& mergedFrameInput);
+
+    /// Reads the next frame that external producers wrote to any of the configured shared memory
+    /// channels and decodes it, but only if it was not already decoded. If the producer maintains
+    /// a generation counter then unchanged frames are detected without decoding them. For ring
+    /// payloads, every frame written since the last read is returned in order, one per invocation,
+    /// so callers should keep invoking this function until it returns `false`. Each mapping is
+    /// opened on first use and re-opened only if its producer restarts. If multiple channels are
+    /// configured, the new frame is merged with the most recent input from every other channel.
+    /// Relative mouse motion is drained from the producers' running totals, so the output holds
+    /// only the motion accumulated since the previous read.
+    /// Not concurrency-safe, as it is intended to be invoked only by the single thread that
+    /// ingests shared memory input.
+    /// @param [in,out] frameInput On output, filled in with the newly-decoded input if a new frame
+    /// was decoded, otherwise left unmodified. Its timestamp is that of the new frame.
+    /// @return `true` if a new frame was decoded, `false` otherwise.
+    bool ReadFrame(SFrameInput& frameInput);
+
+    /// Waits for an external producer to signal that it has written a new frame to any of the
+    /// configured shared memory channels. Producers signal using an optional named auto-reset
+    /// event per channel. Events are opened on first use and, if they do not exist, opening is
+    /// retried no more often than the mappings themselves. If no event is available then this
+    /// function simply waits for the entire timeout period. Not concurrency-safe, as it is
+    /// intended to be invoked only by the single thread that ingests shared memory input.
+    /// @param [in] timeoutMilliseconds Maximum number of milliseconds to wait, or `INFINITE` to
+    /// wait until something signals.
+    /// @param [in] additionalSignalEventHandles Optional handles to additional events that end the
+    /// wait when signalled, such as for input that arrives by some other means. At most
+    /// #kMaxAdditionalSignalEventCount are used, and any that are `nullptr` are ignored.
+    /// @return `true` if a producer or an additional event signalled, `false` if the timeout
+    /// period elapsed.
+    bool WaitForFrameSignal(
+        unsigned int timeoutMilliseconds,
+        std::initializer_list<HANDLE> additionalSignalEventHandles = {});
+
+    /// Submits decoded keyboard and mouse input to the virtual keyboard and mouse, except for
+    /// relative mouse motion, which is submitted separately. If a key state bitmap is present,
+    /// only the keys whose states differ from the previously-submitted key state are submitted.
+    /// @param [in] keyboardMouseInput Keyboard and mouse input to be submitted.
+    /// @param [in] previousKeyboardMouseInput Keyboard and mouse input that was most recently
+    /// submitted, against which the key state is compared.
+    void SubmitKeyboardMouseInput(
+        const SKeyboardMouseInput& keyboardMouseInput,
+        const SKeyboardMouseInput& previousKeyboardMouseInput);
+
+    /// Submits decoded relative mouse motion to the virtual mouse and then removes it from the
+    /// input, so that it is consumed exactly once.
+    /// @param [in,out] keyboardMouseInput Keyboard and mouse input whose relative mouse motion is
+    /// to be submitted. On output, no longer holds any relative mouse motion.
+    void SubmitMouseMotion(SKeyboardMouseInput& keyboardMouseInput);
+  } // namespace SharedMemory
+} // namespace Xidi
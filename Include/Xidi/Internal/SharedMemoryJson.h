@@ -0,0 +1,102 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file SharedMemoryJson.h
+ *   Declaration of a parser for the JSON format that external producers can use to supply input
+ *   via shared memory.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "SharedMemoryTypes.h"
+
+namespace Xidi
+{
+  namespace SharedMemory
+  {
+    /// Maximum nesting depth of JSON arrays and objects. Deeper text is rejected, which bounds the
+    /// amount of stack space the parser uses.
+    inline constexpr unsigned int kJsonMaxNestingDepth = 64;
+
+    /// Enumerates the types of JSON object members that the parser recognizes.
+    enum class EJsonKeyType : uint8_t
+    {
+      /// Axis value in a controller object. Index is an axis enumerator.
+      Axis,
+
+      /// Button state in a controller object. Index is a button enumerator.
+      Button,
+
+      /// POV direction state in a controller object. Index is a POV direction enumerator.
+      PovDirection,
+
+      /// Keyboard object in the first controller object.
+      Keyboard,
+
+      /// Mouse object in the first controller object.
+      Mouse,
+
+      /// Array of pressed keys in a keyboard object.
+      KeyboardPressed,
+
+      /// Array of released keys in a keyboard object.
+      KeyboardReleased,
+
+      /// Mouse button state in a mouse object. Index is a mouse button enumerator.
+      MouseButton,
+
+      /// Flag in a mouse object that indicates whether mouse movement values are valid.
+      MouseMove,
+
+      /// Flag in a mouse object that indicates whether mouse movement values are relative motion
+      /// accumulators. Takes precedence over the mouse movement flag.
+      MouseMotion,
+
+      /// Mouse movement value in a mouse object. Index is a mouse axis enumerator.
+      MouseAxis
+    };
+
+    /// Identifies a JSON object member that the parser recognizes.
+    struct SJsonKey
+    {
+      /// Type of object member.
+      EJsonKeyType type;
+
+      /// Index of the element to which the object member refers, interpreted based on the type.
+      uint8_t index;
+
+      constexpr bool operator==(const SJsonKey& other) const = default;
+    };
+
+    /// Looks up a JSON object member name using a perfect hash table generated at compile time.
+    /// Names are case-sensitive and must not contain escape sequences.
+    /// @param [in] name Object member name to look up, without the surrounding quotation marks.
+    /// @return Identification of the object member if the name is recognized, or no value
+    /// otherwise.
+    std::optional<SJsonKey> LookupJsonKey(std::string_view name);
+
+    /// Parses JSON text that describes input for all controllers. The top-level JSON value is an
+    /// array with one object per controller, and keyboard and mouse input are held in the object
+    /// for the first controller. Parsing happens in a single pass over the text, values are written
+    /// directly to the output, and no memory is allocated. Object members that are not recognized
+    /// are skipped.
+    /// @param [in] text Pointer to the start of the JSON text.
+    /// @param [in] maxTextLength Maximum number of bytes of JSON text. Text ends at either the
+    /// first null character or this number of bytes, whichever comes first. No bytes beyond this
+    /// bound are accessed.
+    /// @param [out] frameInput Filled in with the input supplied by the JSON text. Must be empty on
+    /// input.
+    /// @return `true` if the JSON text was parsed successfully, `false` otherwise. On failure, the
+    /// output might be partially filled in.
+    bool ParseJsonFrame(const char* text, size_t maxTextLength, SFrameInput& frameInput);
+  } // namespace SharedMemory
+} // namespace Xidi
@@ -0,0 +1,73 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file SharedMemoryOutput.h
+ *   Declaration of functionality for publishing force feedback output to external consumers via
+ *   shared memory.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "ForceFeedbackTypes.h"
+#include "SharedMemoryTypes.h"
+
+namespace Xidi
+{
+  namespace SharedMemory
+  {
+    /// Creates and initializes a named force feedback output mapping, unless a mapping with the
+    /// same name already exists. An existing mapping belongs to another publisher, such as another
+    /// process or another Xidi library loaded into the same process, so it is left untouched.
+    /// @param [in] mappingName Name of the mapping to create.
+    /// @param [in] controllerCount Number of controllers for which output is published.
+    /// @param [out] mappingHandle Filled in with the handle of the mapping if this invocation
+    /// created it, `nullptr` otherwise.
+    /// @return Pointer to a view of the whole initialized mapping if this invocation created it,
+    /// `nullptr` otherwise.
+    void* CreateForceFeedbackOutputMapping(
+        std::wstring_view mappingName, uint16_t controllerCount, HANDLE& mappingHandle);
+
+    /// Initializes a force feedback output mapping so that it holds no records and every
+    /// controller's current actuator values are zero.
+    /// @param [out] output Pointer to the start of the mapping, which must be at least
+    /// #ForceFeedbackOutputSizeBytes bytes in size.
+    /// @param [in] controllerCount Number of controllers for which output is published.
+    /// @param [in] instanceIdentifier Identifier of the instance that initializes the mapping.
+    void InitializeForceFeedbackOutput(
+        void* output, uint16_t controllerCount, uint32_t instanceIdentifier);
+
+    /// Writes a single record to an initialized force feedback output mapping, both to the ring
+    /// and as the controller's current actuator values. Not concurrency-safe with respect to other
+    /// writers, but safe with respect to consumers that follow the protocol described with
+    /// #SForceFeedbackOutputHeader.
+    /// @param [in,out] output Pointer to the start of the mapping.
+    /// @param [in] controllerIdentifier Identifier of the controller whose actuator values are
+    /// written. Ignored if not less than the mapping's controller count.
+    /// @param [in] actuatorValues Physical actuator values to write.
+    /// @param [in] timestamp Time at which the actuator values were computed.
+    void WriteForceFeedbackOutput(
+        void* output,
+        Controller::TControllerIdentifier controllerIdentifier,
+        const Controller::ForceFeedback::SPhysicalActuatorComponents& actuatorValues,
+        uint32_t timestamp);
+
+    /// Publishes a controller's physical actuator values to external consumers via the force
+    /// feedback output mapping, creating the mapping on first use, and signals the associated
+    /// event. Intended to be invoked only when the actuator values change. Concurrency-safe.
+    /// @param [in] controllerIdentifier Identifier of the controller whose actuator values are
+    /// published.
+    /// @param [in] actuatorValues Physical actuator values to publish.
+    void PublishForceFeedbackOutput(
+        Controller::TControllerIdentifier controllerIdentifier,
+        const Controller::ForceFeedback::SPhysicalActuatorComponents& actuatorValues);
+  } // namespace SharedMemory
+} // namespace Xidi
@@ -0,0 +1,547 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file SharedMemoryTypes.h
+ *   Declaration of the data layout used by external producers to supply input to Xidi by writing
+ *   to a named shared memory mapping, and of the layout Xidi uses to publish force feedback output
+ *   to external consumers.
+ **************************************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#include "ControllerTypes.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+
+namespace Xidi
+{
+  namespace SharedMemory
+  {
+    /// Value that must appear in the first four bytes of the mapping to identify a frame that uses
+    /// the versioned layout defined in this file. Byte sequence is "XIDI" when stored in
+    /// little-endian byte order. Any mapping that does not begin with this value is interpreted as
+    /// a legacy frame consisting entirely of null-terminated JSON text.
+    inline constexpr uint32_t kFrameMagic = 0x49444958;
+
+    /// Version of the frame layout defined in this file. Frames that carry a different version are
+    /// ignored.
+    inline constexpr uint16_t kFrameVersion = 1;
+
+    /// Maximum number of keys that can appear in each of the pressed and released lists of a
+    /// binary keyboard block.
+    inline constexpr unsigned int kKeyboardBlockMaxKeys = Keyboard::kVirtualKeyboardKeyCount;
+
+    /// Number of 64-bit words in a key state bitmap, which holds one bit per keyboard key.
+    inline constexpr unsigned int kKeyStateWordCount = Keyboard::kVirtualKeyboardKeyCount / 64;
+
+    /// Type used to represent the pressed state of every keyboard key. Key N is represented by bit
+    /// (N % 64) of element (N / 64).
+    using TKeyStateBitmap = std::array<uint64_t, kKeyStateWordCount>;
+
+    /// Enumerates the possible formats of the payload that follows a frame header.
+    enum class EPayloadFormat : uint16_t
+    {
+      /// Payload consists of a keyboard block, a mouse block, and one controller block per
+      /// controller, all using the fixed layouts defined in this file.
+      Binary,
+
+      /// Payload consists of JSON text in the same format as a legacy frame. Length is given by the
+      /// frame header.
+      Json,
+
+      /// Payload consists of a ring header followed by a ring of slots, each holding one complete
+      /// binary frame along with a timestamp. Allows every frame to be observed, even if the
+      /// producer writes several of them between two reads.
+      Ring,
+
+      /// Sentinel value, total number of enumerators.
+      Count
+    };
+
+    /// Header that appears at the very start of every versioned frame.
+    struct SFrameHeader
+    {
+      /// Must be equal to #kFrameMagic.
+      uint32_t magic;
+
+      /// Must be equal to #kFrameVersion.
+      uint16_t version;
+
+      /// Format of the payload that follows this header, one of the #EPayloadFormat enumerators.
+      uint16_t payloadFormat;
+
+      /// Number of controller blocks present in a binary payload or in each slot of a ring payload.
+      /// Controllers whose identifiers are at least this number receive no input from the frame.
+      /// Ignored for JSON payloads.
+      uint16_t controllerCount;
+
+      /// Reserved for future use. Producers should set to 0.
+      uint16_t reserved;
+
+      /// Number of bytes in the payload that follows this header.
+      uint32_t payloadSizeBytes;
+
+      /// Generation counter, which allows unchanged frames to be detected cheaply. Producers
+      /// increment it to an odd value before modifying any other part of the frame and increment
+      /// it again, to an even value, once the frame is completely written. Both increments must
+      /// have release semantics. A value of 0 indicates that the producer does not maintain a
+      /// generation counter, in which case every read decodes the entire frame.
+      uint32_t generation;
+
+      /// Identifier of the producer instance that initialized the frame. Producers set it once,
+      /// when first initializing the frame, to a value that differs from the one used by any
+      /// previous instance, such as a timestamp. A change indicates that the producer restarted,
+      /// in which case Xidi discards all previously-decoded input and re-opens the mapping.
+      uint32_t instanceIdentifier;
+    };
+
+    static_assert(sizeof(SFrameHeader) == 24, "Shared memory frame layout violation.");
+    static_assert(
+        0 == (offsetof(SFrameHeader, generation) % sizeof(SFrameHeader::generation)),
+        "Shared memory frame generation counter must be naturally aligned.");
+
+    /// Flag in a binary keyboard block indicating that it holds a key state bitmap instead of the
+    /// pressed and released key lists. The bitmap occupies the first 32 bytes of the pressed key
+    /// list, and key N is pressed if bit (N % 8) of byte (N / 8) is set. Keys are submitted only
+    /// when their states change, and the pressed and released counts are ignored.
+    inline constexpr uint32_t kKeyboardBlockFlagBitmap = 0x00000001;
+
+    /// Keyboard block of a binary payload. Keys are identified by DirectInput scan code and are
+    /// submitted as pressed first and then as released, exactly as in the JSON format, unless the
+    /// block holds a key state bitmap.
+    struct SKeyboardBlock
+    {
+      /// Number of valid elements in the pressed key list.
+      uint16_t pressedCount;
+
+      /// Number of valid elements in the released key list.
+      uint16_t releasedCount;
+
+      /// Bitwise combination of the `kKeyboardBlockFlag` constants, describing the contents of
+      /// this block.
+      uint32_t flags;
+
+      /// Keys to be submitted as pressed.
+      uint8_t pressed[kKeyboardBlockMaxKeys];
+
+      /// Keys to be submitted as released.
+      uint8_t released[kKeyboardBlockMaxKeys];
+    };
+
+    static_assert(sizeof(SKeyboardBlock) == 520, "Shared memory frame layout violation.");
+    static_assert(
+        sizeof(TKeyStateBitmap) <= sizeof(SKeyboardBlock::pressed),
+        "Key state bitmap does not fit in the keyboard block.");
+
+    /// Flag in a binary mouse block indicating that the button states are valid.
+    inline constexpr uint32_t kMouseBlockFlagButtons = 0x00000001;
+
+    /// Flag in a binary mouse block indicating that the movement values are valid. Equivalent to
+    /// a non-zero `mouseMove` value in the JSON format.
+    inline constexpr uint32_t kMouseBlockFlagMovement = 0x00000002;
+
+    /// Flag in a binary mouse block indicating that the movement values are relative motion
+    /// accumulators rather than movement speeds. Each accumulator is a running total of relative
+    /// motion, in pixels for the pointer axes and in wheel units for the wheel axes, to which the
+    /// producer only ever adds and which wraps around modulo 2^32. Xidi consumes exactly the motion
+    /// added since it last read the frame. Takes precedence over #kMouseBlockFlagMovement.
+    inline constexpr uint32_t kMouseBlockFlagMotion = 0x00000004;
+
+    /// Mouse block of a binary payload.
+    struct SMouseBlock
+    {
+      /// Bitwise combination of the `kMouseBlockFlag` constants, indicating which parts of this
+      /// block are valid.
+      uint32_t flags;
+
+      /// Pressed (non-zero) or released (zero) state of each mouse button, in the order defined
+      /// by the virtual mouse button enumeration.
+      uint8_t button[static_cast<int>(Mouse::EMouseButton::Count)];
+
+      /// Reserved for future use. Producers should set to 0.
+      uint8_t reserved[3];
+
+      /// Mouse movement values in internal mouse movement units, or relative motion accumulators
+      /// if so flagged, in the order defined by the virtual mouse axis enumeration.
+      int32_t movement[static_cast<int>(Mouse::EMouseAxis::Count)];
+
+      /// Reserved for future use. Producers should set to 0.
+      uint32_t reservedTail;
+    };
+
+    static_assert(sizeof(SMouseBlock) == 32, "Shared memory frame layout violation.");
+
+    /// Controller block of a binary payload. Mirrors the virtual controller state data structure
+    /// and, like the JSON format, supplies values that replace the processed state of the
+    /// virtual controller.
+    struct SControllerBlock
+    {
+      /// Values for all axes, one element per axis, in the order defined by the axis enumeration.
+      int32_t axis[static_cast<int>(Controller::EAxis::Count)];
+
+      /// Pressed state for all buttons, one bit per button. Button N is represented by bit (N % 64)
+      /// of element (N / 64).
+      uint64_t button[static_cast<int>(Controller::EButton::Count) / 64];
+
+      /// Pressed (non-zero) or unpressed (zero) state of each POV direction, in the order defined
+      /// by the POV direction enumeration.
+      uint8_t povDirection[static_cast<int>(Controller::EPovDirection::Count)];
+
+      /// Reserved for future use. Producers should set to 0.
+      uint32_t reserved;
+    };
+
+    static_assert(sizeof(SControllerBlock) == 56, "Shared memory frame layout violation.");
+
+    /// Byte offset, from the start of the frame, of the keyboard block in a binary payload.
+    inline constexpr size_t kKeyboardBlockOffset = sizeof(SFrameHeader);
+
+    /// Byte offset, from the start of the frame, of the mouse block in a binary payload.
+    inline constexpr size_t kMouseBlockOffset = kKeyboardBlockOffset + sizeof(SKeyboardBlock);
+
+    /// Byte offset, from the start of the frame, of the first controller block in a binary
+    /// payload. Controller blocks are contiguous and ordered by controller identifier.
+    inline constexpr size_t kControllerBlockOffset = kMouseBlockOffset + sizeof(SMouseBlock);
+
+    static_assert(
+        0 == (kControllerBlockOffset % alignof(SControllerBlock)),
+        "Shared memory frame layout violation.");
+
+    /// Header of a ring payload, which immediately follows the frame header. Frames are numbered
+    /// consecutively starting at 1, and frame number N is held in slot ((N - 1) % slotCount). To
+    /// write frame number N, producers first set the slot's frame number to 0, then write the rest
+    /// of the slot, then set the slot's frame number to N, and finally set the write count to N.
+    /// The last two stores must have release semantics. Slots are overwritten without waiting for
+    /// Xidi, so the ring must be large enough to hold all frames written between two reads.
+    struct SRingHeader
+    {
+      /// Number of slots in the ring. Must not change once the frame is initialized.
+      uint32_t slotCount;
+
+      /// Total number of frames written, which is also the number of the most recent frame.
+      uint32_t writeCount;
+    };
+
+    static_assert(sizeof(SRingHeader) == 8, "Shared memory frame layout violation.");
+
+    /// Flag in a ring slot header indicating that the slot holds a delta frame rather than a full
+    /// frame. A delta frame supplies only the values that changed since the frame immediately
+    /// preceding it, and the rest of the input is carried over from that frame. Producers that
+    /// write delta frames must also write a full frame at least once every slotCount frames, so
+    /// that the ring always holds a full frame from which Xidi can reconstruct the input.
+    inline constexpr uint32_t kRingSlotFlagDelta = 0x00000001;
+
+    /// Flag in a ring slot header indicating that a delta frame includes a keyboard block. If
+    /// absent, keyboard input is carried over from the preceding frame.
+    inline constexpr uint32_t kRingSlotFlagDeltaKeyboard = 0x00000002;
+
+    /// Flag in a ring slot header indicating that a delta frame includes a mouse block. If absent,
+    /// mouse input is carried over from the preceding frame.
+    inline constexpr uint32_t kRingSlotFlagDeltaMouse = 0x00000004;
+
+    /// Header at the start of each slot of a ring payload. In a full frame it is followed by a
+    /// keyboard block, a mouse block, and one controller block per controller, using the same
+    /// layouts as a binary payload. In a delta frame it is followed by a keyboard block and a mouse
+    /// block, each only if flagged as present, and then by one controller delta block per
+    /// controller. Delta frames are tightly packed, without any padding between blocks.
+    struct SRingSlotHeader
+    {
+      /// Number of the frame held in this slot, or 0 while the slot is being written.
+      uint32_t frameNumber;
+
+      /// Time at which the producer captured the input, in milliseconds, using the same clock as
+      /// the `timeGetTime` function. Used to timestamp the buffered events that the frame
+      /// generates. A value of 0 means the time at which Xidi reads the frame is used instead.
+      uint32_t timestamp;
+
+      /// Bitwise combination of the `kRingSlotFlag` constants, describing the contents of the
+      /// slot.
+      uint32_t flags;
+
+      /// High-resolution time at which the producer captured the input, as the low 32 bits of a
+      /// `QueryPerformanceCounter` value. Used only to measure the latency between the producer
+      /// capturing the input and the application reading it. A value of 0 means that latency is
+      /// not measured for the frame.
+      uint32_t captureTime;
+    };
+
+    static_assert(sizeof(SRingSlotHeader) == 16, "Shared memory frame layout violation.");
+
+    /// Header of a controller delta block, which describes the changes to the input for a single
+    /// controller. It is followed, in order, by a pair of 64-bit words for each group of 64 buttons
+    /// flagged as changed, the first identifying the changed buttons and the second holding their
+    /// new pressed states, and then by one 32-bit value for each axis flagged as changed, in the
+    /// order defined by the axis enumeration.
+    struct SControllerDeltaHeader
+    {
+      /// Axes whose values changed, one bit per axis in the order defined by the axis enumeration.
+      uint8_t axisMask;
+
+      /// Groups of 64 buttons that contain at least one changed button, one bit per group.
+      uint8_t buttonGroupMask;
+
+      /// POV directions whose states changed, one bit per direction in the order defined by the
+      /// POV direction enumeration.
+      uint8_t povDirectionMask;
+
+      /// New pressed states of the POV directions whose states changed, using the same bit
+      /// positions as the mask.
+      uint8_t povDirectionValue;
+    };
+
+    static_assert(sizeof(SControllerDeltaHeader) == 4, "Shared memory frame layout violation.");
+    static_assert(
+        static_cast<int>(Controller::EAxis::Count) <= 8,
+        "Controller delta axis mask is too small.");
+    static_assert(
+        static_cast<int>(Controller::EPovDirection::Count) <= 8,
+        "Controller delta POV direction mask is too small.");
+
+    /// Maximum number of bytes in a controller delta block, which is the case when every element
+    /// changes.
+    inline constexpr size_t kControllerDeltaBlockMaxSizeBytes = sizeof(SControllerDeltaHeader) +
+        (2 * sizeof(uint64_t) * (static_cast<int>(Controller::EButton::Count) / 64)) +
+        (sizeof(int32_t) * static_cast<int>(Controller::EAxis::Count));
+
+    /// Number of bytes reserved for each controller in a ring slot. Large enough for either a
+    /// controller block or a controller delta block of maximum size, rounded up to preserve
+    /// alignment.
+    inline constexpr size_t kRingSlotControllerSizeBytes =
+        (std::max(sizeof(SControllerBlock), kControllerDeltaBlockMaxSizeBytes) +
+         alignof(SControllerBlock) - 1) &
+        ~(alignof(SControllerBlock) - 1);
+
+    /// Byte offset, from the start of the frame, of the ring header in a ring payload.
+    inline constexpr size_t kRingHeaderOffset = sizeof(SFrameHeader);
+
+    /// Byte offset, from the start of the frame, of the first slot in a ring payload.
+    inline constexpr size_t kRingSlotOffset = kRingHeaderOffset + sizeof(SRingHeader);
+
+    /// Computes the size of each slot of a ring payload.
+    /// @param [in] controllerCount Number of controllers for which each slot holds input.
+    /// @return Size of each slot, in bytes.
+    constexpr size_t RingSlotSizeBytes(unsigned int controllerCount)
+    {
+      return sizeof(SRingSlotHeader) + sizeof(SKeyboardBlock) + sizeof(SMouseBlock) +
+          (kRingSlotControllerSizeBytes * controllerCount);
+    }
+
+    static_assert(
+        (0 == (kRingSlotOffset % alignof(SControllerBlock))) &&
+            (0 == (RingSlotSizeBytes(1) % alignof(SControllerBlock))),
+        "Shared memory frame layout violation.");
+
+    /// Keyboard and mouse input decoded from a frame, independent of the frame's format.
+    struct SKeyboardMouseInput
+    {
+      /// Keys to be submitted as pressed, one bit per key.
+      std::bitset<Keyboard::kVirtualKeyboardKeyCount> keyPressed;
+
+      /// Keys to be submitted as released, one bit per key. Submitted after pressed keys.
+      std::bitset<Keyboard::kVirtualKeyboardKeyCount> keyReleased;
+
+      /// Indicates whether the complete key state is supplied as a bitmap.
+      bool keyStatePresent;
+
+      /// Pressed state of every keyboard key, if supplied. Only keys whose states differ from the
+      /// previously-submitted key state are submitted.
+      TKeyStateBitmap keyState;
+
+      /// Mouse buttons whose states are supplied, one bit per button.
+      std::bitset<static_cast<int>(Mouse::EMouseButton::Count)> mouseButtonPresent;
+
+      /// Pressed state of each mouse button whose state is supplied.
+      std::bitset<static_cast<int>(Mouse::EMouseButton::Count)> mouseButtonPressed;
+
+      /// Mouse axes whose movement values are supplied, one bit per axis.
+      std::bitset<static_cast<int>(Mouse::EMouseAxis::Count)> mouseMovementPresent;
+
+      /// Movement values for each mouse axis whose movement is supplied.
+      std::array<int32_t, static_cast<int>(Mouse::EMouseAxis::Count)> mouseMovement;
+
+      /// Mouse axes whose relative motion is supplied, one bit per axis.
+      std::bitset<static_cast<int>(Mouse::EMouseAxis::Count)> mouseMotionPresent;
+
+      /// Relative motion for each mouse axis whose relative motion is supplied. Input decoded from
+      /// a frame holds the producer's running totals, which are converted to the motion accumulated
+      /// since the previous read when the totals are drained.
+      std::array<int32_t, static_cast<int>(Mouse::EMouseAxis::Count)> mouseMotion;
+
+      bool operator==(const SKeyboardMouseInput& other) const = default;
+    };
+
+    /// Consumer cursor for the relative mouse motion accumulators of a single producer. Records,
+    /// for each mouse axis, the running total up to which relative motion was already consumed.
+    struct SMouseMotionCursor
+    {
+      /// Mouse axes for which a running total has been observed, one bit per axis.
+      std::bitset<static_cast<int>(Mouse::EMouseAxis::Count)> valid;
+
+      /// Running total most recently observed for each mouse axis.
+      std::array<int32_t, static_cast<int>(Mouse::EMouseAxis::Count)> total;
+
+      bool operator==(const SMouseMotionCursor& other) const = default;
+    };
+
+    /// All input decoded from a single frame, independent of the frame's format.
+    struct SFrameInput
+    {
+      /// Input for each controller, one element per controller.
+      std::array<Controller::SStateOverlay, Controller::kMaxControllerCount> controller;
+
+      /// Keyboard and mouse input.
+      SKeyboardMouseInput keyboardMouse;
+
+      /// Time at which the producer captured the input, using the same clock as the `timeGetTime`
+      /// function, or 0 if the frame does not carry a timestamp.
+      uint32_t timestamp;
+
+      /// High-resolution time at which the producer captured the input, as the low 32 bits of a
+      /// `QueryPerformanceCounter` value, or 0 if the frame does not carry one.
+      uint32_t captureTime;
+
+      bool operator==(const SFrameInput& other) const = default;
+    };
+
+    /// Maximum number of shared memory channels from which input can be read at the same time.
+    /// Each channel is a separate named mapping with its own producer and generation counter.
+    inline constexpr unsigned int kMaxChannelCount = 8;
+
+    /// Enumerates the ways in which values supplied for the same element by multiple channels are
+    /// merged. Only channels that supply an element take part in merging it.
+    enum class EMergePolicy : uint8_t
+    {
+      /// Value from the lowest-numbered channel wins.
+      Priority,
+
+      /// Element is pressed if any channel reports it as pressed. Buttons and POV directions only.
+      Or,
+
+      /// Displacements from neutral are added together and saturated. Axes only.
+      Sum,
+
+      /// Value furthest from neutral wins. Axes only.
+      Max
+    };
+
+    /// Holds the merge policies that apply to each type of controller element. Keyboard keys and
+    /// mouse buttons are always merged using the OR policy, and mouse movement is always summed.
+    struct SMergePolicy
+    {
+      /// Merge policy for buttons and POV directions.
+      EMergePolicy button = EMergePolicy::Or;
+
+      /// Merge policy for each axis, one element per axis. Defaults to the priority policy.
+      std::array<EMergePolicy, static_cast<int>(Controller::EAxis::Count)> axis = {};
+
+      bool operator==(const SMergePolicy& other) const = default;
+    };
+
+    /// Value that must appear in the first four bytes of the force feedback output mapping. Byte
+    /// sequence is "XIDF" when stored in little-endian byte order.
+    inline constexpr uint32_t kForceFeedbackOutputMagic = 0x46444958;
+
+    /// Version of the force feedback output layout defined in this file.
+    inline constexpr uint16_t kForceFeedbackOutputVersion = 1;
+
+    /// Number of slots in the ring of force feedback output records.
+    inline constexpr uint32_t kForceFeedbackOutputSlotCount = 64;
+
+    /// Header that appears at the very start of the force feedback output mapping. It is followed
+    /// by one record per controller, holding that controller's current actuator values, and then
+    /// by a ring of records, each describing one change to one controller's actuator values.
+    /// Records are numbered consecutively starting at 1, and record number N is held in ring slot
+    /// ((N - 1) % slotCount). To write record number N, Xidi first sets the sequence numbers of the
+    /// ring slot and of the controller's current record to 0, then writes the rest of both, then
+    /// sets both sequence numbers to N, and finally sets the write count to N. The last two steps
+    /// use release semantics, so consumers that read a sequence number, then the record, and then
+    /// the sequence number again can detect a record that changed while being read.
+    struct SForceFeedbackOutputHeader
+    {
+      /// Always equal to #kForceFeedbackOutputMagic.
+      uint32_t magic;
+
+      /// Always equal to #kForceFeedbackOutputVersion.
+      uint16_t version;
+
+      /// Number of controllers, which is also the number of current records.
+      uint16_t controllerCount;
+
+      /// Number of slots in the ring.
+      uint32_t slotCount;
+
+      /// Total number of records written, which is also the number of the most recent record.
+      uint32_t writeCount;
+
+      /// Identifier of the Xidi instance that initialized the mapping. Changes if the mapping is
+      /// initialized again by a different process.
+      uint32_t instanceIdentifier;
+
+      /// Reserved for future use. Always 0.
+      uint32_t reserved;
+    };
+
+    static_assert(
+        sizeof(SForceFeedbackOutputHeader) == 24, "Force feedback output layout violation.");
+
+    /// Single force feedback output record, holding the physical actuator values of one
+    /// controller.
+    struct SForceFeedbackOutputRecord
+    {
+      /// Number of the record, or 0 while the record is being written. For a controller's current
+      /// record, this is the number of the ring record that most recently changed it.
+      uint32_t sequence;
+
+      /// Time at which the actuator values were computed, using the same clock as the
+      /// `timeGetTime` function.
+      uint32_t timestamp;
+
+      /// Identifier of the controller to which the actuator values apply.
+      uint16_t controllerIdentifier;
+
+      /// Reserved for future use. Always 0.
+      uint16_t reserved;
+
+      /// Physical actuator values, in the order left motor, right motor, left impulse trigger,
+      /// right impulse trigger. Unlike XInput, which has no way of driving impulse triggers, all
+      /// four values are published.
+      uint16_t actuator[4];
+    };
+
+    static_assert(
+        sizeof(SForceFeedbackOutputRecord) == 20, "Force feedback output layout violation.");
+
+    /// Byte offset, from the start of the force feedback output mapping, of the first current
+    /// record. Current records are contiguous and ordered by controller identifier.
+    inline constexpr size_t kForceFeedbackOutputCurrentOffset = sizeof(SForceFeedbackOutputHeader);
+
+    /// Computes the byte offset, from the start of the force feedback output mapping, of the first
+    /// ring slot.
+    /// @param [in] controllerCount Number of controllers.
+    /// @return Offset of the first ring slot, in bytes.
+    constexpr size_t ForceFeedbackOutputRingOffset(unsigned int controllerCount)
+    {
+      return kForceFeedbackOutputCurrentOffset +
+          (sizeof(SForceFeedbackOutputRecord) * controllerCount);
+    }
+
+    /// Computes the total size of the force feedback output mapping.
+    /// @param [in] controllerCount Number of controllers.
+    /// @return Size of the mapping, in bytes.
+    constexpr size_t ForceFeedbackOutputSizeBytes(unsigned int controllerCount)
+    {
+      return ForceFeedbackOutputRingOffset(controllerCount) +
+          (sizeof(SForceFeedbackOutputRecord) * kForceFeedbackOutputSlotCount);
+    }
+  } // namespace SharedMemory
+} // namespace Xidi
@@ -69,6 +69,23 @@ namespace Xidi
     /// Base name of the WinMM library to import.
     inline constexpr std::wstring_view kStrLibraryNameWinMM = L"winmm.dll";
 
+    /// Name of the shared memory mapping to which external producers write input for Xidi.
+    inline constexpr std::wstring_view kStrSharedMemoryInputMappingName = L"Local\\XidiControllers";
+
+    /// Suffix appended to the name of a shared memory mapping to obtain the name of the optional
+    /// event that external producers signal after writing to that mapping.
+    inline constexpr std::wstring_view kStrSharedMemoryInputEventNameSuffix = L"Updated";
+
+    /// Name of the shared memory mapping to which Xidi publishes force feedback output for
+    /// external consumers.
+    inline constexpr std::wstring_view kStrSharedMemoryForceFeedbackMappingName =
+        L"Local\\XidiForceFeedback";
+
+    /// Name of the event that Xidi signals after publishing force feedback output to shared
+    /// memory.
+    inline constexpr std::wstring_view kStrSharedMemoryForceFeedbackEventName =
+        L"Local\\XidiForceFeedbackUpdated";
+
     /// Configuration file section name for overriding import libraries.
     inline constexpr std::wstring_view kStrConfigurationSectionImport = L"Import";
 
@@ -95,6 +112,11 @@ namespace Xidi
     /// Configuration file setting for specifying the logging verbosity level.
     inline constexpr std::wstring_view kStrConfigurationSettingLogLevel = L"Level";
 
+    /// Configuration file setting for specifying how often, in seconds, to log a summary of
+    /// physical controller poll timing.
+    inline constexpr std::wstring_view kStrConfigurationSettingLogPollTimingIntervalSeconds =
+        L"PollTimingIntervalSeconds";
+
     /// Configuration file section name for mapper-related settings.
     inline constexpr std::wstring_view kStrConfigurationSectionMapper = L"Mapper";
 
@@ -115,6 +137,34 @@ namespace Xidi
     /// of virtual controllers.
     inline constexpr std::wstring_view kStrConfigurationSectionProperties = L"Properties";
 
+    /// Configuration file setting for specifying the number of controllers presented to
+    /// applications, including those that receive input only from external producers.
+    inline constexpr std::wstring_view kStrConfigurationSettingPropertiesControllerCount =
+        L"ControllerCount";
+
+    /// Configuration file setting for enabling adaptive polling of physical controllers, which
+    /// polls quickly while input is changing and slowly while it is not.
+    inline constexpr std::wstring_view kStrConfigurationSettingPropertiesAdaptivePolling =
+        L"AdaptivePolling";
+
+    /// Configuration file setting for specifying the physical controller polling period, in
+    /// milliseconds, that adaptive polling uses while input is changing.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingPropertiesActivePollingPeriodMilliseconds =
+            L"ActivePollingPeriodMilliseconds";
+
+    /// Configuration file setting for specifying the physical controller polling period, in
+    /// milliseconds, to which adaptive polling decays once input stops changing.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingPropertiesIdlePollingPeriodMilliseconds =
+            L"IdlePollingPeriodMilliseconds";
+
+    /// Configuration file setting for specifying how many milliseconds input must remain unchanged
+    /// before adaptive polling starts to decay towards the idle polling period.
+    inline constexpr std::wstring_view
+        kStrConfigurationSettingPropertiesIdlePollingDelayMilliseconds =
+            L"IdlePollingDelayMilliseconds";
+
     /// Configuration file setting for customizing the mouse speed. Expressed as a percentage that
     /// is used to scale the default mouse speed.
     inline constexpr std::wstring_view
@@ -199,6 +249,24 @@ namespace Xidi
         kStrConfigurationSettingsWorkaroundsIgnoreEnumObjectsCallbackReturnCode =
             L"IgnoreEnumObjectsCallbackReturnCode";
 
+    /// Configuration file section name for settings that govern how input supplied by external
+    /// producers via shared memory is read.
+    inline constexpr std::wstring_view kStrConfigurationSectionSharedMemory = L"SharedMemory";
+
+    /// Configuration file setting for specifying the name of a shared memory mapping from which to
+    /// read input. Used as a prefix for per-channel settings.
+    inline constexpr std::wstring_view kStrConfigurationSettingSharedMemoryChannel = L"Channel";
+
+    /// Configuration file setting for specifying how button and POV direction states supplied by
+    /// multiple shared memory channels are merged.
+    inline constexpr std::wstring_view kStrConfigurationSettingSharedMemoryButtonMerge =
+        L"ButtonMerge";
+
+    /// Configuration file setting for specifying how axis values supplied by multiple shared memory
+    /// channels are merged. Also used as a prefix for per-axis settings.
+    inline constexpr std::wstring_view kStrConfigurationSettingSharedMemoryAxisMerge =
+        L"AxisMerge";
+
     // These strings are not safe to access before run-time, and should not be used to perform
     // dynamic initialization. Views are guaranteed to be null-terminated.
 
@@ -286,6 +354,22 @@ namespace Xidi
     std::wstring_view MapperTypeConfigurationNameString(
         Controller::TControllerIdentifier controllerIdentifier);
 
+    /// Retrieves a string used to represent a per-channel shared memory mapping name configuration
+    /// setting. These are initialized on first invocation and returned subsequently as read-only
+    /// views. An empty view is returned if an invalid channel index is specified.
+    /// @param [in] channelIndex Zero-based index of the channel for which a string is desired.
+    /// @return Corresponding configuration setting string, or an empty view if the channel index
+    /// is out of range.
+    std::wstring_view SharedMemoryChannelConfigurationNameString(unsigned int channelIndex);
+
+    /// Retrieves a string used to represent a per-axis shared memory merge policy configuration
+    /// setting. These are initialized on first invocation and returned subsequently as read-only
+    /// views. An empty view is returned if an invalid axis is specified.
+    /// @param [in] axis Axis for which a string is desired.
+    /// @return Corresponding configuration setting string, or an empty view if the axis is out of
+    /// range.
+    std::wstring_view SharedMemoryAxisMergeConfigurationNameString(Controller::EAxis axis);
+
     /// Splits a string using the specified delimiter string and returns a list of views each
     /// corresponding to a part of the input string. If there are too many delimiters present such
     /// that not all of the pieces can fit into the returned container type then the returned
@@ -12,12 +12,11 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <bitset>
 #include <cstdint>
 #include <functional>
 #include <mutex>
-#include <stop_token>
-#include <thread>
 #include <utility>
 
 #include "ControllerTypes.h"
@@ -76,6 +75,10 @@ namespace Xidi
       /// Default value for force feedback gain. No scaling down of effects by default.
       static constexpr uint32_t kFfGainDefault = kFfGainMax;
 
+      /// Type for functions that are supplied with the processed state view whenever it changes.
+      /// Always invoked while this virtual controller's lock is held.
+      using TProcessedStateObserver = std::function<void(const SState&)>;
+
       /// Permits users of the associated virtual controller to ignore certain controller elements
       /// and cause them not to generate state change events. For use with buffered events.
       class EventFilter
@@ -137,6 +140,16 @@ namespace Xidi
           return filter.test(ElementToIndex(element));
         }
 
+        /// Retrieves up to 64 consecutive bits of the filter at once, which allows many elements to
+        /// be tested together.
+        /// @param [in] baseIndex Filter index of the first bit to retrieve, which becomes the least
+        /// significant bit of the result.
+        /// @return Filter bits starting at the base index. Bits beyond the end of the filter are 0.
+        inline uint64_t GetWord(unsigned int baseIndex) const
+        {
+          return ((filter >> baseIndex) & decltype(filter)(ULLONG_MAX)).to_ullong();
+        }
+
         /// Remove the specified virtual controller element from the filter so that events are not
         /// generated for it.
         /// @param [in] element Desired virtual controller element.
@@ -308,12 +321,62 @@ namespace Xidi
         }
       };
 
+      /// Fixed-point coefficients for transforming the raw values on one side of an axis, meaning
+      /// either the values above neutral or the values at or below neutral. Compiled from axis
+      /// properties whenever they change so that transforming a raw value requires no division.
+      struct SAxisTransformSide
+      {
+        /// Raw value at which the deadzone region ends and values start moving away from neutral.
+        int32_t deadzoneCutoff;
+
+        /// Direction in which raw values move away from neutral, either 1 or -1.
+        int32_t direction;
+
+        /// Distance between the deadzone and saturation cutoffs, to which the displacement of a
+        /// raw value from the deadzone cutoff is clamped. Always at least 1.
+        int32_t span;
+
+        /// Whole part of the ratio between the magnitude of the reportable range and the span.
+        uint64_t quotient;
+
+        /// Remainder of the ratio between the magnitude of the reportable range and the span.
+        uint32_t remainder;
+
+        /// Fixed-point reciprocal of the span, used to divide products of a displacement and the
+        /// remainder exactly.
+        uint64_t reciprocal;
+
+        /// Number of fractional bits in the reciprocal.
+        uint32_t reciprocalShift;
+
+        /// All bits set if transformed values move below neutral, 0 if they move above it.
+        int64_t negateMask;
+
+        constexpr bool operator==(const SAxisTransformSide& other) const = default;
+      };
+
+      /// Compiled form of the properties of an individual axis, used to transform its raw values.
+      struct SAxisTransform
+      {
+        /// Specifies whether or not raw values should be transformed at all.
+        bool transformationsEnabled;
+
+        /// Neutral value for the axis.
+        int32_t rangeNeutral;
+
+        /// Coefficients for each side of the axis. The negative side is first, followed by the
+        /// positive side.
+        std::array<SAxisTransformSide, 2> side;
+
+        constexpr bool operator==(const SAxisTransform& other) const = default;
+      };
+
       VirtualController(TControllerIdentifier controllerId);
 
       VirtualController(const VirtualController& other) = delete;
 
-      /// Cleans up and terminates the background monitoring thread, and unregisters this controller
-      /// for force feedback.
+      /// Unregisters this controller as a consumer of physical controller input and for force
+      /// feedback.
       ~VirtualController(void);
 
       /// Modifies the contents of the specified controller state object by applying this virtual
@@ -498,14 +561,20 @@ namespace Xidi
         return std::unique_lock(controllerMutex);
       }
 
+      /// Records the latency between an external producer capturing the input that last changed
+      /// this virtual controller's state and an application reading it, if that input carried a
+      /// high-resolution capture time and its latency was not already recorded. Invoked whenever
+      /// an application reads this virtual controller's state or its buffered events. Lock-free.
+      void RecordInputLatency(void);
+
       /// Removes and discards up to the specified number of the oldest events from this virtual
       /// controller's event buffer and clears any present overflow condition.
       /// @param [in] numEventsToPop Maximum number of events to remove.
       void PopEventBufferOldestEvents(uint32_t numEventsToPop);
 
       /// Generates this virtual controller's processed state view by applying this virtual
-      /// controller's properties to its raw state view. Not concurrency-safe, and primarily
-      /// intended for internal use.
+      /// controller's properties to its raw state view and then applying externally-supplied
+      /// input. Not concurrency-safe, and primarily intended for internal use.
       void ReapplyProperties(void);
 
       /// Refreshes the virtual controller's state using the supplied new state data.
@@ -517,6 +586,45 @@ namespace Xidi
       /// state data, `false` otherwise.
       bool RefreshState(SState newRawVirtualStateData);
 
+      /// Refreshes the virtual controller's state using the supplied new externally-supplied input,
+      /// which is applied on top of the processed state. Primarily intended to be called by a
+      /// background thread, but exposed externally for testing.
+      /// @param [in] newExternalInputOverlay Externally-supplied input to apply to this virtual
+      /// controller's internal state view.
+      /// @return `true` if the state of the controller changed as a result of applying the new
+      /// externally-supplied input, `false` otherwise.
+      bool RefreshState(const SStateOverlay& newExternalInputOverlay);
+
+      /// Refreshes the virtual controller's state using the supplied new externally-supplied input,
+      /// which is applied on top of the processed state, and timestamps any resulting state change
+      /// events with the time at which the input was captured rather than the current time.
+      /// Primarily intended to be called by a background thread, but exposed externally for
+      /// testing.
+      /// @param [in] newExternalInputOverlay Externally-supplied input to apply to this virtual
+      /// controller's internal state view.
+      /// @param [in] timestamp Time at which the externally-supplied input was captured, using the
+      /// same clock as the `timeGetTime` function.
+      /// @return `true` if the state of the controller changed as a result of applying the new
+      /// externally-supplied input, `false` otherwise.
+      bool RefreshState(const SStateOverlay& newExternalInputOverlay, uint32_t timestamp);
+
+      /// Refreshes the virtual controller's state using the supplied new externally-supplied input,
+      /// which is applied on top of the processed state, timestamps any resulting state change
+      /// events with the time at which the input was captured, and arranges for the latency
+      /// between capture and the next application read to be measured. Primarily intended to be
+      /// called by a background thread, but exposed externally for testing.
+      /// @param [in] newExternalInputOverlay Externally-supplied input to apply to this virtual
+      /// controller's internal state view.
+      /// @param [in] timestamp Time at which the externally-supplied input was captured, using the
+      /// same clock as the `timeGetTime` function.
+      /// @param [in] captureTime High-resolution time at which the externally-supplied input was
+      /// captured, as the low 32 bits of a `QueryPerformanceCounter` value, or 0 if latency should
+      /// not be measured.
+      /// @return `true` if the state of the controller changed as a result of applying the new
+      /// externally-supplied input, `false` otherwise.
+      bool RefreshState(
+          const SStateOverlay& newExternalInputOverlay, uint32_t timestamp, uint32_t captureTime);
+
       /// Sets the deadzone property for a single axis.
       /// @param [in] axis Target axis.
       /// @param [in] deadzone Desired deadzone value.
@@ -581,6 +689,13 @@ namespace Xidi
       /// `false` otherwise.
       bool SetForceFeedbackGain(uint32_t ffGain);
 
+      /// Sets the function to be supplied with the processed state view whenever it changes, which
+      /// is also supplied with the current processed state view immediately. Only one such
+      /// function can be set at a time.
+      /// @param [in] observer Function to set, or an empty function to stop supplying the
+      /// processed state view.
+      void SetProcessedStateObserver(TProcessedStateObserver observer);
+
       /// Sets the state change event handle, which will be signalled whenever a virtual controller
       /// state change occurs.
       /// @param [in] eventHandle New event handle to set, or `NULL` to disable notifications
@@ -593,9 +708,31 @@ namespace Xidi
 
     private:
 
+      /// Compiles the properties of the specified axis into the coefficients used to transform its
+      /// raw values. Must be invoked whenever the properties of an axis change. Caller must hold
+      /// this virtual controller's lock.
+      /// @param [in] axis Axis whose properties changed.
+      void CompileAxisTransform(EAxis axis);
+
+      /// Compiles the properties of all axes into the coefficients used to transform their raw
+      /// values. Caller must hold this virtual controller's lock.
+      void CompileAllAxisTransforms(void);
+
+      /// Generates a new processed state view from the raw state view and externally-supplied
+      /// input and, if it differs from the current processed state view, submits state change
+      /// events and replaces the current processed state view. Caller must hold this virtual
+      /// controller's lock.
+      /// @param [in] timestamp Timestamp to apply to any state change events that are submitted.
+      /// @return `true` if the processed state view changed, `false` otherwise.
+      bool UpdateProcessedState(uint32_t timestamp);
+
       /// Controller identifier to be used when communicating with the underlying real controller.
       const TControllerIdentifier kControllerIdentifier;
 
+      /// Capabilities of this virtual controller, which do not change once it is created. Kept
+      /// here so that processing state does not require looking them up each time.
+      const SCapabilities kCapabilities;
+
       /// Provides concurrency control to the data structures in this virtual controller.
       std::recursive_mutex controllerMutex;
 
@@ -609,24 +746,33 @@ namespace Xidi
       /// All properties associated with this virtual controller.
       SProperties properties;
 
+      /// Compiled form of the axis properties, one element per possible axis.
+      std::array<SAxisTransform, static_cast<int>(EAxis::Count)> axisTransforms;
+
       /// State of the virtual controller as of the last refresh.
       /// Raw values, with no properties or other processing applied.
       SState stateRaw;
 
+      /// Input supplied by external producers as of the last refresh.
+      /// Applied on top of the raw state after all properties have been applied.
+      SStateOverlay stateExternalInput;
+
       /// State of the virtual controller as of the last refresh.
       /// Fully processed, all properties have been applied.
       SState stateProcessed;
 
+      /// High-resolution time at which the externally-supplied input that last changed the
+      /// processed state view was captured, or 0 if there is no such input whose latency still
+      /// needs to be recorded.
+      std::atomic<uint32_t> pendingInputCaptureTime;
+
+      /// Function to be supplied with the processed state view whenever it changes, if any.
+      TProcessedStateObserver processedStateObserver;
+
       /// State change event notification handle, optionally provided by applications.
       /// The underlying event object is owned by the application, not by this object.
       HANDLE stateChangeEventHandle;
 
-      /// Background thread that monitors the associated physical controller for updates.
-      std::thread physicalControllerMonitor;
-
-      /// Used to indicate that the physical controller monitor thread should stop running.
-      std::stop_source physicalControllerMonitorStop;
-
       /// Pointer to the physical device force feedback buffer. Valid only if this virtual
       /// controller object is registered for force feedback, `nullptr` all other times.
       ForceFeedback::Device* physicalControllerForceFeedbackBuffer;
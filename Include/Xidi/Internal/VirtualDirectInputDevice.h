@@ -281,6 +281,10 @@ namespace Xidi
     /// Data format specification for communicating with the DirectInput application.
     std::unique_ptr<DataFormat> dataFormat;
 
+    /// Application data packet, which is rendered using the data format whenever the virtual
+    /// controller's state changes.
+    DataPacketBuffer dataPacket;
+
     /// Registry of all force feedback effect objects created by this object. Deliberately not
     /// type-safe to avoid a circular dependency between header files. Used exclusively to allow
     /// DirectInput device objects to enumerate the effect objects associated with them.
@@ -42,7 +42,8 @@ namespace XidiTest
       return (
           (virtualMouseButtonState == other.virtualMouseButtonState) &&
           (virtualMouseMovementContributionBySource ==
-           other.virtualMouseMovementContributionBySource));
+           other.virtualMouseMovementContributionBySource) &&
+          (virtualMouseRelativeMovement == other.virtualMouseRelativeMovement));
     }
 
     /// Installs this virtual mouse as the one to which mouse events generated by mouse interface
@@ -63,6 +64,11 @@ namespace XidiTest
     std::optional<int> GetMovementContributionFromSource(
         EMouseAxis axis, uint32_t sourceIdentifier) const;
 
+    /// Retrieves the total relative mouse movement that was submitted along the specified axis.
+    /// @param [in] axis Mouse axis for which the relative movement is being queried.
+    /// @return Sum of all relative mouse movement submitted along the specified axis.
+    int GetRelativeMovement(EMouseAxis axis) const;
+
     /// Submits a mouse movement.
     /// @param [in] axis Mouse axis that is affected.
     /// @param [in] mouseMovementUnits Number of internal mouse movement units along the target
@@ -70,6 +76,11 @@ namespace XidiTest
     /// @param [in] sourceIdentifier Opaque identifier for the source of the mouse movement event.
     void SubmitMouseMovement(EMouseAxis axis, int mouseMovementUnits, uint32_t sourceIdentifier);
 
+    /// Submits relative mouse movement.
+    /// @param [in] axis Mouse axis that is affected.
+    /// @param [in] mouseMovementPixels Amount of movement along the target mouse axis.
+    void SubmitMouseRelativeMovement(EMouseAxis axis, int mouseMovementPixels);
+
     /// Submits a mouse button state of pressed.
     /// @param [in] button Mouse button that is affected.
     void SubmitMouseButtonPressedState(EMouseButton button);
@@ -87,5 +98,8 @@ namespace XidiTest
     /// source identifier, one map per mouse axis.
     std::array<std::unordered_map<uint32_t, int>, (unsigned int)EMouseAxis::Count>
         virtualMouseMovementContributionBySource;
+
+    /// Holds the sum of all relative mouse movement submitted along each mouse axis.
+    std::array<int, (unsigned int)EMouseAxis::Count> virtualMouseRelativeMovement = {};
   };
 } // namespace XidiTest
@@ -24,6 +24,24 @@ namespace XidiTest
 {
   using namespace ::Xidi::Controller;
 
+  /// Object used to override the number of controllers that the physical controller interface
+  /// reports. Control is RAII-style, and the previous number of controllers is restored when the
+  /// object is destroyed. Should be created ahead of any MockPhysicalController objects that use
+  /// controller identifiers beyond the default number of controllers.
+  class MockControllerCount
+  {
+  public:
+
+    MockControllerCount(TControllerIdentifier controllerCount);
+
+    ~MockControllerCount(void);
+
+  private:
+
+    /// Number of controllers reported before this object was created.
+    const TControllerIdentifier kPreviousControllerCount;
+  };
+
   /// Object used to exert behavioral control over the physical controller interface. The physical
   /// controller interface itself is implemented as free functions. Test cases can use instances of
   /// this object to control the behavior of that interface. All required state is maintained in an
@@ -45,9 +63,13 @@ namespace XidiTest
 
     ~MockPhysicalController(void);
 
-    /// Advances to the next physical state.
-    /// Intended to be invoked internally only.
-    void AdvancePhysicalState(void);
+    /// Unregisters a virtual controller as a consumer of input.
+    /// @param [in] controllerToUnregister Pointer to the virtual controller object that should be
+    /// unregistered as a consumer of input.
+    inline void EraseInputRegistration(VirtualController* controllerToUnregister)
+    {
+      inputRegistration.erase(controllerToUnregister);
+    }
 
     /// Unregisters a virtual controller for force feedback.
     /// @param [in] controllerToRegister Pointer to the virtual controller object that should be
@@ -78,6 +100,12 @@ namespace XidiTest
       return forceFeedbackDevice;
     }
 
+    /// Registers a virtual controller as a consumer of input and refreshes its state to match the
+    /// current physical state.
+    /// @param [in] controllerToRegister Pointer to the virtual controller object that should be
+    /// registered as a consumer of input.
+    void InsertInputRegistration(VirtualController* controllerToRegister);
+
     /// Registers a virtual controller for force feedback.
     /// @param [in] controllerToRegister Pointer to the virtual controller object that should be
     /// registered for force feedback.
@@ -101,15 +129,9 @@ namespace XidiTest
       return kControllerIdentifier;
     }
 
-    /// Retrieves and returns whether or not an advancement to the next physical state has been
-    /// requested.
-    /// @return `true` if so, `false` if not.
-    inline bool IsAdvanceStateRequested(void) const
-    {
-      return advanceRequested;
-    }
-
-    /// Requests an advancement to the next physical state.
+    /// Advances to the next physical state and, like the real physical controller interface,
+    /// refreshes the state of all virtual controllers registered as consumers of input and signals
+    /// their state change events if their states changed.
     /// Test will fail due to a test implementation issue if attempting to advance past the end of
     /// the physical state array.
     void RequestAdvancePhysicalState(void);
@@ -130,11 +152,6 @@ namespace XidiTest
     /// Begins at 0 and increases whenever a test case advances to the next physical state.
     size_t currentPhysicalStateIndex;
 
-    /// Flag which specifies whether or not the next wait-for-state-change operation should
-    /// result in an advancement of the reported physical state to the next element in the
-    /// physical state array.
-    bool advanceRequested;
-
     /// Force feedback device associated with the physical controller.
     /// Initialized to use a base timestamp of 0.
     ForceFeedback::Device forceFeedbackDevice;
@@ -143,6 +160,9 @@ namespace XidiTest
     /// virtual states.
     const Mapper& mapper;
 
+    /// Virtual controllers registered as consumers of input.
+    std::set<VirtualController*> inputRegistration;
+
     /// Virtual controllers registered for force feedback.
     std::set<const VirtualController*> forceFeedbackRegistration;
   };
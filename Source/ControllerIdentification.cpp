@@ -23,6 +23,7 @@
 #include "Globals.h"
 #include "Mapper.h"
 #include "Message.h"
+#include "PhysicalController.h"
 #include "Strings.h"
 #include "TemporaryBuffer.h"
 
@@ -317,7 +318,7 @@ namespace Xidi
       bool forceFeedbackRequired)
   {
     std::unique_ptr<DeviceInstanceType> instanceInfo = std::make_unique<DeviceInstanceType>();
-    uint32_t numControllersToEnumerate = Controller::kPhysicalControllerCount;
+    uint32_t numControllersToEnumerate = Controller::GetControllerCount();
 
     const uint64_t activeVirtualControllerMask =
         Globals::GetConfigurationData()
@@ -506,7 +507,7 @@ namespace Xidi
     Controller::TControllerIdentifier xindex =
         ExtractVirtualControllerInstanceFromGuid(instanceGUID);
 
-    if (xindex < Controller::kPhysicalControllerCount)
+    if (xindex < Controller::GetControllerCount())
     {
       GUID realXInputGUID = VirtualControllerGuid(xindex);
       if (realXInputGUID == instanceGUID) return (Controller::TControllerIdentifier)xindex;
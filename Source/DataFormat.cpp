@@ -12,6 +12,9 @@
 
 #include "DataFormat.h"
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <optional>
@@ -766,4 +769,32 @@ namespace Xidi
 
     return true;
   }
+
+  void DataPacketBuffer::Read(void* packetBuffer, TOffset packetSizeBytes) const
+  {
+    while (true)
+    {
+      const uint32_t sequenceBefore = sequence.load(std::memory_order_acquire);
+
+      std::memcpy(packetBuffer, packet[sequenceBefore & 1], packetSizeBytes);
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      // The buffer that was just copied is only ever overwritten after another packet is rendered
+      // into the other buffer, so the copy is consistent unless a render completed meanwhile.
+      if (sequenceBefore == sequence.load(std::memory_order_relaxed)) return;
+    }
+  }
+
+  void DataPacketBuffer::Render(
+      const DataFormat& dataFormat, const Controller::SState& controllerState)
+  {
+    // This unguarded read is safe because by design only one thread renders at a time. The fence
+    // keeps the writes below from becoming visible before the previous render was published.
+    const uint32_t nextSequence = 1 + sequence.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    dataFormat.WriteDataPacket(
+        packet[nextSequence & 1], dataFormat.GetPacketSizeBytes(), controllerState);
+    sequence.store(nextSequence, std::memory_order_release);
+  }
 } // namespace Xidi
@@ -0,0 +1,101 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file InputInjection.cpp
+ *   Implementation of functionality for accepting input injected directly by other modules loaded
+ *   into the same process.
+ **************************************************************************************************/
+
+#include "InputInjection.h"
+
+#include <cstdint>
+
+#include "ApiWindows.h"
+#include "ApiXidi.h"
+#include "ConcurrencyQueue.h"
+#include "ControllerTypes.h"
+#include "ImportApiWinMM.h"
+#include "InputLatency.h"
+#include "PhysicalController.h"
+#include "SharedMemoryTypes.h"
+
+namespace Xidi
+{
+  namespace InputInjection
+  {
+    /// Batches of injected input that were not yet passed on to the virtual controllers.
+    static ConcurrencyQueue<SInjectedInput, kPendingInputCapacity> pendingInput;
+
+    HANDLE GetSignalEvent(void)
+    {
+      static const HANDLE signalEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+      return signalEvent;
+    }
+
+    bool ReadInjectedInput(SInjectedInput& injectedInput)
+    {
+      return pendingInput.Pop(injectedInput);
+    }
+
+    bool SubmitInput(
+        const SControllerInput* controllerInputs,
+        unsigned int controllerInputCount,
+        const SharedMemory::SKeyboardMouseInput* keyboardMouseInput)
+    {
+      if ((nullptr == controllerInputs) && (0 != controllerInputCount)) return false;
+
+      SInjectedInput injectedInput = {
+          .timestamp = ImportApiWinMM::timeGetTime(),
+          .captureTime = InputLatency::CaptureTimeNow()};
+
+      for (unsigned int i = 0; i < controllerInputCount; ++i)
+      {
+        const Controller::TControllerIdentifier controllerIdentifier =
+            controllerInputs[i].controllerIdentifier;
+        if (controllerIdentifier >= Controller::GetControllerCount()) return false;
+
+        injectedInput.controllerPresent[controllerIdentifier] = true;
+        injectedInput.controller[controllerIdentifier] = controllerInputs[i].overlay;
+      }
+
+      if (nullptr != keyboardMouseInput)
+      {
+        injectedInput.keyboardMousePresent = true;
+        injectedInput.keyboardMouse = *keyboardMouseInput;
+      }
+
+      if (false == pendingInput.Push(injectedInput)) return false;
+
+      const HANDLE signalEvent = GetSignalEvent();
+      if (nullptr != signalEvent) SetEvent(signalEvent);
+
+      return true;
+    }
+  } // namespace InputInjection
+
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IInputInjection.
+    class InputInjectionProvider : public IInputInjection
+    {
+    public:
+
+      // IInputInjection
+      bool SubmitInput(
+          const InputInjection::SControllerInput* controllerInputs,
+          unsigned int controllerInputCount,
+          const SharedMemory::SKeyboardMouseInput* keyboardMouseInput) override
+      {
+        return InputInjection::SubmitInput(
+            controllerInputs, controllerInputCount, keyboardMouseInput);
+      }
+    };
+
+    /// Singleton Xidi API implementation object.
+    static InputInjectionProvider inputInjectionProvider;
+  } // namespace Api
+} // namespace Xidi
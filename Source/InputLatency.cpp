@@ -0,0 +1,230 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file InputLatency.cpp
+ *   Implementation of functionality for measuring the latency between external producers
+ *   capturing input and applications reading it.
+ **************************************************************************************************/
+
+#include "InputLatency.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <optional>
+
+#include "ApiWindows.h"
+#include "ApiXidi.h"
+#include "ControllerTypes.h"
+#include "Message.h"
+
+namespace Xidi
+{
+  namespace InputLatency
+  {
+    /// Latency histograms, one per controller.
+    static Histogram latencyHistograms[Controller::kMaxControllerCount];
+
+    /// Retrieves and returns the frequency of the high-resolution performance counter.
+    /// @return Number of performance counter ticks per second.
+    static uint64_t GetPerformanceCounterFrequency(void)
+    {
+      static const uint64_t performanceCounterFrequency = []() -> uint64_t
+      {
+        LARGE_INTEGER frequency = {};
+        QueryPerformanceFrequency(&frequency);
+        return static_cast<uint64_t>(frequency.QuadPart);
+      }();
+
+      return performanceCounterFrequency;
+    }
+
+    unsigned int Histogram::BucketIndex(uint32_t latency)
+    {
+      if (latency < kSubBucketCount) return latency;
+
+      const unsigned int exponent = static_cast<unsigned int>(std::bit_width(latency)) - 1;
+      const unsigned int subBucket =
+          ((latency >> (exponent - kSubBucketBits)) & (kSubBucketCount - 1));
+
+      return ((kSubBucketCount * (exponent - kSubBucketBits + 1)) + subBucket);
+    }
+
+    uint32_t Histogram::BucketUpperBound(unsigned int bucketIndex)
+    {
+      if (bucketIndex < kSubBucketCount) return bucketIndex;
+
+      const unsigned int exponent = ((bucketIndex / kSubBucketCount) + kSubBucketBits - 1);
+      const unsigned int subBucket = (bucketIndex % kSubBucketCount);
+      const uint64_t bucketWidth = (1ull << (exponent - kSubBucketBits));
+
+      return static_cast<uint32_t>(
+          ((kSubBucketCount + subBucket) * bucketWidth) + bucketWidth - 1);
+    }
+
+    SSummary Histogram::GetSummary(void) const
+    {
+      // Bucket counts are copied first so that the percentiles are computed from a single
+      // consistent view, even if samples are being recorded concurrently.
+      std::array<uint32_t, kBucketCount> bucketCountsSnapshot;
+      uint64_t snapshotSampleCount = 0;
+
+      for (unsigned int i = 0; i < kBucketCount; ++i)
+      {
+        bucketCountsSnapshot[i] = bucketCounts[i].load(std::memory_order_relaxed);
+        snapshotSampleCount += bucketCountsSnapshot[i];
+      }
+
+      SSummary summary = {
+          .sampleCount = snapshotSampleCount, .max = maxLatency.load(std::memory_order_relaxed)};
+      if (0 == snapshotSampleCount) return summary;
+
+      const uint64_t p50Rank = ((snapshotSampleCount * 50) + 99) / 100;
+      const uint64_t p99Rank = ((snapshotSampleCount * 99) + 99) / 100;
+      uint64_t cumulativeSampleCount = 0;
+
+      for (unsigned int i = 0; i < kBucketCount; ++i)
+      {
+        const uint64_t previousCumulativeSampleCount = cumulativeSampleCount;
+        cumulativeSampleCount += bucketCountsSnapshot[i];
+
+        // Reported percentiles are the upper bounds of the buckets that hold them, which can only
+        // overestimate the true value, but they can never exceed the largest recorded value.
+        const uint32_t bucketUpperBound = std::min(BucketUpperBound(i), summary.max);
+
+        if ((previousCumulativeSampleCount < p50Rank) && (cumulativeSampleCount >= p50Rank))
+          summary.p50 = bucketUpperBound;
+
+        if ((previousCumulativeSampleCount < p99Rank) && (cumulativeSampleCount >= p99Rank))
+        {
+          summary.p99 = bucketUpperBound;
+          break;
+        }
+      }
+
+      return summary;
+    }
+
+    uint64_t Histogram::Record(uint32_t latency)
+    {
+      bucketCounts[BucketIndex(latency)].fetch_add(1, std::memory_order_relaxed);
+
+      uint32_t previousMaxLatency = maxLatency.load(std::memory_order_relaxed);
+      while (latency > previousMaxLatency)
+      {
+        if (true ==
+            maxLatency.compare_exchange_weak(
+                previousMaxLatency, latency, std::memory_order_relaxed))
+          break;
+      }
+
+      return (1 + sampleCount.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    void Histogram::Reset(void)
+    {
+      for (auto& bucketCount : bucketCounts)
+        bucketCount.store(0, std::memory_order_relaxed);
+
+      sampleCount.store(0, std::memory_order_relaxed);
+      maxLatency.store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t CaptureTimeNow(void)
+    {
+      LARGE_INTEGER performanceCounter = {};
+      QueryPerformanceCounter(&performanceCounter);
+
+      // A capture time of 0 means that none is present, so that value is avoided.
+      const uint32_t captureTime = static_cast<uint32_t>(performanceCounter.QuadPart);
+      return ((0 == captureTime) ? 1 : captureTime);
+    }
+
+    std::optional<uint32_t> ElapsedMicrosecondsSince(uint32_t captureTime)
+    {
+      const uint32_t elapsedTicks = (CaptureTimeNow() - captureTime);
+
+      // Producers and Xidi read the same system-wide counter, so a capture time that appears to be
+      // more than half of the counter range in the past is actually in the future. This happens if
+      // the producer supplies a capture time using some other clock.
+      if (elapsedTicks > (UINT32_MAX / 2)) return std::nullopt;
+
+      const uint64_t frequency = GetPerformanceCounterFrequency();
+      if (0 == frequency) return std::nullopt;
+
+      const uint64_t elapsedMicroseconds =
+          ((static_cast<uint64_t>(elapsedTicks) * 1000000) / frequency);
+      return static_cast<uint32_t>(
+          std::min(elapsedMicroseconds, static_cast<uint64_t>(UINT32_MAX)));
+    }
+
+    SSummary GetSummary(Controller::TControllerIdentifier controllerIdentifier)
+    {
+      if (controllerIdentifier >= Controller::kMaxControllerCount) return {};
+      return latencyHistograms[controllerIdentifier].GetSummary();
+    }
+
+    void RecordSample(Controller::TControllerIdentifier controllerIdentifier, uint32_t captureTime)
+    {
+      if (controllerIdentifier >= Controller::kMaxControllerCount) return;
+
+      const std::optional<uint32_t> latency = ElapsedMicrosecondsSince(captureTime);
+      if (false == latency.has_value()) return;
+
+      const uint64_t sampleCount = latencyHistograms[controllerIdentifier].Record(*latency);
+
+      if ((0 == (sampleCount % kSamplesPerLogMessage)) &&
+          (true == Message::WillOutputMessageOfSeverity(Message::ESeverity::Info)))
+      {
+        const SSummary summary = latencyHistograms[controllerIdentifier].GetSummary();
+        Message::OutputFormatted(
+            Message::ESeverity::Info,
+            L"Controller %u: Input latency over %llu samples is %u us median, %u us 99th percentile, %u us maximum.",
+            (unsigned int)(1 + controllerIdentifier),
+            (unsigned long long)summary.sampleCount,
+            summary.p50,
+            summary.p99,
+            summary.max);
+      }
+    }
+
+    void ResetSummary(Controller::TControllerIdentifier controllerIdentifier)
+    {
+      if (controllerIdentifier >= Controller::kMaxControllerCount) return;
+      latencyHistograms[controllerIdentifier].Reset();
+    }
+  } // namespace InputLatency
+
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IInputLatency.
+    class InputLatencyProvider : public IInputLatency
+    {
+    public:
+
+      // IInputLatency
+      InputLatency::SSummary GetSummary(unsigned int controllerIdentifier) const override
+      {
+        // Controller identifiers are narrower than the identifiers accepted through this API, so
+        // they are validated before being narrowed.
+        if (controllerIdentifier >= Controller::kMaxControllerCount) return {};
+        return InputLatency::GetSummary((Controller::TControllerIdentifier)controllerIdentifier);
+      }
+
+      void ResetSummary(unsigned int controllerIdentifier) override
+      {
+        if (controllerIdentifier >= Controller::kMaxControllerCount) return;
+        InputLatency::ResetSummary((Controller::TControllerIdentifier)controllerIdentifier);
+      }
+    };
+
+    /// Singleton Xidi API implementation object.
+    static InputLatencyProvider inputLatencyProvider;
+  } // namespace Api
+} // namespace Xidi
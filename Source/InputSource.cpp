@@ -0,0 +1,290 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file InputSource.cpp
+ *   Implementation of sources of controller input, which are driven by the physical controller
+ *   subsystem and which produce the state that every application-facing interface reads.
+ **************************************************************************************************/
+
+#include "InputSource.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "ImportApiWinMM.h"
+#include "ImportApiXInput.h"
+#include "InputInjection.h"
+#include "Message.h"
+#include "PhysicalController.h"
+#include "SharedMemoryInput.h"
+#include "SharedMemoryTypes.h"
+
+namespace Xidi
+{
+  namespace Controller
+  {
+    static_assert(1u << (unsigned int)EPhysicalButton::DpadUp == XINPUT_GAMEPAD_DPAD_UP);
+    static_assert(1u << (unsigned int)EPhysicalButton::DpadDown == XINPUT_GAMEPAD_DPAD_DOWN);
+    static_assert(1u << (unsigned int)EPhysicalButton::DpadLeft == XINPUT_GAMEPAD_DPAD_LEFT);
+    static_assert(1u << (unsigned int)EPhysicalButton::DpadRight == XINPUT_GAMEPAD_DPAD_RIGHT);
+    static_assert(1u << (unsigned int)EPhysicalButton::Start == XINPUT_GAMEPAD_START);
+    static_assert(1u << (unsigned int)EPhysicalButton::Back == XINPUT_GAMEPAD_BACK);
+    static_assert(1u << (unsigned int)EPhysicalButton::LS == XINPUT_GAMEPAD_LEFT_THUMB);
+    static_assert(1u << (unsigned int)EPhysicalButton::RS == XINPUT_GAMEPAD_RIGHT_THUMB);
+    static_assert(1u << (unsigned int)EPhysicalButton::LB == XINPUT_GAMEPAD_LEFT_SHOULDER);
+    static_assert(1u << (unsigned int)EPhysicalButton::RB == XINPUT_GAMEPAD_RIGHT_SHOULDER);
+    static_assert(1u << (unsigned int)EPhysicalButton::A == XINPUT_GAMEPAD_A);
+    static_assert(1u << (unsigned int)EPhysicalButton::B == XINPUT_GAMEPAD_B);
+    static_assert(1u << (unsigned int)EPhysicalButton::X == XINPUT_GAMEPAD_X);
+    static_assert(1u << (unsigned int)EPhysicalButton::Y == XINPUT_GAMEPAD_Y);
+
+    AdaptivePollingRate::AdaptivePollingRate(const SAdaptivePollingParameters& parameters)
+        : parameters(parameters),
+          currentPeriodMilliseconds(parameters.idlePeriodMilliseconds),
+          lastChangeTime(0),
+          activeStartTime(0),
+          active(false),
+          statistics()
+    {}
+
+    unsigned int AdaptivePollingRate::Update(bool inputChanged, uint32_t currentTime)
+    {
+      if ((true == inputChanged) && (false == active))
+      {
+        active = true;
+        activeStartTime = currentTime;
+        statistics = {};
+      }
+
+      if (true == active)
+      {
+        statistics.durationMilliseconds = currentTime - activeStartTime;
+        statistics.pollCount += 1;
+        if (true == inputChanged) statistics.changedPollCount += 1;
+      }
+
+      if (true == inputChanged)
+      {
+        lastChangeTime = currentTime;
+        currentPeriodMilliseconds = parameters.activePeriodMilliseconds;
+      }
+      else if ((currentTime - lastChangeTime) >= parameters.idleDelayMilliseconds)
+      {
+        // Decaying gradually, rather than switching straight to the idle period, means that input
+        // which resumes shortly after a pause is still noticed reasonably quickly.
+        active = false;
+        currentPeriodMilliseconds = std::min(
+            std::max(2 * currentPeriodMilliseconds, 1u), parameters.idlePeriodMilliseconds);
+      }
+
+      return currentPeriodMilliseconds;
+    }
+
+    SPhysicalState XInputSource::ReadPhysicalState(void) const
+    {
+      constexpr uint16_t kUnusedButtonMask =
+          ~((uint16_t)((1u << (unsigned int)EPhysicalButton::UnusedGuide) |
+                       (1u << (unsigned int)EPhysicalButton::UnusedShare)));
+
+      XINPUT_STATE xinputState;
+      DWORD xinputGetStateResult =
+          ImportApiXInput::XInputGetState(controllerIdentifier, &xinputState);
+
+      switch (xinputGetStateResult)
+      {
+        case ERROR_SUCCESS:
+          // Directly using wButtons assumes that the bit layout is the same between the internal
+          // bitset and the XInput data structure. The static assertions above this function verify
+          // this assumption and will cause a compiler error if it is wrong.
+          return {
+              .deviceStatus = EPhysicalDeviceStatus::Ok,
+              .stick =
+                  {xinputState.Gamepad.sThumbLX,
+                          xinputState.Gamepad.sThumbLY,
+                          xinputState.Gamepad.sThumbRX,
+                          xinputState.Gamepad.sThumbRY},
+              .trigger = {xinputState.Gamepad.bLeftTrigger, xinputState.Gamepad.bRightTrigger},
+              .button = (uint16_t)(xinputState.Gamepad.wButtons & kUnusedButtonMask)
+          };
+
+        case ERROR_DEVICE_NOT_CONNECTED:
+          return {.deviceStatus = EPhysicalDeviceStatus::NotConnected};
+
+        default:
+          return {.deviceStatus = EPhysicalDeviceStatus::Error};
+      }
+    }
+
+    unsigned int XInputSource::GetPollingPeriodMilliseconds(void) const
+    {
+      if (EPhysicalDeviceStatus::Ok != lastPhysicalState.deviceStatus)
+        return kPhysicalErrorBackoffPeriodMilliseconds;
+      else if (true == adaptivePollingEnabled)
+        return adaptivePollingRate.GetPeriodMilliseconds();
+      else
+        return kPhysicalPollingPeriodMilliseconds;
+    }
+
+    EInputSourceScheduling XInputSource::GetScheduling(void) const
+    {
+      return EInputSourceScheduling::Polled;
+    }
+
+    void XInputSource::ReadInput(IInputSink& sink)
+    {
+      const SPhysicalState physicalState = ReadPhysicalState();
+      const bool inputChanged = !(physicalState == lastPhysicalState);
+
+      lastPhysicalState = physicalState;
+      sink.PublishPhysicalState(controllerIdentifier, physicalState);
+
+      if (false == adaptivePollingEnabled) return;
+
+      const bool wasActive = adaptivePollingRate.IsActive();
+      adaptivePollingRate.Update(inputChanged, ImportApiWinMM::timeGetTime());
+
+      if ((true == wasActive) && (false == adaptivePollingRate.IsActive()))
+      {
+        const SAdaptivePollingStatistics statistics = adaptivePollingRate.GetStatistics();
+        Message::OutputFormatted(
+            Message::ESeverity::Debug,
+            L"Physical controller %u: Active polling ended after %u ms, during which %u polls took place (%u polls per second) and %u of them observed changed input.",
+            (unsigned int)(1 + controllerIdentifier),
+            statistics.durationMilliseconds,
+            statistics.pollCount,
+            (unsigned int)(((uint64_t)statistics.pollCount * 1000) /
+                           std::max<uint32_t>(statistics.durationMilliseconds, 1)),
+            statistics.changedPollCount);
+      }
+    }
+
+    ExternalInputSource::ExternalInputSource(void)
+        : IInputSource(),
+          injectedInput(),
+          sourceInput(),
+          mergedInput(),
+          lastKeyboardMouseInput(),
+          lastOverlay(),
+          wakeEventHandle(CreateEventW(nullptr, FALSE, FALSE, nullptr))
+    {}
+
+    ExternalInputSource::~ExternalInputSource(void)
+    {
+      if (nullptr != wakeEventHandle) CloseHandle(wakeEventHandle);
+    }
+
+    unsigned int ExternalInputSource::GetPollingPeriodMilliseconds(void) const
+    {
+      return kExternalInputPollingPeriodMilliseconds;
+    }
+
+    EInputSourceScheduling ExternalInputSource::GetScheduling(void) const
+    {
+      return EInputSourceScheduling::Signalled;
+    }
+
+    void ExternalInputSource::PublishMergedInput(
+        IInputSink& sink, uint32_t timestamp, uint32_t captureTime)
+    {
+      SharedMemory::MergeFrameInputs(
+          sourceInput, _countof(sourceInput), SharedMemory::GetMergePolicy(), mergedInput);
+
+      for (auto controllerIdentifier = 0; controllerIdentifier < GetControllerCount();
+           ++controllerIdentifier)
+        PublishControllerInput(
+            sink,
+            controllerIdentifier,
+            mergedInput.controller[controllerIdentifier],
+            timestamp,
+            captureTime);
+
+      PublishKeyboardMouseInput(mergedInput.keyboardMouse);
+
+      for (auto& input : sourceInput)
+      {
+        input.keyboardMouse.mouseMotionPresent.reset();
+        input.keyboardMouse.mouseMotion = {};
+      }
+    }
+
+    void ExternalInputSource::PublishControllerInput(
+        IInputSink& sink,
+        TControllerIdentifier controllerIdentifier,
+        const SStateOverlay& overlay,
+        uint32_t timestamp,
+        uint32_t captureTime)
+    {
+      if (overlay == lastOverlay[controllerIdentifier]) return;
+
+      sink.PublishExternalInput(controllerIdentifier, overlay, timestamp, captureTime);
+      lastOverlay[controllerIdentifier] = overlay;
+    }
+
+    void ExternalInputSource::PublishKeyboardMouseInput(
+        SharedMemory::SKeyboardMouseInput& keyboardMouseInput)
+    {
+      SharedMemory::SubmitMouseMotion(keyboardMouseInput);
+      if (keyboardMouseInput == lastKeyboardMouseInput) return;
+
+      SharedMemory::SubmitKeyboardMouseInput(keyboardMouseInput, lastKeyboardMouseInput);
+      lastKeyboardMouseInput = keyboardMouseInput;
+    }
+
+    void ExternalInputSource::ReadInput(IInputSink& sink)
+    {
+      SharedMemory::SFrameInput& sharedMemoryInput =
+          sourceInput[static_cast<int>(ESource::SharedMemory)];
+      SharedMemory::SFrameInput& injectionInput = sourceInput[static_cast<int>(ESource::Injection)];
+
+      // Producers that use a ring can write several frames between reads, and every one of them
+      // is passed on so that no transition is lost.
+      while (true == SharedMemory::ReadFrame(sharedMemoryInput))
+      {
+        PublishMergedInput(
+            sink,
+            ((0 != sharedMemoryInput.timestamp) ? sharedMemoryInput.timestamp
+                                                : ImportApiWinMM::timeGetTime()),
+            sharedMemoryInput.captureTime);
+      }
+
+      // Injected input only replaces the input previously injected for the controllers for which
+      // it is supplied.
+      while (true == InputInjection::ReadInjectedInput(injectedInput))
+      {
+        for (auto controllerIdentifier = 0; controllerIdentifier < GetControllerCount();
+             ++controllerIdentifier)
+        {
+          if (true == injectedInput.controllerPresent[controllerIdentifier])
+            injectionInput.controller[controllerIdentifier] =
+                injectedInput.controller[controllerIdentifier];
+        }
+
+        if (true == injectedInput.keyboardMousePresent)
+          injectionInput.keyboardMouse = injectedInput.keyboardMouse;
+
+        PublishMergedInput(sink, injectedInput.timestamp, injectedInput.captureTime);
+      }
+    }
+
+    void ExternalInputSource::WaitForInput(void)
+    {
+      // Producers that signal after each write cause new frames to be read immediately. Producers
+      // that do not signal, which is allowed because signalling is optional, are picked up when
+      // this source is next woken. A timeout is only needed if there is nothing to wake it.
+      SharedMemory::WaitForFrameSignal(
+          ((nullptr != wakeEventHandle) ? INFINITE : GetPollingPeriodMilliseconds()),
+          {InputInjection::GetSignalEvent(), wakeEventHandle});
+    }
+
+    void ExternalInputSource::WakeInput(void)
+    {
+      if (nullptr != wakeEventHandle) SetEvent(wakeEventHandle);
+    }
+  } // namespace Controller
+} // namespace Xidi
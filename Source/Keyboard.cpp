@@ -14,8 +14,6 @@
 
 #include <bitset>
 #include <mutex>
-#include <stop_token>
-#include <thread>
 #include <vector>
 
 #include "ApiBitSet.h"
@@ -23,6 +21,7 @@
 #include "ControllerTypes.h"
 #include "Globals.h"
 #include "Message.h"
+#include "Scheduler.h"
 
 namespace Xidi
 {
@@ -128,41 +127,58 @@ namespace Xidi
       std::mutex keyboardStateGuard;
     };
 
-    /// Manages a thread that continuously runs and updates the physical keyboard state from virtual
-    /// keyboard state. Wraps the thread handle to ensure safe termination and clean-up.
-    class KeyboardUpdateThread
+    /// Manages a scheduled task that periodically updates the physical keyboard state from virtual
+    /// keyboard state. Ensures that all pressed keys are released when updates stop.
+    class KeyboardUpdateTask
     {
     public:
 
-      inline KeyboardUpdateThread(StateContributionTracker& keyboardTracker)
-          : keyboardUpdateThread(), keyboardUpdateStop(), keyboardTracker(keyboardTracker)
-      {}
+      inline KeyboardUpdateTask(StateContributionTracker& keyboardTracker)
+          : keyboardUpdateGuard(),
+            keyboardUpdateTaskIdentifier(0),
+            keyboardUpdateExited(false),
+            keyboardEvents(),
+            previousKeyboardState(),
+            keyboardTracker(keyboardTracker)
+      {
+        keyboardEvents.reserve(kVirtualKeyboardKeyCount);
+      }
 
-      /// Safely exits the keyboard update thread if it is started.
-      ~KeyboardUpdateThread(void)
+      /// Safely stops the keyboard update task if it is started.
+      ~KeyboardUpdateTask(void)
       {
         Exit();
       }
 
-      /// Terminates the keyboard update thread.
+      /// Stops the keyboard update task and releases all keys that are still pressed.
       inline void Exit(void)
       {
-        if (true == keyboardUpdateThread.joinable())
-        {
-          keyboardUpdateStop.request_stop();
-          keyboardUpdateThread.join();
-        }
+        // If the process is exiting, the scheduler thread might already have been terminated,
+        // possibly while holding the lock in the middle of an update. Rather than waiting forever,
+        // the final update is skipped in that case.
+        std::unique_lock lock(keyboardUpdateGuard, std::try_to_lock);
+        if (false == lock.owns_lock()) return;
+
+        if ((0 == keyboardUpdateTaskIdentifier) || (true == keyboardUpdateExited)) return;
+
+        keyboardUpdateExited = true;
+        UpdatePhysicalKeyboardState(true);
       }
 
-      /// Starts running the keyboard update thread.
+      /// Starts running the keyboard update task.
       inline void Start(void)
       {
-        if ((false == keyboardUpdateThread.joinable()) &&
-            (false == keyboardUpdateStop.stop_requested()))
-        {
-          keyboardUpdateThread = std::thread(
-              UpdatePhysicalKeyboardState, &keyboardTracker, keyboardUpdateStop.get_token());
-        }
+        std::scoped_lock lock(keyboardUpdateGuard);
+
+        if ((0 != keyboardUpdateTaskIdentifier) || (true == keyboardUpdateExited)) return;
+
+        keyboardUpdateTaskIdentifier = Scheduler::AddTask(
+            kKeyboardUpdatePeriodMilliseconds,
+            [this]() -> unsigned int
+            {
+              RunScheduledUpdate();
+              return kKeyboardUpdatePeriodMilliseconds;
+            });
       }
 
     private:
@@ -196,97 +212,104 @@ namespace Xidi
           return key;
       }
 
-      /// Periodically checks for changes between the previous and next views of the virtual
-      /// keyboard key states. On detected state change, generates and submits a keyboard input
-      /// event to the system.
-      /// @param [in] keyboardTracker Pointer to the keyboard state contribution tracker object to
-      /// use for updates.
-      /// @param [in] keyboardUpdateStopToken Stop token used to indicate that this method should
-      /// terminate.
-      static void UpdatePhysicalKeyboardState(
-          StateContributionTracker* keyboardTracker, std::stop_token keyboardUpdateStopToken)
+      /// Performs one scheduled keyboard update, or removes the task if updates were stopped.
+      void RunScheduledUpdate(void)
       {
-        std::vector<INPUT> keyboardEvents;
-        keyboardEvents.reserve(kVirtualKeyboardKeyCount);
-
-        TState previousKeyboardState;
+        std::scoped_lock lock(keyboardUpdateGuard);
 
-        while (true)
+        if (true == keyboardUpdateExited)
         {
-          Sleep(kKeyboardUpdatePeriodMilliseconds);
+          Scheduler::RemoveTask(keyboardUpdateTaskIdentifier);
+          return;
+        }
+
+        UpdatePhysicalKeyboardState(false);
+      }
 
-          const bool haveInputFocus = Globals::DoesCurrentProcessHaveInputFocus();
-          const bool terminationRequested = keyboardUpdateStopToken.stop_requested();
+      /// Checks for changes between the previous and next views of the virtual keyboard key
+      /// states. On detected state change, generates and submits a keyboard input event to the
+      /// system. Must be invoked with the update lock held.
+      /// @param [in] terminationRequested Whether or not this is the final update, in which case
+      /// all pressed keys are released.
+      void UpdatePhysicalKeyboardState(bool terminationRequested)
+      {
+        const bool haveInputFocus = Globals::DoesCurrentProcessHaveInputFocus();
 
-          {
-            auto lock = keyboardTracker->Lock();
+        {
+          auto lock = keyboardTracker.Lock();
 
-            TState nextKeyboardState = keyboardTracker->SnapshotRelativeTo(previousKeyboardState);
+          TState nextKeyboardState = keyboardTracker.SnapshotRelativeTo(previousKeyboardState);
 
-            // If the current process does not have input focus or this thread is exiting then all
-            // pressed keys should be submitted to the system as released.
-            if ((false == haveInputFocus) || (true == terminationRequested))
-              nextKeyboardState.clear();
+          // If the current process does not have input focus or updates are stopping then all
+          // pressed keys should be submitted to the system as released.
+          if ((false == haveInputFocus) || (true == terminationRequested))
+            nextKeyboardState.clear();
 
-            const TState transitionedKeys = nextKeyboardState ^ previousKeyboardState;
+          const TState transitionedKeys = nextKeyboardState ^ previousKeyboardState;
 
-            for (auto transitionedKeyIter : transitionedKeys)
+          for (auto transitionedKeyIter : transitionedKeys)
+          {
+            const int transitionedKey = (int)transitionedKeyIter;
+
+            if (nextKeyboardState.contains(transitionedKey))
             {
-              const int transitionedKey = (int)transitionedKeyIter;
-
-              if (nextKeyboardState.contains(transitionedKey))
-              {
-                // Key with a transition is present in the next snapshot. This means it was pressed.
-                keyboardEvents.emplace_back(INPUT(
-                    {.type = INPUT_KEYBOARD,
-                     .ki = {
-                         .wScan = KeyboardEventScanCode(transitionedKey),
-                         .dwFlags = KeyboardEventFlags(transitionedKey)}}));
-              }
-              else
-              {
-                // Key with a transition is present in the next snapshot. This means it was
-                // released.
-                keyboardEvents.emplace_back(INPUT(
-                    {.type = INPUT_KEYBOARD,
-                     .ki = {
-                         .wScan = KeyboardEventScanCode(transitionedKey),
-                         .dwFlags = KEYEVENTF_KEYUP | KeyboardEventFlags(transitionedKey)}}));
-              }
+              // Key with a transition is present in the next snapshot. This means it was pressed.
+              keyboardEvents.emplace_back(INPUT(
+                  {.type = INPUT_KEYBOARD,
+                   .ki = {
+                       .wScan = KeyboardEventScanCode(transitionedKey),
+                       .dwFlags = KeyboardEventFlags(transitionedKey)}}));
+            }
+            else
+            {
+              // Key with a transition is present in the next snapshot. This means it was
+              // released.
+              keyboardEvents.emplace_back(INPUT(
+                  {.type = INPUT_KEYBOARD,
+                   .ki = {
+                       .wScan = KeyboardEventScanCode(transitionedKey),
+                       .dwFlags = KEYEVENTF_KEYUP | KeyboardEventFlags(transitionedKey)}}));
             }
-
-            previousKeyboardState = nextKeyboardState;
           }
 
-          if (keyboardEvents.size() > 0)
-          {
-            SendInput((UINT)keyboardEvents.size(), keyboardEvents.data(), (int)sizeof(INPUT));
-            keyboardEvents.clear();
-          }
+          previousKeyboardState = nextKeyboardState;
+        }
 
-          if (true == terminationRequested) break;
+        if (keyboardEvents.size() > 0)
+        {
+          SendInput((UINT)keyboardEvents.size(), keyboardEvents.data(), (int)sizeof(INPUT));
+          keyboardEvents.clear();
         }
       }
 
-      /// Handle for the update thread itself.
-      std::thread keyboardUpdateThread;
+      /// For ensuring that updates, including the final one, do not run concurrently.
+      std::mutex keyboardUpdateGuard;
+
+      /// Identifier of the scheduled update task, or 0 if it has not been started.
+      Scheduler::TTaskIdentifier keyboardUpdateTaskIdentifier;
+
+      /// Whether or not updates were stopped.
+      bool keyboardUpdateExited;
+
+      /// Keyboard events to be submitted to the system. Kept between updates to avoid allocations.
+      std::vector<INPUT> keyboardEvents;
 
-      /// Stop indicator to be used for exiting the keyboard update thread when needed.
-      std::stop_source keyboardUpdateStop;
+      /// Keyboard state as of the previous update.
+      TState previousKeyboardState;
 
       /// Keyboard contribution tracker object that should be used during the updates.
       StateContributionTracker& keyboardTracker;
     };
 
     /// Holds changes to keyboard state since the last snapshot.
-    /// Virtual keyboard state snapshots are maintained by the thread that periodically updates
+    /// Virtual keyboard state snapshots are maintained by the task that periodically updates
     /// physical keyboard state.
     static StateContributionTracker keyboardTracker;
 
-    /// Singleton object that wraps the keyboard update thread.
-    static KeyboardUpdateThread keyboardUpdateThread(keyboardTracker);
+    /// Singleton object that wraps the keyboard update task.
+    static KeyboardUpdateTask keyboardUpdateTask(keyboardTracker);
 
-    /// Initializes internal data structures, creates internal threads, and begins periodically
+    /// Initializes internal data structures, schedules internal tasks, and begins periodically
     /// checking for keyboard events that need to be submitted. Idempotent and concurrency-safe.
     static void InitializeAndBeginUpdating(void)
     {
@@ -295,10 +318,10 @@ namespace Xidi
           initFlag,
           []() -> void
           {
-            keyboardUpdateThread.Start();
+            keyboardUpdateTask.Start();
             Message::OutputFormatted(
                 Message::ESeverity::Info,
-                L"Initialized the keyboard event thread. Desired update period is %u ms.",
+                L"Scheduled keyboard event updates. Desired update period is %u ms.",
                 kKeyboardUpdatePeriodMilliseconds);
           });
     }
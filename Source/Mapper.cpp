@@ -438,7 +438,7 @@ namespace Xidi
 
     const Mapper* Mapper::GetConfigured(TControllerIdentifier controllerIdentifier)
     {
-      static const Mapper* configuredMapper[kPhysicalControllerCount];
+      static const Mapper* configuredMapper[kMaxControllerCount];
       static std::once_flag configuredMapperFlag;
 
       std::call_once(
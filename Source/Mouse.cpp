@@ -15,11 +15,10 @@
 #include <concurrent_unordered_map.h>
 
 #include <array>
+#include <atomic>
 #include <bitset>
 #include <cstdint>
 #include <mutex>
-#include <stop_token>
-#include <thread>
 #include <vector>
 
 #include "ApiBitSet.h"
@@ -27,6 +26,7 @@
 #include "ControllerTypes.h"
 #include "Globals.h"
 #include "Message.h"
+#include "Scheduler.h"
 #include "Strings.h"
 
 namespace Xidi
@@ -134,6 +134,15 @@ namespace Xidi
         notReleasedButtons.fill();
       }
 
+      /// Retrieves and resets the relative movement accumulated along the specified axis since the
+      /// last time it was retrieved.
+      /// @param [in] axis Mouse axis of interest.
+      /// @return Accumulated relative movement, in pixels or wheel units.
+      inline int DrainRelativeMovement(EMouseAxis axis)
+      {
+        return relativeMovement[(unsigned int)axis].exchange(0, std::memory_order_relaxed);
+      }
+
       /// Resets all movement contributions back to motionless.
       inline void ResetMovementContributions(void)
       {
@@ -157,6 +166,16 @@ namespace Xidi
         mouseMovementContributions[(unsigned int)axis][sourceIdentifier] = mouseMovementUnits;
       }
 
+      /// Submits relative mouse movement by adding it to the movement accumulated along the target
+      /// axis.
+      /// @param [in] axis Mouse axis that is affected.
+      /// @param [in] mouseMovementPixels Amount of movement, in pixels or wheel units.
+      inline void SubmitRelativeMovement(EMouseAxis axis, int mouseMovementPixels)
+      {
+        relativeMovement[(unsigned int)axis].fetch_add(
+            mouseMovementPixels, std::memory_order_relaxed);
+      }
+
     private:
 
       /// Set of buttons marked "pressed" since the last snapshot.
@@ -175,42 +194,64 @@ namespace Xidi
       /// per mouse axis.
       std::array<TMouseMovementContributions, (unsigned int)EMouseAxis::Count>
           mouseMovementContributions;
+
+      /// Relative mouse movement accumulated since it was last sent to the system, one element per
+      /// mouse axis.
+      std::array<std::atomic<int>, (unsigned int)EMouseAxis::Count> relativeMovement = {};
     };
 
-    /// Manages a thread that continuously runs and updates the physical mouse state from virtual
-    /// mouse state. Wraps the thread handle to ensure safe termination and clean-up.
-    class MouseUpdateThread
+    /// Manages a scheduled task that periodically updates the physical mouse state from virtual
+    /// mouse state. Ensures that all pressed buttons are released when updates stop.
+    class MouseUpdateTask
     {
     public:
 
-      inline MouseUpdateThread(StateContributionTracker& mouseTracker)
-          : mouseUpdateThread(), mouseUpdateStop(), mouseTracker(mouseTracker)
-      {}
+      inline MouseUpdateTask(StateContributionTracker& mouseTracker)
+          : mouseUpdateGuard(),
+            mouseUpdateTaskIdentifier(0),
+            mouseUpdateExited(false),
+            mouseEvents(),
+            previousMouseButtonState(),
+            mouseTracker(mouseTracker)
+      {
+        mouseEvents.reserve((unsigned int)EMouseAxis::Count + (unsigned int)EMouseButton::Count);
+      }
 
-      /// Safely exits the keyboard update thread if it is started.
-      ~MouseUpdateThread(void)
+      /// Safely stops the mouse update task if it is started.
+      ~MouseUpdateTask(void)
       {
         Exit();
       }
 
-      /// Terminates the mouse update thread.
+      /// Stops the mouse update task and releases all buttons that are still pressed.
       inline void Exit(void)
       {
-        if (true == mouseUpdateThread.joinable())
-        {
-          mouseUpdateStop.request_stop();
-          mouseUpdateThread.join();
-        }
+        // If the process is exiting, the scheduler thread might already have been terminated,
+        // possibly while holding the lock in the middle of an update. Rather than waiting forever,
+        // the final update is skipped in that case.
+        std::unique_lock lock(mouseUpdateGuard, std::try_to_lock);
+        if (false == lock.owns_lock()) return;
+
+        if ((0 == mouseUpdateTaskIdentifier) || (true == mouseUpdateExited)) return;
+
+        mouseUpdateExited = true;
+        UpdatePhysicalMouseState(true);
       }
 
-      /// Starts running the mouse update thread.
+      /// Starts running the mouse update task.
       inline void Start(void)
       {
-        if ((false == mouseUpdateThread.joinable()) && (false == mouseUpdateStop.stop_requested()))
-        {
-          mouseUpdateThread =
-              std::thread(UpdatePhysicalMouseState, &mouseTracker, mouseUpdateStop.get_token());
-        }
+        std::scoped_lock lock(mouseUpdateGuard);
+
+        if ((0 != mouseUpdateTaskIdentifier) || (true == mouseUpdateExited)) return;
+
+        mouseUpdateTaskIdentifier = Scheduler::AddTask(
+            kMouseUpdatePeriodMilliseconds,
+            [this]() -> unsigned int
+            {
+              RunScheduledUpdate();
+              return kMouseUpdatePeriodMilliseconds;
+            });
       }
 
     private:
@@ -318,120 +359,135 @@ namespace Xidi
             conversionScalingFactor);
       }
 
-      /// Periodically checks for changes between the previous and next views of the virtual mouse
-      /// button states. On detected state change, generates and submits a mouse input event to the
-      /// system.
-      /// @param [in] mouseTracker Pointer to the mouse state contribution tracker object to use for
-      /// updates.
-      /// @param [in] mouseUpdateStopToken Stop token used to indicate that this method should
-      /// terminate.
-      static void UpdatePhysicalMouseState(
-          StateContributionTracker* mouseTracker, std::stop_token mouseUpdateStopToken)
+      /// Performs one scheduled mouse update, or removes the task if updates were stopped.
+      void RunScheduledUpdate(void)
       {
-        std::vector<INPUT> mouseEvents;
-        mouseEvents.reserve((unsigned int)EMouseAxis::Count + (unsigned int)EMouseButton::Count);
-
-        TButtonState previousMouseButtonState;
+        std::scoped_lock lock(mouseUpdateGuard);
 
-        while (true)
+        if (true == mouseUpdateExited)
         {
-          Sleep(kMouseUpdatePeriodMilliseconds);
-
-          const bool haveInputFocus = Globals::DoesCurrentProcessHaveInputFocus();
-          const bool terminationRequested = mouseUpdateStopToken.stop_requested();
+          Scheduler::RemoveTask(mouseUpdateTaskIdentifier);
+          return;
+        }
 
-          // Mouse buttons
-          {
-            auto lock = mouseTracker->LockButtonState();
+        UpdatePhysicalMouseState(false);
+      }
 
-            TButtonState nextMouseButtonState =
-                mouseTracker->ButtonSnapshotRelativeTo(previousMouseButtonState);
+      /// Checks for changes between the previous and next views of the virtual mouse button
+      /// states and for mouse movement. On detected state change, generates and submits a mouse
+      /// input event to the system. Must be invoked with the update lock held.
+      /// @param [in] terminationRequested Whether or not this is the final update, in which case
+      /// all pressed buttons are released and no movement is submitted.
+      void UpdatePhysicalMouseState(bool terminationRequested)
+      {
+        const bool haveInputFocus = Globals::DoesCurrentProcessHaveInputFocus();
 
-            // If the current process does not have input focus or this thread is exiting then all
-            // pressed keys should be submitted to the system as released.
-            if ((false == haveInputFocus) || (true == terminationRequested))
-              nextMouseButtonState.clear();
+        // Mouse buttons
+        {
+          auto lock = mouseTracker.LockButtonState();
 
-            const TButtonState transitionedButtons =
-                nextMouseButtonState ^ previousMouseButtonState;
+          TButtonState nextMouseButtonState =
+              mouseTracker.ButtonSnapshotRelativeTo(previousMouseButtonState);
 
-            for (auto transitionedButtonsIter : transitionedButtons)
-            {
-              const EMouseButton transitionedButton =
-                  (EMouseButton)((unsigned int)transitionedButtonsIter);
-              const bool transitionIsFromUnpressedToPressed =
-                  (nextMouseButtonState.contains((unsigned int)transitionedButton));
+          // If the current process does not have input focus or updates are stopping then all
+          // pressed keys should be submitted to the system as released.
+          if ((false == haveInputFocus) || (true == terminationRequested))
+            nextMouseButtonState.clear();
 
-              mouseEvents.emplace_back(INPUT(
-                  {.type = INPUT_MOUSE,
-                   .mi = MouseInputEventForButtonTransition(
-                       (EMouseButton)transitionedButton, transitionIsFromUnpressedToPressed)}));
-            }
+          const TButtonState transitionedButtons =
+              nextMouseButtonState ^ previousMouseButtonState;
 
-            previousMouseButtonState = nextMouseButtonState;
+          for (auto transitionedButtonsIter : transitionedButtons)
+          {
+            const EMouseButton transitionedButton =
+                (EMouseButton)((unsigned int)transitionedButtonsIter);
+            const bool transitionIsFromUnpressedToPressed =
+                (nextMouseButtonState.contains((unsigned int)transitionedButton));
+
+            mouseEvents.emplace_back(INPUT(
+                {.type = INPUT_MOUSE,
+                 .mi = MouseInputEventForButtonTransition(
+                     (EMouseButton)transitionedButton, transitionIsFromUnpressedToPressed)}));
           }
 
-          // Mouse movement
-          if ((true == haveInputFocus) && (false == terminationRequested))
+          previousMouseButtonState = nextMouseButtonState;
+        }
+
+        // Relative mouse movement is drained even if it is not sent to the system, so that it
+        // does not build up while the current process does not have input focus.
+        std::array<int, (unsigned int)EMouseAxis::Count> relativeMovementPixels;
+        for (size_t axisIndex = 0; axisIndex < relativeMovementPixels.size(); ++axisIndex)
+          relativeMovementPixels[axisIndex] =
+              mouseTracker.DrainRelativeMovement((EMouseAxis)axisIndex);
+
+        // Mouse movement
+        if ((true == haveInputFocus) && (false == terminationRequested))
+        {
+          const std::array<TMouseMovementContributions, (unsigned int)EMouseAxis::Count>&
+              mouseMovementContributions = mouseTracker.MovementContributions();
+
+          for (size_t axisIndex = 0; axisIndex < mouseMovementContributions.size(); ++axisIndex)
           {
-            const std::array<TMouseMovementContributions, (unsigned int)EMouseAxis::Count>&
-                mouseMovementContributions = mouseTracker->MovementContributions();
+            const TMouseMovementContributions& axisMovementContributions =
+                mouseMovementContributions[axisIndex];
+            int axisMovementUnits = 0;
+            int axisMovementPixels = relativeMovementPixels[axisIndex];
 
-            for (size_t axisIndex = 0; axisIndex < mouseMovementContributions.size(); ++axisIndex)
+            for (const auto& contribution : axisMovementContributions)
+              axisMovementUnits += contribution.second;
+
+            if (kMouseMovementUnitsNeutral != axisMovementUnits)
             {
-              const TMouseMovementContributions& axisMovementContributions =
-                  mouseMovementContributions[axisIndex];
-              int axisMovementUnits = 0;
-
-              for (const auto& contribution : axisMovementContributions)
-                axisMovementUnits += contribution.second;
-
-              if (kMouseMovementUnitsNeutral != axisMovementUnits)
-              {
-                if (axisMovementUnits > kMouseMovementUnitsMax)
-                  axisMovementUnits = kMouseMovementUnitsMax;
-                else if (axisMovementUnits < kMouseMovementUnitsMin)
-                  axisMovementUnits = kMouseMovementUnitsMin;
-
-                const int axisMovementPixels = MouseMovementUnitsToPixels(axisMovementUnits);
-                if (0 != axisMovementPixels)
-                  mouseEvents.emplace_back(INPUT(
-                      {.type = INPUT_MOUSE,
-                       .mi =
-                           MouseInputEventForMovement((EMouseAxis)axisIndex, axisMovementPixels)}));
-              }
+              if (axisMovementUnits > kMouseMovementUnitsMax)
+                axisMovementUnits = kMouseMovementUnitsMax;
+              else if (axisMovementUnits < kMouseMovementUnitsMin)
+                axisMovementUnits = kMouseMovementUnitsMin;
+
+              axisMovementPixels += MouseMovementUnitsToPixels(axisMovementUnits);
             }
-          };
 
-          if (mouseEvents.size() > 0)
-          {
-            SendInput((UINT)mouseEvents.size(), mouseEvents.data(), (int)sizeof(INPUT));
-            mouseEvents.clear();
+            if (0 != axisMovementPixels)
+              mouseEvents.emplace_back(INPUT(
+                  {.type = INPUT_MOUSE,
+                   .mi = MouseInputEventForMovement((EMouseAxis)axisIndex, axisMovementPixels)}));
           }
+        };
 
-          if (true == terminationRequested) break;
+        if (mouseEvents.size() > 0)
+        {
+          SendInput((UINT)mouseEvents.size(), mouseEvents.data(), (int)sizeof(INPUT));
+          mouseEvents.clear();
         }
       }
 
-      /// Handle for the update thread itself.
-      std::thread mouseUpdateThread;
+      /// For ensuring that updates, including the final one, do not run concurrently.
+      std::mutex mouseUpdateGuard;
+
+      /// Identifier of the scheduled update task, or 0 if it has not been started.
+      Scheduler::TTaskIdentifier mouseUpdateTaskIdentifier;
 
-      /// Stop indicator to be used for exiting the keyboard update thread when needed.
-      std::stop_source mouseUpdateStop;
+      /// Whether or not updates were stopped.
+      bool mouseUpdateExited;
+
+      /// Mouse events to be submitted to the system. Kept between updates to avoid allocations.
+      std::vector<INPUT> mouseEvents;
+
+      /// Mouse button state as of the previous update.
+      TButtonState previousMouseButtonState;
 
       /// Mouse state contribution tracker object that should be used during the updates.
       StateContributionTracker& mouseTracker;
     };
 
     /// Holds changes to mouse state since the last snapshot.
-    /// Virtual mouse state snapshots are maintained by the thread that periodically updates
+    /// Virtual mouse state snapshots are maintained by the task that periodically updates
     /// physical mouse state.
     static StateContributionTracker mouseTracker;
 
-    /// Singleton object that wraps the mouse update thread.
-    static MouseUpdateThread mouseUpdateThread(mouseTracker);
+    /// Singleton object that wraps the mouse update task.
+    static MouseUpdateTask mouseUpdateTask(mouseTracker);
 
-    /// Initializes internal data structures, creates internal threads, and begins periodically
+    /// Initializes internal data structures, schedules internal tasks, and begins periodically
     /// checking for mouse events that need to be submitted. Idempotent and concurrency-safe.
     static void InitializeAndBeginUpdating(void)
     {
@@ -440,10 +496,10 @@ namespace Xidi
           initFlag,
           []() -> void
           {
-            mouseUpdateThread.Start();
+            mouseUpdateTask.Start();
             Message::OutputFormatted(
                 Message::ESeverity::Info,
-                L"Initialized the mouse event thread. Desired update period is %u ms.",
+                L"Scheduled mouse event updates. Desired update period is %u ms.",
                 kMouseUpdatePeriodMilliseconds);
           });
     }
@@ -475,5 +531,11 @@ namespace Xidi
       InitializeAndBeginUpdating();
       mouseTracker.SubmitMouseMovement(axis, mouseMovementUnits, sourceIdentifier);
     }
+
+    void SubmitMouseRelativeMovement(EMouseAxis axis, int mouseMovementPixels)
+    {
+      InitializeAndBeginUpdating();
+      mouseTracker.SubmitRelativeMovement(axis, mouseMovementPixels);
+    }
   } // namespace Mouse
 } // namespace Xidi
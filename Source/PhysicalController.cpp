@@ -11,47 +11,147 @@
 
 #include "PhysicalController.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <mutex>
+#include <new>
 #include <set>
 #include <stop_token>
 #include <thread>
+#include <type_traits>
+#include <vector>
 
 #include "ApiWindows.h"
+#include "ConcurrencyHistory.h"
 #include "ConcurrencyWrapper.h"
 #include "ControllerTypes.h"
 #include "ForceFeedbackDevice.h"
 #include "Globals.h"
-#include "ImportApiWinMM.h"
 #include "ImportApiXInput.h"
+#include "InputLatency.h"
+#include "InputSource.h"
 #include "Mapper.h"
 #include "Message.h"
+#include "PollTiming.h"
+#include "Scheduler.h"
+#include "SharedMemoryOutput.h"
+#include "Strings.h"
 #include "VirtualController.h"
 
 namespace Xidi
 {
   namespace Controller
   {
-    /// Raw physical state data for each of the possible physical controllers.
-    static ConcurrencyWrapper<SPhysicalState> physicalControllerState[kPhysicalControllerCount];
+    // Controller state is read far more often than it is written, so it must be trivially copyable
+    // in order to be wrapped by the lock-free version of the concurrency wrapper.
+    static_assert(std::is_trivially_copyable_v<SPhysicalState>);
+    static_assert(std::is_trivially_copyable_v<SState>);
+
+    /// Type for holding the virtual controllers to which state changes are dispatched.
+    using TDispatchList = std::vector<VirtualController*>;
+
+    /// All of the data associated with a single controller. Each controller's data begins on its
+    /// own cache line so that threads that update different controllers do not contend for the
+    /// same cache lines.
+    struct alignas(std::hardware_destructive_interference_size) SControllerData
+    {
+      /// Raw physical state data.
+      ConcurrencyWrapper<SPhysicalState> physicalState;
+
+      /// State data after it is passed through a mapper but without any further processing.
+      ConcurrencyWrapper<SState> rawVirtualState;
+
+      /// Recent changes to the input supplied by external producers via shared memory, to be
+      /// applied on top of processed virtual controller state.
+      ConcurrencyHistory<SExternalInput, kExternalInputHistoryCapacity> externalInputHistory;
+
+      /// Input source that polls the physical hardware, or `nullptr` if the controller is not
+      /// backed by physical hardware.
+      XInputSource* xinputSource = nullptr;
+
+      /// Pointers to the virtual controller objects registered as consumers of input.
+      std::set<VirtualController*> inputRegistration;
+
+      /// Hardware status reported by the most recent update of the physical state. Used to log
+      /// status changes. Protected by the input mutex.
+      EPhysicalDeviceStatus deviceStatus = EPhysicalDeviceStatus::NotConnected;
+
+      /// Identifier of the scheduled polling task, or 0 if the controller is not being polled.
+      Scheduler::TTaskIdentifier pollingTaskIdentifier = 0;
+
+      /// High-resolution time at which the current poll started. Protected by the input mutex.
+      uint32_t pollStartTime = 0;
+
+      /// High-resolution time at which the previous poll started, or 0 if there is no previous
+      /// poll against which to measure the interval. Protected by the input mutex.
+      uint32_t previousPollStartTime = 0;
+
+      /// Mutex object for protecting against concurrent accesses to the input registration data
+      /// and for ensuring that the physical hardware is not polled concurrently.
+      std::mutex inputMutex;
+
+      /// Copy of the input registration data that the state change dispatcher thread reads without
+      /// locking, or `nullptr` if no virtual controllers are registered. Replaced whenever the
+      /// input registration data change, and each replaced copy is freed only once the dispatcher
+      /// thread is known to have stopped using it.
+      std::atomic<const TDispatchList*> dispatchList = nullptr;
+
+      /// Number of times the state change dispatcher thread was asked to resynchronize, which it
+      /// does by dispatching the current state to every registered virtual controller.
+      std::atomic<uint64_t> dispatchResyncRequestCount = 0;
+
+      /// Number of resynchronization requests the state change dispatcher thread has completed.
+      /// Accessed only by the dispatcher thread.
+      uint64_t dispatchResyncCompleteCount = 0;
+
+      /// Whether or not the state change dispatcher thread is keeping the dispatched state up to
+      /// date, which it only does while virtual controllers are registered. Accessed only by the
+      /// dispatcher thread.
+      bool dispatchedStateTracked = false;
 
-    /// State data for each of the possible physical controllers after it is passed through a mapper
-    /// but without any further processing.
-    static ConcurrencyWrapper<SState> rawVirtualControllerState[kPhysicalControllerCount];
+      /// Sequence number of the most recent externally-supplied input that was dispatched. Accessed
+      /// only by the dispatcher thread.
+      uint64_t dispatchedExternalInputSequence = 0;
 
-    /// Per-controller force feedback device buffer objects.
-    /// These objects are not safe for dynamic initialization, so they are initialized later by
-    /// pointer.
-    static ForceFeedback::Device* physicalControllerForceFeedbackBuffer;
+      /// Most recent externally-supplied input that was dispatched. Accessed only by the dispatcher
+      /// thread.
+      SExternalInput dispatchedExternalInput = {};
 
-    /// Pointers to the virtual controller objects registered for force feedback with each physical
-    /// controller.
-    static std::set<const VirtualController*>
-        physicalControllerForceFeedbackRegistration[kPhysicalControllerCount];
+      /// Most recent raw virtual state that was dispatched. Accessed only by the dispatcher thread.
+      SState dispatchedRawVirtualState = {};
 
-    /// Mutex objects for protecting against concurrent accesses to the physical controller force
-    /// feedback registration data.
-    static std::mutex physicalControllerForceFeedbackMutex[kPhysicalControllerCount];
+      /// Force feedback device buffer object.
+      ForceFeedback::Device forceFeedbackBuffer;
+
+      /// Pointers to the virtual controller objects registered for force feedback.
+      std::set<const VirtualController*> forceFeedbackRegistration;
+
+      /// Mutex object for protecting against concurrent accesses to the force feedback
+      /// registration data.
+      std::mutex forceFeedbackMutex;
+
+      /// Identifier of the scheduled force feedback actuation task, or 0 if effects are not being
+      /// actuated. Protected by the force feedback mutex.
+      Scheduler::TTaskIdentifier forceFeedbackTaskIdentifier = 0;
+
+      /// Physical actuator values most recently written by the force feedback actuation task.
+      ForceFeedback::SPhysicalActuatorComponents previousPhysicalActuatorValues = {};
+
+    };
+
+    /// Per-controller data, one element per controller, allocated contiguously during
+    /// initialization once the number of controllers is known. These objects are not safe for
+    /// dynamic initialization, so they are initialized later by pointer.
+    static SControllerData* controllerData;
+
+    /// Incremented whenever the state change dispatcher thread has something to do. A single
+    /// dispatcher thread serves all controllers, and it waits for this value to change.
+    static std::atomic<uint32_t> dispatchSignal = 0;
+
+    /// Incremented by the state change dispatcher thread at the start and at the end of each pass
+    /// over all controllers, so it is odd while a pass is in progress and even otherwise.
+    static std::atomic<uint64_t> dispatchPassCount = 0;
 
     /// Computes an opaque source identifier from a given controller identifier.
     /// @param [in] controllerIdentifier Identifier of the physical controller for which an
@@ -63,59 +163,6 @@ namespace Xidi
       return (uint32_t)controllerIdentifier;
     }
 
-    /// Reads physical controller state.
-    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
-    /// @return Physical state of the identified controller.
-    static SPhysicalState ReadPhysicalControllerState(TControllerIdentifier controllerIdentifier)
-    {
-      constexpr uint16_t kUnusedButtonMask =
-          ~((uint16_t)((1u << (unsigned int)EPhysicalButton::UnusedGuide) |
-                       (1u << (unsigned int)EPhysicalButton::UnusedShare)));
-
-      XINPUT_STATE xinputState;
-      DWORD xinputGetStateResult =
-          ImportApiXInput::XInputGetState(controllerIdentifier, &xinputState);
-
-      switch (xinputGetStateResult)
-      {
-        case ERROR_SUCCESS:
-          // Directly using wButtons assumes that the bit layout is the same between the internal
-          // bitset and the XInput data structure. The static assertions below this function verify
-          // this assumption and will cause a compiler error if it is wrong.
-          return {
-              .deviceStatus = EPhysicalDeviceStatus::Ok,
-              .stick =
-                  {xinputState.Gamepad.sThumbLX,
-                          xinputState.Gamepad.sThumbLY,
-                          xinputState.Gamepad.sThumbRX,
-                          xinputState.Gamepad.sThumbRY},
-              .trigger = {xinputState.Gamepad.bLeftTrigger, xinputState.Gamepad.bRightTrigger},
-              .button = (uint16_t)(xinputState.Gamepad.wButtons & kUnusedButtonMask)
-          };
-
-        case ERROR_DEVICE_NOT_CONNECTED:
-          return {.deviceStatus = EPhysicalDeviceStatus::NotConnected};
-
-        default:
-          return {.deviceStatus = EPhysicalDeviceStatus::Error};
-      }
-    }
-
-    static_assert(1u << (unsigned int)EPhysicalButton::DpadUp == XINPUT_GAMEPAD_DPAD_UP);
-    static_assert(1u << (unsigned int)EPhysicalButton::DpadDown == XINPUT_GAMEPAD_DPAD_DOWN);
-    static_assert(1u << (unsigned int)EPhysicalButton::DpadLeft == XINPUT_GAMEPAD_DPAD_LEFT);
-    static_assert(1u << (unsigned int)EPhysicalButton::DpadRight == XINPUT_GAMEPAD_DPAD_RIGHT);
-    static_assert(1u << (unsigned int)EPhysicalButton::Start == XINPUT_GAMEPAD_START);
-    static_assert(1u << (unsigned int)EPhysicalButton::Back == XINPUT_GAMEPAD_BACK);
-    static_assert(1u << (unsigned int)EPhysicalButton::LS == XINPUT_GAMEPAD_LEFT_THUMB);
-    static_assert(1u << (unsigned int)EPhysicalButton::RS == XINPUT_GAMEPAD_RIGHT_THUMB);
-    static_assert(1u << (unsigned int)EPhysicalButton::LB == XINPUT_GAMEPAD_LEFT_SHOULDER);
-    static_assert(1u << (unsigned int)EPhysicalButton::RB == XINPUT_GAMEPAD_RIGHT_SHOULDER);
-    static_assert(1u << (unsigned int)EPhysicalButton::A == XINPUT_GAMEPAD_A);
-    static_assert(1u << (unsigned int)EPhysicalButton::B == XINPUT_GAMEPAD_B);
-    static_assert(1u << (unsigned int)EPhysicalButton::X == XINPUT_GAMEPAD_X);
-    static_assert(1u << (unsigned int)EPhysicalButton::Y == XINPUT_GAMEPAD_Y);
-
     /// Writes a vibration command to a physical controller.
     /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
     /// @param [in] vibration Physical actuator vibration vector.
@@ -133,175 +180,527 @@ namespace Xidi
           ImportApiXInput::XInputSetState((DWORD)controllerIdentifier, &xinputVibration));
     }
 
-    /// Periodically plays force feedback effects on the physical controller actuators.
+    /// Writes physical actuator values to a controller, unless they are unchanged from the values
+    /// most recently written. Changed values are also published to external consumers via shared
+    /// memory, so controllers that are not backed by XInput hardware are actuated as well.
     /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
-    static void ForceFeedbackActuateEffects(TControllerIdentifier controllerIdentifier)
+    /// @param [in] physicalActuatorValues Physical actuator values to write.
+    /// @return `true` if successful or if the values are unchanged, `false` otherwise.
+    static bool WritePhysicalActuatorValues(
+        TControllerIdentifier controllerIdentifier,
+        ForceFeedback::SPhysicalActuatorComponents physicalActuatorValues)
     {
-      constexpr ForceFeedback::TOrderedMagnitudeComponents kVirtualMagnitudeVectorZero = {};
+      SControllerData& data = controllerData[controllerIdentifier];
+      if (data.previousPhysicalActuatorValues == physicalActuatorValues) return true;
 
-      ForceFeedback::SPhysicalActuatorComponents previousPhysicalActuatorValues;
-      ForceFeedback::SPhysicalActuatorComponents currentPhysicalActuatorValues;
+      SharedMemory::PublishForceFeedbackOutput(controllerIdentifier, physicalActuatorValues);
+      data.previousPhysicalActuatorValues = physicalActuatorValues;
 
-      const Mapper* mapper = Mapper::GetConfigured(controllerIdentifier);
-      bool lastActuationResult = true;
+      if (controllerIdentifier >= kPhysicalControllerCount) return true;
+      return WritePhysicalControllerVibration(controllerIdentifier, physicalActuatorValues);
+    }
 
-      while (true)
-      {
-        if (true == lastActuationResult)
-          Sleep(kPhysicalForceFeedbackPeriodMilliseconds);
-        else
-          Sleep(kPhysicalErrorBackoffPeriodMilliseconds);
+    /// Plays force feedback effects on the physical controller actuators once. Intended to be
+    /// invoked periodically by the scheduler, once per controller for which at least one virtual
+    /// controller is registered for force feedback. Once none are registered, stops the physical
+    /// actuators and removes itself from the scheduler.
+    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
+    /// @return Number of milliseconds until the next invocation.
+    static unsigned int ForceFeedbackActuateEffects(TControllerIdentifier controllerIdentifier)
+    {
+      constexpr ForceFeedback::TOrderedMagnitudeComponents kVirtualMagnitudeVectorZero = {};
 
-        if (true == Globals::DoesCurrentProcessHaveInputFocus())
-        {
-          ForceFeedback::TEffectValue overallEffectGain = 10000;
-          ForceFeedback::SPhysicalActuatorComponents physicalActuatorVector = {};
-          ForceFeedback::TOrderedMagnitudeComponents virtualMagnitudeVector =
-              physicalControllerForceFeedbackBuffer[controllerIdentifier].PlayEffects();
+      SControllerData& data = controllerData[controllerIdentifier];
+      ForceFeedback::SPhysicalActuatorComponents currentPhysicalActuatorValues = {};
 
-          if (kVirtualMagnitudeVectorZero != virtualMagnitudeVector)
-          {
-            std::unique_lock lock(physicalControllerForceFeedbackMutex[controllerIdentifier]);
-
-            // Gain is modified downwards by each virtual controller object.
-            // Typically there would only be one, in which case the properties of that object would
-            // be effective. Otherwise this loop is essentially modeled as multiple volume knobs
-            // connected in sequence, each lowering the volume of the effects by the value of its
-            // own device-wide gain property.
-            for (auto virtualController :
-                 physicalControllerForceFeedbackRegistration[controllerIdentifier])
-              overallEffectGain *=
-                  ((ForceFeedback::TEffectValue)virtualController->GetForceFeedbackGain() /
-                   ForceFeedback::kEffectModifierMaximum);
-
-            physicalActuatorVector = mapper->MapForceFeedbackVirtualToPhysical(
-                virtualMagnitudeVector, overallEffectGain);
-          }
-
-          currentPhysicalActuatorValues = physicalActuatorVector;
-        }
-        else
-        {
-          currentPhysicalActuatorValues = {};
-        }
+      {
+        std::unique_lock lock(data.forceFeedbackMutex);
 
-        if (previousPhysicalActuatorValues != currentPhysicalActuatorValues)
+        if (true == data.forceFeedbackRegistration.empty())
         {
-          lastActuationResult =
-              WritePhysicalControllerVibration(controllerIdentifier, currentPhysicalActuatorValues);
-          previousPhysicalActuatorValues = currentPhysicalActuatorValues;
+          // The next registration schedules a new task. Since all tasks run on the same thread,
+          // that task cannot run until this invocation is complete.
+          Scheduler::RemoveTask(data.forceFeedbackTaskIdentifier);
+          data.forceFeedbackTaskIdentifier = 0;
+          lock.unlock();
+
+          WritePhysicalActuatorValues(controllerIdentifier, {});
+          Message::OutputFormatted(
+              Message::ESeverity::Info,
+              L"Physical controller %u: Stopped force feedback actuation.",
+              (unsigned int)(1 + controllerIdentifier));
+          return kPhysicalForceFeedbackPeriodMilliseconds;
         }
-        else
+      }
+
+      if (true == Globals::DoesCurrentProcessHaveInputFocus())
+      {
+        ForceFeedback::TEffectValue overallEffectGain = 10000;
+        ForceFeedback::TOrderedMagnitudeComponents virtualMagnitudeVector =
+            data.forceFeedbackBuffer.PlayEffects();
+
+        if (kVirtualMagnitudeVectorZero != virtualMagnitudeVector)
         {
-          lastActuationResult = true;
+          std::unique_lock lock(data.forceFeedbackMutex);
+
+          // Gain is modified downwards by each virtual controller object.
+          // Typically there would only be one, in which case the properties of that object would
+          // be effective. Otherwise this loop is essentially modeled as multiple volume knobs
+          // connected in sequence, each lowering the volume of the effects by the value of its
+          // own device-wide gain property.
+          for (auto virtualController : data.forceFeedbackRegistration)
+            overallEffectGain *=
+                ((ForceFeedback::TEffectValue)virtualController->GetForceFeedbackGain() /
+                 ForceFeedback::kEffectModifierMaximum);
+
+          currentPhysicalActuatorValues =
+              Mapper::GetConfigured(controllerIdentifier)
+                  ->MapForceFeedbackVirtualToPhysical(virtualMagnitudeVector, overallEffectGain);
         }
       }
+
+      if (true == WritePhysicalActuatorValues(controllerIdentifier, currentPhysicalActuatorValues))
+        return kPhysicalForceFeedbackPeriodMilliseconds;
+      else
+        return kPhysicalErrorBackoffPeriodMilliseconds;
+    }
+
+    /// Wakes up the state change dispatcher thread to dispatch changes for a controller. Nothing is
+    /// done if no virtual controllers are registered for the controller's input, so that changes
+    /// nobody consumes do not cost any wakeups.
+    /// @param [in] data Data of the controller whose changes are to be dispatched.
+    static inline void SignalDispatcher(SControllerData& data)
+    {
+      if (nullptr == data.dispatchList.load()) return;
+
+      dispatchSignal.fetch_add(1);
+      dispatchSignal.notify_one();
+    }
+
+    /// Outputs to the log a change in the hardware status of a physical controller, such as a
+    /// hardware connection or disconnection or an error condition.
+    /// @param [in] controllerIdentifier Identifier of the controller whose status changed.
+    /// @param [in] oldStatus Hardware status before the change.
+    /// @param [in] newStatus Hardware status after the change.
+    static void LogPhysicalControllerStatusChange(
+        TControllerIdentifier controllerIdentifier,
+        EPhysicalDeviceStatus oldStatus,
+        EPhysicalDeviceStatus newStatus)
+    {
+      switch (newStatus)
+      {
+        case EPhysicalDeviceStatus::Ok:
+          if (EPhysicalDeviceStatus::NotConnected == oldStatus)
+            Message::OutputFormatted(
+                Message::ESeverity::Info,
+                L"Physical controller %u: Hardware connected.",
+                (unsigned int)(1 + controllerIdentifier));
+          else
+            Message::OutputFormatted(
+                Message::ESeverity::Warning,
+                L"Physical controller %u: Cleared previous error condition.",
+                (unsigned int)(1 + controllerIdentifier));
+          break;
+
+        case EPhysicalDeviceStatus::NotConnected:
+          Message::OutputFormatted(
+              Message::ESeverity::Info,
+              L"Physical controller %u: Hardware disconnected.",
+              (unsigned int)(1 + controllerIdentifier));
+          break;
+
+        default:
+          Message::OutputFormatted(
+              Message::ESeverity::Warning,
+              L"Physical controller %u: Encountered an error condition.",
+              (unsigned int)(1 + controllerIdentifier));
+          break;
+      }
     }
 
-    /// Periodically polls for physical controller state.
-    /// On detected state change, updates the internal data structure and notifies all waiting
+    /// Input sink that stores input in the per-controller data structures and notifies all waiting
     /// threads.
-    /// @param [in] controllerIdentifier Identifier of the controller on which to operate.
-    static void PollForPhysicalControllerStateChanges(TControllerIdentifier controllerIdentifier)
+    class ControllerDataInputSink : public IInputSink
     {
-      SPhysicalState newPhysicalState = physicalControllerState[controllerIdentifier].Get();
+    public:
 
-      while (true)
+      // IInputSink
+      void PublishPhysicalState(
+          TControllerIdentifier controllerIdentifier, const SPhysicalState& physicalState) override
       {
-        if (EPhysicalDeviceStatus::Ok == newPhysicalState.deviceStatus)
-          Sleep(kPhysicalPollingPeriodMilliseconds);
-        else
-          Sleep(kPhysicalErrorBackoffPeriodMilliseconds);
+        SControllerData& data = controllerData[controllerIdentifier];
+        PollTiming::RecordReadDuration(
+            controllerIdentifier,
+            InputLatency::ElapsedMicrosecondsSince(data.pollStartTime).value_or(0));
 
-        newPhysicalState = ReadPhysicalControllerState(controllerIdentifier);
+        if (false == data.physicalState.Update(physicalState)) return;
 
-        if (true == physicalControllerState[controllerIdentifier].Update(newPhysicalState))
+        if (physicalState.deviceStatus != data.deviceStatus)
         {
-          const SState newRawVirtualState =
-              ((EPhysicalDeviceStatus::Ok == newPhysicalState.deviceStatus)
-                   ? Mapper::GetConfigured(controllerIdentifier)
-                         ->MapStatePhysicalToVirtual(
-                             newPhysicalState,
-                             OpaqueControllerSourceIdentifier(controllerIdentifier))
-                   : Mapper::GetConfigured(controllerIdentifier)
-                         ->MapNeutralPhysicalToVirtual(
-                             OpaqueControllerSourceIdentifier(controllerIdentifier)));
-
-          rawVirtualControllerState[controllerIdentifier].Update(newRawVirtualState);
+          LogPhysicalControllerStatusChange(
+              controllerIdentifier, data.deviceStatus, physicalState.deviceStatus);
+          data.deviceStatus = physicalState.deviceStatus;
         }
+
+        const uint32_t mapStartTime = InputLatency::CaptureTimeNow();
+        const SState newRawVirtualState =
+            ((EPhysicalDeviceStatus::Ok == physicalState.deviceStatus)
+                 ? Mapper::GetConfigured(controllerIdentifier)
+                       ->MapStatePhysicalToVirtual(
+                           physicalState, OpaqueControllerSourceIdentifier(controllerIdentifier))
+                 : Mapper::GetConfigured(controllerIdentifier)
+                       ->MapNeutralPhysicalToVirtual(
+                           OpaqueControllerSourceIdentifier(controllerIdentifier)));
+
+        const bool rawVirtualStateChanged = data.rawVirtualState.Update(newRawVirtualState);
+        if (true == rawVirtualStateChanged) SignalDispatcher(data);
+
+        // Each successful update of a concurrency wrapper notifies its waiting threads once. The
+        // physical state was updated successfully to get this far.
+        const unsigned int notificationCount = 1 + ((true == rawVirtualStateChanged) ? 1 : 0);
+
+        PollTiming::RecordChangedPoll(
+            controllerIdentifier,
+            InputLatency::ElapsedMicrosecondsSince(mapStartTime).value_or(0),
+            notificationCount);
+      }
+
+      void PublishExternalInput(
+          TControllerIdentifier controllerIdentifier,
+          const SStateOverlay& overlay,
+          uint32_t timestamp,
+          uint32_t captureTime) override
+      {
+        controllerData[controllerIdentifier].externalInputHistory.Append(
+            {.overlay = overlay, .timestamp = timestamp, .captureTime = captureTime});
+        SignalDispatcher(controllerData[controllerIdentifier]);
+      }
+    };
+
+    /// Sink that receives the input produced by all input sources.
+    static ControllerDataInputSink controllerDataInputSink;
+
+    /// Starts reading an input source in whatever way its scheduling type requires. Polled input
+    /// sources are read by a scheduler task. Signalled input sources are read by a thread of their
+    /// own each time they are signalled, and a scheduler task wakes them at their polling period in
+    /// case input arrives without a signal.
+    /// @param [in] inputSource Input source to start reading. Must remain valid for as long as it
+    /// is being read, which for signalled input sources is forever, since their threads never exit.
+    /// @param [in] readFunction Reads the input source and returns the number of milliseconds until
+    /// it should next be read. The return value is only used for polled input sources.
+    /// @return Identifier of the scheduler task that reads or wakes the input source.
+    static Scheduler::TTaskIdentifier StartInputSource(
+        IInputSource* inputSource, Scheduler::TTaskFunction readFunction)
+    {
+      switch (inputSource->GetScheduling())
+      {
+        case EInputSourceScheduling::Polled:
+          return Scheduler::AddTask(
+              inputSource->GetPollingPeriodMilliseconds(), std::move(readFunction));
+
+        case EInputSourceScheduling::Signalled:
+          std::thread(
+              [inputSource, readFunction = std::move(readFunction)]() -> void
+              {
+                while (true)
+                {
+                  inputSource->WaitForInput();
+                  readFunction();
+                }
+              })
+              .detach();
+          return Scheduler::AddTask(
+              inputSource->GetPollingPeriodMilliseconds(),
+              [inputSource]() -> unsigned int
+              {
+                inputSource->WakeInput();
+                return inputSource->GetPollingPeriodMilliseconds();
+              });
+
+        default:
+          Message::OutputFormatted(
+              Message::ESeverity::Error,
+              L"Internal error: Input source has unrecognized scheduling type %u.",
+              (unsigned int)inputSource->GetScheduling());
+          return 0;
       }
     }
 
-    /// Monitors physical controller status for events like hardware connection or disconnection and
-    /// error conditions. Used exclusively for logging. Intended to be a thread entry point, one
-    /// thread per monitored physical controller.
-    /// @param [in] controllerIdentifier Identifier of the controller to monitor.
-    static void MonitorPhysicalControllerStatus(TControllerIdentifier controllerIdentifier)
+    /// Dispatches changes in a controller's raw virtual state, and in the input that external
+    /// producers supply for it, to every virtual controller registered as a consumer of its input.
+    /// Virtual controllers observe every change to externally-supplied input, in order, but only
+    /// the most recent raw virtual state. Must be invoked only on the state change dispatcher
+    /// thread.
+    /// @param [in] data Data of the controller whose changes are dispatched.
+    static void DispatchControllerStateChanges(SControllerData& data)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      // The dispatcher thread reads the copy of the registration data after it reads the number
+      // of resynchronization requests, so a copy published before a request is seen together
+      // with that request.
+      const uint64_t resyncRequestCount = data.dispatchResyncRequestCount.load();
+      const TDispatchList* const dispatchList = data.dispatchList.load();
+
+      if (nullptr == dispatchList)
       {
-        Message::OutputFormatted(
-            Message::ESeverity::Error,
-            L"Attempted to monitor physical controller with invalid identifier %u.",
-            controllerIdentifier);
+        data.dispatchedStateTracked = false;
         return;
       }
 
-      SPhysicalState oldPhysicalState = GetCurrentPhysicalControllerState(controllerIdentifier);
-      SPhysicalState newPhysicalState = oldPhysicalState;
+      // Changes are not tracked while nobody consumes them, so the first virtual controllers to
+      // register start from the most recent state.
+      if (false == data.dispatchedStateTracked)
+      {
+        data.dispatchedExternalInput =
+            data.externalInputHistory.GetLatest(data.dispatchedExternalInputSequence);
+        data.dispatchedRawVirtualState = data.rawVirtualState.Get();
+        data.dispatchedStateTracked = true;
+      }
 
-      while (true)
+      // Newly-registered virtual controllers are first brought up to date with the state that
+      // every other registered virtual controller already has, so that from then on all of them
+      // observe the same changes in the same order.
+      if (resyncRequestCount != data.dispatchResyncCompleteCount)
       {
-        WaitForPhysicalControllerStateChange(
-            controllerIdentifier, newPhysicalState, std::stop_token());
+        for (VirtualController* virtualController : *dispatchList)
+        {
+          if (true == virtualController->RefreshState(data.dispatchedExternalInput.overlay))
+            virtualController->SignalStateChangeEvent();
+          if (true == virtualController->RefreshState(data.dispatchedRawVirtualState))
+            virtualController->SignalStateChangeEvent();
+        }
 
-        // Look for status changes and output to the log, as appropriate.
-        switch (newPhysicalState.deviceStatus)
+        data.dispatchResyncCompleteCount = resyncRequestCount;
+      }
+
+      while (true ==
+             data.externalInputHistory.GetNext(
+                 data.dispatchedExternalInputSequence, data.dispatchedExternalInput))
+      {
+        for (VirtualController* virtualController : *dispatchList)
         {
-          case EPhysicalDeviceStatus::Ok:
-            switch (oldPhysicalState.deviceStatus)
-            {
-              case EPhysicalDeviceStatus::Ok:
-                break;
-
-              case EPhysicalDeviceStatus::NotConnected:
-                Message::OutputFormatted(
-                    Message::ESeverity::Info,
-                    L"Physical controller %u: Hardware connected.",
-                    (1 + controllerIdentifier));
-                break;
-
-              default:
-                Message::OutputFormatted(
-                    Message::ESeverity::Warning,
-                    L"Physical controller %u: Cleared previous error condition.",
-                    (1 + controllerIdentifier));
-                break;
-            }
-            break;
+          if (true ==
+              virtualController->RefreshState(
+                  data.dispatchedExternalInput.overlay,
+                  data.dispatchedExternalInput.timestamp,
+                  data.dispatchedExternalInput.captureTime))
+            virtualController->SignalStateChangeEvent();
+        }
+      }
 
-          case EPhysicalDeviceStatus::NotConnected:
-            if (newPhysicalState.deviceStatus != oldPhysicalState.deviceStatus)
-              Message::OutputFormatted(
-                  Message::ESeverity::Info,
-                  L"Physical controller %u: Hardware disconnected.",
-                  (1 + controllerIdentifier));
-            break;
+      const SState newRawVirtualState = data.rawVirtualState.Get();
+      if (newRawVirtualState != data.dispatchedRawVirtualState)
+      {
+        data.dispatchedRawVirtualState = newRawVirtualState;
 
-          default:
-            if (newPhysicalState.deviceStatus != oldPhysicalState.deviceStatus)
-              Message::OutputFormatted(
-                  Message::ESeverity::Warning,
-                  L"Physical controller %u: Encountered an error condition.",
-                  (1 + controllerIdentifier));
-            break;
+        for (VirtualController* virtualController : *dispatchList)
+        {
+          if (true == virtualController->RefreshState(data.dispatchedRawVirtualState))
+            virtualController->SignalStateChangeEvent();
         }
+      }
+    }
+
+    /// Repeatedly dispatches state changes for all controllers and then waits to be signalled.
+    /// Intended to be a thread entry point. A single thread serves all controllers, and it stays
+    /// blocked without any wakeups while no virtual controllers are registered. Never returns.
+    static void DispatchStateChanges(void)
+    {
+      while (true)
+      {
+        const uint32_t currentDispatchSignal = dispatchSignal.load();
+        dispatchPassCount.fetch_add(1);
+
+        for (auto controllerIdentifier = 0; controllerIdentifier < GetControllerCount();
+             ++controllerIdentifier)
+          DispatchControllerStateChanges(controllerData[controllerIdentifier]);
+
+        dispatchPassCount.fetch_add(1);
+        dispatchPassCount.notify_all();
+
+        dispatchSignal.wait(currentDispatchSignal);
+      }
+    }
+
+    /// Starts the state change dispatcher thread the first time it is needed.
+    /// @return Handle that becomes signalled if the dispatcher thread terminates, or `nullptr` if
+    /// no such handle could be obtained.
+    static HANDLE StartDispatcher(void)
+    {
+      static const HANDLE dispatcherThreadHandle = []() -> HANDLE
+      {
+        std::thread dispatcherThread(DispatchStateChanges);
+
+        HANDLE threadHandle = nullptr;
+        if (FALSE ==
+            DuplicateHandle(
+                Globals::GetCurrentProcessHandle(),
+                dispatcherThread.native_handle(),
+                Globals::GetCurrentProcessHandle(),
+                &threadHandle,
+                SYNCHRONIZE,
+                FALSE,
+                0))
+          threadHandle = nullptr;
+
+        dispatcherThread.detach();
+        Message::Output(
+            Message::ESeverity::Info, L"Initialized the state change dispatcher thread.");
+
+        return threadHandle;
+      }();
+
+      return dispatcherThreadHandle;
+    }
+
+    /// Waits for the state change dispatcher thread to complete enough passes that any virtual
+    /// controller registered before this function was invoked is up to date and any replaced copy
+    /// of the input registration data is no longer in use. Must not be invoked with any input
+    /// mutex held, so that the dispatcher thread never holds up polling.
+    /// @param [in] waitForFullPass Whether or not the wait must include a complete pass that
+    /// starts after this function is invoked. If not, the wait only covers the pass that is in
+    /// progress, if any.
+    /// @return `true` if the wait completed, `false` if it was abandoned because the dispatcher
+    /// thread is no longer running.
+    static bool WaitForDispatcher(bool waitForFullPass)
+    {
+      uint64_t passCount = dispatchPassCount.load();
+      const uint64_t targetPassCount =
+          passCount + (passCount & 1) + ((true == waitForFullPass) ? 2 : 0);
 
-        oldPhysicalState = newPhysicalState;
+      const HANDLE dispatcherThreadHandle = StartDispatcher();
+
+      while (passCount < targetPassCount)
+      {
+        // If the process is exiting, the dispatcher thread might already have been terminated,
+        // possibly in the middle of a pass. Rather than waiting forever, the wait is abandoned in
+        // that case.
+        if ((nullptr != dispatcherThreadHandle) &&
+            (WAIT_OBJECT_0 == WaitForSingleObject(dispatcherThreadHandle, 0)))
+          return false;
+
+        dispatchPassCount.wait(passCount);
+        passCount = dispatchPassCount.load();
       }
+
+      return true;
+    }
+
+    /// Replaces the copy of the input registration data that the state change dispatcher thread
+    /// reads. Must be invoked with the input mutex held, so that copies are published in the same
+    /// order as the changes to the registration data they reflect.
+    /// @param [in] data Data of the controller whose registration changed.
+    /// @return Replaced copy, which the caller must free once the dispatcher thread is known to
+    /// have stopped using it.
+    static const TDispatchList* PublishDispatchList(SControllerData& data)
+    {
+      return data.dispatchList.exchange(
+          (true == data.inputRegistration.empty())
+              ? nullptr
+              : new TDispatchList(data.inputRegistration.cbegin(), data.inputRegistration.cend()));
+    }
+
+    /// Polls a physical controller once, passing its state on to the controller data structures.
+    /// Intended to be invoked periodically by the scheduler, once per physical controller for which
+    /// at least one virtual controller is registered as a consumer of input.
+    /// @param [in] controllerIdentifier Identifier of the controller to poll.
+    /// @return Number of milliseconds until the next invocation.
+    static unsigned int PollPhysicalController(TControllerIdentifier controllerIdentifier)
+    {
+      SControllerData& data = controllerData[controllerIdentifier];
+      std::scoped_lock lock(data.inputMutex);
+
+      data.pollStartTime = InputLatency::CaptureTimeNow();
+      if (0 != data.previousPollStartTime)
+        PollTiming::RecordPollInterval(
+            controllerIdentifier,
+            InputLatency::ElapsedMicrosecondsSince(data.previousPollStartTime).value_or(0));
+      data.previousPollStartTime = data.pollStartTime;
+
+      data.xinputSource->ReadInput(controllerDataInputSink);
+      return data.xinputSource->GetPollingPeriodMilliseconds();
+    }
+
+    /// Reads the parameters that govern adaptive polling of physical controllers from the
+    /// configuration file.
+    /// @return Adaptive polling parameters, with defaults for any that are not configured.
+    static SAdaptivePollingParameters ReadAdaptivePollingParameters(void)
+    {
+      const auto& configurationData = Globals::GetConfigurationData();
+
+      return {
+          .enabled = configurationData
+                         .GetFirstBooleanValue(
+                             Strings::kStrConfigurationSectionProperties,
+                             Strings::kStrConfigurationSettingPropertiesAdaptivePolling)
+                         .value_or(false),
+          .activePeriodMilliseconds =
+              (unsigned int)configurationData
+                  .GetFirstIntegerValue(
+                      Strings::kStrConfigurationSectionProperties,
+                      Strings::kStrConfigurationSettingPropertiesActivePollingPeriodMilliseconds)
+                  .value_or(kAdaptivePollingDefaultActivePeriodMilliseconds),
+          .idlePeriodMilliseconds =
+              (unsigned int)configurationData
+                  .GetFirstIntegerValue(
+                      Strings::kStrConfigurationSectionProperties,
+                      Strings::kStrConfigurationSettingPropertiesIdlePollingPeriodMilliseconds)
+                  .value_or(kAdaptivePollingDefaultIdlePeriodMilliseconds),
+          .idleDelayMilliseconds =
+              (unsigned int)configurationData
+                  .GetFirstIntegerValue(
+                      Strings::kStrConfigurationSectionProperties,
+                      Strings::kStrConfigurationSettingPropertiesIdlePollingDelayMilliseconds)
+                  .value_or(kAdaptivePollingDefaultIdleDelayMilliseconds)};
+    }
+
+    /// Starts ingesting input supplied externally the first time a virtual controller registers
+    /// for input, so that processes that never use a controller do not pay for it. Idempotent and
+    /// concurrency-safe.
+    static void StartExternalInputIngest(void)
+    {
+      static std::once_flag startFlag;
+      std::call_once(
+          startFlag,
+          []() -> void
+          {
+            // A single input source covers all input supplied externally, for all controllers.
+            IInputSource* const externalInputSource = new ExternalInputSource();
+            StartInputSource(
+                externalInputSource,
+                [externalInputSource]() -> unsigned int
+                {
+                  externalInputSource->ReadInput(controllerDataInputSink);
+                  return externalInputSource->GetPollingPeriodMilliseconds();
+                });
+            Message::OutputFormatted(
+                Message::ESeverity::Info,
+                L"Initialized the external input ingest thread. Desired polling period is %u ms.",
+                kExternalInputPollingPeriodMilliseconds);
+          });
+    }
+
+    /// Publishes the initial idle force feedback state of every controller the first time a
+    /// virtual controller registers for force feedback, which creates the force feedback output
+    /// mapping. Every controller needs this, because external consumers can actuate controllers
+    /// that are not backed by physical hardware, and afterwards output is only published when it
+    /// changes. Idempotent and concurrency-safe.
+    static void StartForceFeedbackOutput(void)
+    {
+      static std::once_flag startFlag;
+      std::call_once(
+          startFlag,
+          []() -> void
+          {
+            for (auto controllerIdentifier = 0; controllerIdentifier < GetControllerCount();
+                 ++controllerIdentifier)
+              SharedMemory::PublishForceFeedbackOutput(
+                  controllerIdentifier,
+                  controllerData[controllerIdentifier].previousPhysicalActuatorValues);
+          });
     }
 
-    /// Initializes internal data structures and creates worker threads.
+    /// Initializes internal data structures. Polling, external input ingest, and force feedback
+    /// actuation and output are started later, on demand.
     /// Idempotent and concurrency-safe.
     static void Initialize(void)
     {
@@ -310,89 +709,74 @@ namespace Xidi
           initFlag,
           []() -> void
           {
-            // Initialize controller state data structures.
-            for (auto controllerIdentifier = 0;
-                 controllerIdentifier < _countof(physicalControllerState);
+            // Only the first few controllers are backed by physical hardware. Any others receive
+            // input exclusively from external producers, so they are never polled and always
+            // appear to be disconnected.
+            const TControllerIdentifier physicalControllerCount =
+                std::min(GetControllerCount(), kPhysicalControllerCount);
+            const SAdaptivePollingParameters adaptivePollingParameters =
+                ReadAdaptivePollingParameters();
+
+            // Allocate and initialize controller data structures. Each physical controller is
+            // polled by an input source of its own, but only while it has registered consumers.
+            controllerData = new SControllerData[GetControllerCount()];
+            for (auto controllerIdentifier = 0; controllerIdentifier < GetControllerCount();
                  ++controllerIdentifier)
             {
+              if (controllerIdentifier < physicalControllerCount)
+                controllerData[controllerIdentifier].xinputSource =
+                    new XInputSource(controllerIdentifier, adaptivePollingParameters);
+
               const SPhysicalState initialPhysicalState =
-                  ReadPhysicalControllerState(controllerIdentifier);
+                  ((nullptr != controllerData[controllerIdentifier].xinputSource)
+                       ? controllerData[controllerIdentifier].xinputSource->ReadPhysicalState()
+                       : SPhysicalState{.deviceStatus = EPhysicalDeviceStatus::NotConnected});
               const SState initialRawVirtualState =
                   Mapper::GetConfigured(controllerIdentifier)
                       ->MapStatePhysicalToVirtual(
                           initialPhysicalState,
                           OpaqueControllerSourceIdentifier(controllerIdentifier));
 
-              physicalControllerState[controllerIdentifier].Set(initialPhysicalState);
-              rawVirtualControllerState[controllerIdentifier].Set(initialRawVirtualState);
+              controllerData[controllerIdentifier].physicalState.Set(initialPhysicalState);
+              controllerData[controllerIdentifier].deviceStatus = initialPhysicalState.deviceStatus;
+              controllerData[controllerIdentifier].rawVirtualState.Set(initialRawVirtualState);
             }
 
-            // Ensure the system timer resolution is suitable for the desired polling frequency.
-            TIMECAPS timeCaps;
-            MMRESULT timeResult = ImportApiWinMM::timeGetDevCaps(&timeCaps, sizeof(timeCaps));
-            if (MMSYSERR_NOERROR == timeResult)
-            {
-              timeResult = ImportApiWinMM::timeBeginPeriod(timeCaps.wPeriodMin);
-
-              if (MMSYSERR_NOERROR == timeResult)
-                Message::OutputFormatted(
-                    Message::ESeverity::Info,
-                    L"Set the system timer resolution to %u ms.",
-                    timeCaps.wPeriodMin);
-              else
-                Message::OutputFormatted(
-                    Message::ESeverity::Warning,
-                    L"Failed with code %u to set the system timer resolution.",
-                    timeResult);
-            }
-            else
-            {
+            if (true == adaptivePollingParameters.enabled)
               Message::OutputFormatted(
-                  Message::ESeverity::Warning,
-                  L"Failed with code %u to obtain system timer resolution information.",
-                  timeResult);
-            }
-
-            // Create and start the polling threads.
-            for (auto controllerIdentifier = 0; controllerIdentifier < kPhysicalControllerCount;
-                 ++controllerIdentifier)
-            {
-              std::thread(PollForPhysicalControllerStateChanges, controllerIdentifier).detach();
+                  Message::ESeverity::Info,
+                  L"Physical controllers are polled adaptively while in use. Desired polling period is %u ms while input is changing, decaying to %u ms after %u ms without changes.",
+                  adaptivePollingParameters.activePeriodMilliseconds,
+                  adaptivePollingParameters.idlePeriodMilliseconds,
+                  adaptivePollingParameters.idleDelayMilliseconds);
+            else
               Message::OutputFormatted(
                   Message::ESeverity::Info,
-                  L"Initialized the physical controller state polling thread for controller %u. Desired polling period is %u ms.",
-                  (unsigned int)(1 + controllerIdentifier),
+                  L"Physical controllers are polled while in use. Desired polling period is %u ms.",
                   kPhysicalPollingPeriodMilliseconds);
-            }
 
-            // Allocate the force feedback device buffers, then create and start the force feedback
-            // threads.
-            physicalControllerForceFeedbackBuffer =
-                new ForceFeedback::Device[kPhysicalControllerCount];
-            for (auto controllerIdentifier = 0; controllerIdentifier < kPhysicalControllerCount;
-                 ++controllerIdentifier)
+            // Periodically log poll timing summaries, but only if requested and if the messages
+            // will actually be delivered as output.
+            const unsigned int pollTimingIntervalMilliseconds = 1000 *
+                (unsigned int)Globals::GetConfigurationData()
+                    .GetFirstIntegerValue(
+                        Strings::kStrConfigurationSectionLog,
+                        Strings::kStrConfigurationSettingLogPollTimingIntervalSeconds)
+                    .value_or(0);
+            if ((0 != pollTimingIntervalMilliseconds) &&
+                (true == Message::WillOutputMessageOfSeverity(Message::ESeverity::Info)))
             {
-              std::thread(ForceFeedbackActuateEffects, controllerIdentifier).detach();
+              Scheduler::AddTask(
+                  pollTimingIntervalMilliseconds,
+                  [pollTimingIntervalMilliseconds]() -> unsigned int
+                  {
+                    PollTiming::OutputSummaries();
+                    return pollTimingIntervalMilliseconds;
+                  });
               Message::OutputFormatted(
                   Message::ESeverity::Info,
-                  L"Initialized the physical controller force feedback actuation thread for controller %u. Desired actuation period is %u ms.",
-                  (unsigned int)(1 + controllerIdentifier),
-                  kPhysicalForceFeedbackPeriodMilliseconds);
-            }
-
-            // Create and start the physical controller hardware status monitoring threads, but only
-            // if the messages generated by those threads will actually be delivered as output.
-            if (Message::WillOutputMessageOfSeverity(Message::ESeverity::Warning))
-            {
-              for (auto controllerIdentifier = 0; controllerIdentifier < kPhysicalControllerCount;
-                   ++controllerIdentifier)
-              {
-                std::thread(MonitorPhysicalControllerStatus, controllerIdentifier).detach();
-                Message::OutputFormatted(
-                    Message::ESeverity::Info,
-                    L"Initialized the physical controller hardware status monitoring thread for controller %u.",
-                    (unsigned int)(1 + controllerIdentifier));
-              }
+                  L"Physical controller poll timing summaries will be logged every %u seconds.",
+                  pollTimingIntervalMilliseconds / 1000);
             }
           });
     }
@@ -403,16 +787,130 @@ namespace Xidi
       return Mapper::GetConfigured(controllerIdentifier)->GetCapabilities();
     }
 
+    TControllerIdentifier GetControllerCount(void)
+    {
+      static const TControllerIdentifier controllerCount = []() -> TControllerIdentifier
+      {
+        const int64_t configuredControllerCount =
+            Globals::GetConfigurationData()
+                .GetFirstIntegerValue(
+                    Strings::kStrConfigurationSectionProperties,
+                    Strings::kStrConfigurationSettingPropertiesControllerCount)
+                .value_or(kDefaultControllerCount);
+
+        return (TControllerIdentifier)std::clamp(
+            configuredControllerCount, (int64_t)1, (int64_t)kMaxControllerCount);
+      }();
+
+      return controllerCount;
+    }
+
+    SStateOverlay GetCurrentExternalInputOverlay(
+        TControllerIdentifier controllerIdentifier, uint64_t& sequence)
+    {
+      Initialize();
+      return controllerData[controllerIdentifier].externalInputHistory.GetLatest(sequence).overlay;
+    }
+
     SPhysicalState GetCurrentPhysicalControllerState(TControllerIdentifier controllerIdentifier)
     {
       Initialize();
-      return physicalControllerState[controllerIdentifier].Get();
+      return controllerData[controllerIdentifier].physicalState.Get();
     }
 
     SState GetCurrentRawVirtualControllerState(TControllerIdentifier controllerIdentifier)
     {
       Initialize();
-      return rawVirtualControllerState[controllerIdentifier].Get();
+      return controllerData[controllerIdentifier].rawVirtualState.Get();
+    }
+
+    void PhysicalControllerInputRegister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController)
+    {
+      Initialize();
+
+      if (controllerIdentifier >= GetControllerCount())
+      {
+        Message::OutputFormatted(
+            Message::ESeverity::Error,
+            L"Attempted to register with a physical controller for input with invalid identifier %u.",
+            controllerIdentifier);
+        return;
+      }
+
+      StartExternalInputIngest();
+
+      SControllerData& data = controllerData[controllerIdentifier];
+      std::unique_lock lock(data.inputMutex);
+
+      if (false == data.inputRegistration.insert(virtualController).second) return;
+
+      if ((nullptr != data.xinputSource) && (0 == data.pollingTaskIdentifier))
+      {
+        // The physical state might be arbitrarily out of date if the controller was not being
+        // polled, so it is refreshed before the registering virtual controller receives it. The
+        // time until the first scheduled poll is not a poll interval, so it is not measured.
+        data.pollStartTime = InputLatency::CaptureTimeNow();
+        data.previousPollStartTime = 0;
+        data.xinputSource->ReadInput(controllerDataInputSink);
+        data.pollingTaskIdentifier = StartInputSource(
+            data.xinputSource,
+            [controllerIdentifier]() -> unsigned int
+            {
+              return PollPhysicalController(controllerIdentifier);
+            });
+
+        Message::OutputFormatted(
+            Message::ESeverity::Info,
+            L"Physical controller %u: Started polling.",
+            (unsigned int)(1 + controllerIdentifier));
+      }
+
+      const TDispatchList* const oldDispatchList = PublishDispatchList(data);
+      data.dispatchResyncRequestCount.fetch_add(1);
+      lock.unlock();
+
+      // The registering virtual controller receives its initial state from the dispatcher thread.
+      SignalDispatcher(data);
+      if (true == WaitForDispatcher(true)) delete oldDispatchList;
+    }
+
+    void PhysicalControllerInputUnregister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController)
+    {
+      Initialize();
+
+      if (controllerIdentifier >= GetControllerCount())
+      {
+        Message::OutputFormatted(
+            Message::ESeverity::Error,
+            L"Attempted to unregister with a physical controller for input with invalid identifier %u.",
+            controllerIdentifier);
+        return;
+      }
+
+      SControllerData& data = controllerData[controllerIdentifier];
+      std::unique_lock lock(data.inputMutex);
+
+      if (0 == data.inputRegistration.erase(virtualController)) return;
+
+      const TDispatchList* const oldDispatchList = PublishDispatchList(data);
+      if ((true == data.inputRegistration.empty()) && (0 != data.pollingTaskIdentifier))
+      {
+        Scheduler::RemoveTask(data.pollingTaskIdentifier);
+        data.pollingTaskIdentifier = 0;
+
+        Message::OutputFormatted(
+            Message::ESeverity::Info,
+            L"Physical controller %u: Stopped polling.",
+            (unsigned int)(1 + controllerIdentifier));
+      }
+      lock.unlock();
+
+      // The unregistering virtual controller might still be in use by a pass that is in progress,
+      // but any later pass uses the new copy of the registration data. If the wait is abandoned
+      // the old copy is leaked, since the dispatcher thread might have been using it.
+      if (true == WaitForDispatcher(false)) delete oldDispatchList;
     }
 
     ForceFeedback::Device* PhysicalControllerForceFeedbackRegister(
@@ -420,7 +918,7 @@ namespace Xidi
     {
       Initialize();
 
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetControllerCount())
       {
         Message::OutputFormatted(
             Message::ESeverity::Error,
@@ -429,10 +927,29 @@ namespace Xidi
         return nullptr;
       }
 
-      std::unique_lock lock(physicalControllerForceFeedbackMutex[controllerIdentifier]);
-      physicalControllerForceFeedbackRegistration[controllerIdentifier].insert(virtualController);
+      StartForceFeedbackOutput();
+
+      SControllerData& data = controllerData[controllerIdentifier];
+      std::unique_lock lock(data.forceFeedbackMutex);
 
-      return &physicalControllerForceFeedbackBuffer[controllerIdentifier];
+      data.forceFeedbackRegistration.insert(virtualController);
+      if (0 == data.forceFeedbackTaskIdentifier)
+      {
+        data.forceFeedbackTaskIdentifier = Scheduler::AddTask(
+            kPhysicalForceFeedbackPeriodMilliseconds,
+            [controllerIdentifier]() -> unsigned int
+            {
+              return ForceFeedbackActuateEffects(controllerIdentifier);
+            });
+
+        Message::OutputFormatted(
+            Message::ESeverity::Info,
+            L"Physical controller %u: Started force feedback actuation. Desired actuation period is %u ms.",
+            (unsigned int)(1 + controllerIdentifier),
+            kPhysicalForceFeedbackPeriodMilliseconds);
+      }
+
+      return &data.forceFeedbackBuffer;
     }
 
     void PhysicalControllerForceFeedbackUnregister(
@@ -440,7 +957,7 @@ namespace Xidi
     {
       Initialize();
 
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetControllerCount())
       {
         Message::OutputFormatted(
             Message::ESeverity::Error,
@@ -449,8 +966,24 @@ namespace Xidi
         return;
       }
 
-      std::unique_lock lock(physicalControllerForceFeedbackMutex[controllerIdentifier]);
-      physicalControllerForceFeedbackRegistration[controllerIdentifier].erase(virtualController);
+      // Actuation stops the next time the actuation task runs and finds that no virtual
+      // controllers are registered, which ensures that the physical actuators are stopped.
+      std::unique_lock lock(controllerData[controllerIdentifier].forceFeedbackMutex);
+      controllerData[controllerIdentifier].forceFeedbackRegistration.erase(virtualController);
+    }
+
+    bool WaitForExternalInputChange(
+        TControllerIdentifier controllerIdentifier,
+        uint64_t& sequence,
+        SExternalInput& input,
+        std::stop_token stopToken)
+    {
+      Initialize();
+
+      if (controllerIdentifier >= GetControllerCount()) return false;
+
+      return controllerData[controllerIdentifier].externalInputHistory.WaitForNext(
+          sequence, input, stopToken);
     }
 
     bool WaitForPhysicalControllerStateChange(
@@ -460,9 +993,9 @@ namespace Xidi
     {
       Initialize();
 
-      if (controllerIdentifier >= kPhysicalControllerCount) return false;
+      if (controllerIdentifier >= GetControllerCount()) return false;
 
-      return physicalControllerState[controllerIdentifier].WaitForUpdate(state, stopToken);
+      return controllerData[controllerIdentifier].physicalState.WaitForUpdate(state, stopToken);
     }
 
     bool WaitForRawVirtualControllerStateChange(
@@ -470,9 +1003,9 @@ namespace Xidi
     {
       Initialize();
 
-      if (controllerIdentifier >= kPhysicalControllerCount) return false;
+      if (controllerIdentifier >= GetControllerCount()) return false;
 
-      return rawVirtualControllerState[controllerIdentifier].WaitForUpdate(state, stopToken);
+      return controllerData[controllerIdentifier].rawVirtualState.WaitForUpdate(state, stopToken);
     }
   } // namespace Controller
 } // namespace Xidi
\ No newline at end of file
@@ -0,0 +1,159 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file PollTiming.cpp
+ *   Implementation of functionality for measuring how regularly and how quickly physical
+ *   controllers are polled.
+ **************************************************************************************************/
+
+#include "PollTiming.h"
+
+#include <atomic>
+#include <cstdint>
+
+#include "ApiXidi.h"
+#include "ControllerTypes.h"
+#include "InputLatency.h"
+#include "Message.h"
+
+namespace Xidi
+{
+  namespace PollTiming
+  {
+    /// All of the poll timing measurements recorded for a single controller. Recording and
+    /// summarizing are both lock-free, so polling is never blocked by a thread that reads a
+    /// summary.
+    struct SPollTimingData
+    {
+      /// Times between the starts of consecutive polls.
+      InputLatency::Histogram pollInterval;
+
+      /// Times taken to read the physical controller state.
+      InputLatency::Histogram readDuration;
+
+      /// Times taken to map changed physical controller state to virtual controller state.
+      InputLatency::Histogram mapDuration;
+
+      /// Number of polls that observed changed physical controller state.
+      std::atomic<uint64_t> changedPollCount = 0;
+
+      /// Number of notifications sent to threads waiting for state changes.
+      std::atomic<uint64_t> notificationCount = 0;
+    };
+
+    /// Poll timing measurements, one element per controller.
+    static SPollTimingData pollTimingData[Controller::kMaxControllerCount];
+
+    SSummary GetSummary(Controller::TControllerIdentifier controllerIdentifier)
+    {
+      if (controllerIdentifier >= Controller::kMaxControllerCount) return {};
+
+      const SPollTimingData& data = pollTimingData[controllerIdentifier];
+      return {
+          .pollInterval = data.pollInterval.GetSummary(),
+          .readDuration = data.readDuration.GetSummary(),
+          .mapDuration = data.mapDuration.GetSummary(),
+          .changedPollCount = data.changedPollCount.load(std::memory_order_relaxed),
+          .notificationCount = data.notificationCount.load(std::memory_order_relaxed)};
+    }
+
+    void OutputSummaries(void)
+    {
+      if (false == Message::WillOutputMessageOfSeverity(Message::ESeverity::Info)) return;
+
+      for (Controller::TControllerIdentifier controllerIdentifier = 0;
+           controllerIdentifier < Controller::kMaxControllerCount;
+           ++controllerIdentifier)
+      {
+        const SSummary summary = GetSummary(controllerIdentifier);
+        if (0 == summary.readDuration.sampleCount) continue;
+
+        Message::OutputFormatted(
+            Message::ESeverity::Info,
+            L"Controller %u: Poll timing over %llu polls is %u us median, %u us 99th percentile, %u us maximum between polls; %u us median, %u us 99th percentile, %u us maximum to read; %u us median, %u us 99th percentile, %u us maximum to map. %llu polls observed changes, resulting in %llu notifications.",
+            (unsigned int)(1 + controllerIdentifier),
+            (unsigned long long)summary.readDuration.sampleCount,
+            summary.pollInterval.p50,
+            summary.pollInterval.p99,
+            summary.pollInterval.max,
+            summary.readDuration.p50,
+            summary.readDuration.p99,
+            summary.readDuration.max,
+            summary.mapDuration.p50,
+            summary.mapDuration.p99,
+            summary.mapDuration.max,
+            (unsigned long long)summary.changedPollCount,
+            (unsigned long long)summary.notificationCount);
+      }
+    }
+
+    void RecordChangedPoll(
+        Controller::TControllerIdentifier controllerIdentifier,
+        uint32_t mapDuration,
+        unsigned int notificationCount)
+    {
+      if (controllerIdentifier >= Controller::kMaxControllerCount) return;
+
+      SPollTimingData& data = pollTimingData[controllerIdentifier];
+      data.mapDuration.Record(mapDuration);
+      data.changedPollCount.fetch_add(1, std::memory_order_relaxed);
+      data.notificationCount.fetch_add(notificationCount, std::memory_order_relaxed);
+    }
+
+    void RecordPollInterval(
+        Controller::TControllerIdentifier controllerIdentifier, uint32_t pollInterval)
+    {
+      if (controllerIdentifier >= Controller::kMaxControllerCount) return;
+      pollTimingData[controllerIdentifier].pollInterval.Record(pollInterval);
+    }
+
+    void RecordReadDuration(
+        Controller::TControllerIdentifier controllerIdentifier, uint32_t readDuration)
+    {
+      if (controllerIdentifier >= Controller::kMaxControllerCount) return;
+      pollTimingData[controllerIdentifier].readDuration.Record(readDuration);
+    }
+
+    void ResetSummary(Controller::TControllerIdentifier controllerIdentifier)
+    {
+      if (controllerIdentifier >= Controller::kMaxControllerCount) return;
+
+      SPollTimingData& data = pollTimingData[controllerIdentifier];
+      data.pollInterval.Reset();
+      data.readDuration.Reset();
+      data.mapDuration.Reset();
+      data.changedPollCount.store(0, std::memory_order_relaxed);
+      data.notificationCount.store(0, std::memory_order_relaxed);
+    }
+  } // namespace PollTiming
+
+  namespace Api
+  {
+    /// Implements the Xidi API interface #IPollTiming.
+    class PollTimingProvider : public IPollTiming
+    {
+    public:
+
+      // IPollTiming
+      PollTiming::SSummary GetSummary(unsigned int controllerIdentifier) const override
+      {
+        // Checked here because the conversion below would otherwise wrap large identifiers.
+        if (controllerIdentifier >= Controller::kMaxControllerCount) return {};
+        return PollTiming::GetSummary((Controller::TControllerIdentifier)controllerIdentifier);
+      }
+
+      void ResetSummary(unsigned int controllerIdentifier) override
+      {
+        if (controllerIdentifier >= Controller::kMaxControllerCount) return;
+        PollTiming::ResetSummary((Controller::TControllerIdentifier)controllerIdentifier);
+      }
+    };
+
+    /// Singleton Xidi API implementation object.
+    static PollTimingProvider pollTimingProvider;
+  } // namespace Api
+} // namespace Xidi
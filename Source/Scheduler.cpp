@@ -0,0 +1,311 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file Scheduler.cpp
+ *   Implementation of the scheduler that runs all periodic tasks on a single thread.
+ **************************************************************************************************/
+
+#include "Scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "ApiWindows.h"
+#include "Message.h"
+#include "Strings.h"
+
+// Older SDK versions do not define this flag, but the operating system ignores it, and creation
+// then fails, on versions of Windows that do not support it.
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+namespace Xidi
+{
+  namespace Scheduler
+  {
+    /// Holds all of the information about a single periodic task.
+    struct STask
+    {
+      /// Function to be invoked each time the task is due.
+      TTaskFunction taskFunction;
+
+      /// Time at which the task is next due.
+      TClock::time_point deadline;
+
+      /// Indicates that the task was removed while it was running, so that the scheduler thread
+      /// discards it once the invocation completes.
+      bool removed;
+    };
+
+    /// Holds all of the state of the scheduler.
+    struct SSchedulerState
+    {
+      /// Protects all other members against concurrent access.
+      std::mutex mutex;
+
+      /// All tasks that are currently scheduled, keyed by identifier. Since only a few dozen tasks
+      /// exist at most, finding the one with the earliest deadline is a simple linear scan.
+      std::map<TTaskIdentifier, STask> tasks;
+
+      /// Identifier to assign to the next task that is added.
+      TTaskIdentifier nextTaskIdentifier = 1;
+
+      /// Identifier of the task currently being invoked on the scheduler thread, or 0 if none.
+      TTaskIdentifier runningTaskIdentifier = 0;
+
+      /// Waitable timer used to sleep until the next deadline, or `nullptr` if none could be
+      /// created.
+      HANDLE timerHandle = nullptr;
+
+      /// Auto-reset event signalled whenever a task is added, so that the scheduler thread
+      /// re-evaluates the earliest deadline.
+      HANDLE wakeEventHandle = nullptr;
+    };
+
+    /// Retrieves the state of the scheduler.
+    /// @return Mutable reference to the scheduler state.
+    static SSchedulerState& GetSchedulerState(void)
+    {
+      static SSchedulerState schedulerState;
+      return schedulerState;
+    }
+
+    /// Creates the waitable timer used by the scheduler thread, preferring a high-resolution timer,
+    /// whose precision does not depend on the system timer resolution.
+    /// @return Handle of the timer, or `nullptr` if none could be created.
+    static HANDLE CreateSchedulerTimer(void)
+    {
+      HANDLE timerHandle = CreateWaitableTimerExW(
+          nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+      if (nullptr != timerHandle)
+      {
+        Message::Output(
+            Message::ESeverity::Info, L"Scheduler is using a high-resolution waitable timer.");
+        return timerHandle;
+      }
+
+      timerHandle = CreateWaitableTimerW(nullptr, FALSE, nullptr);
+      if (nullptr != timerHandle)
+        Message::Output(
+            Message::ESeverity::Warning,
+            L"Scheduler is using a standard waitable timer because high-resolution timers are not supported. Scheduling precision depends on the system timer resolution.");
+      else
+        Message::OutputFormatted(
+            Message::ESeverity::Error,
+            L"Scheduler failed to create a waitable timer: %s.",
+            Strings::SystemErrorCodeString(GetLastError()).AsCString());
+
+      return timerHandle;
+    }
+
+    /// Blocks the scheduler thread until the specified deadline passes or a task is added,
+    /// whichever happens first.
+    /// @param [in] state Scheduler state.
+    /// @param [in] deadline Deadline until which to wait, or empty to wait only for a task to be
+    /// added.
+    static void WaitForDeadline(
+        const SSchedulerState& state, std::optional<TClock::time_point> deadline)
+    {
+      if (false == deadline.has_value())
+      {
+        WaitForSingleObject(state.wakeEventHandle, INFINITE);
+        return;
+      }
+
+      const TClock::duration remaining = *deadline - TClock::now();
+      if (remaining <= TClock::duration::zero()) return;
+
+      if (nullptr != state.timerHandle)
+      {
+        // Waitable timer due times are expressed in 100-nanosecond units, and negative values are
+        // relative to the current time.
+        using TTimerDuration = std::chrono::duration<int64_t, std::ratio<1, 10000000>>;
+        const LARGE_INTEGER dueTime = {
+            .QuadPart = -std::chrono::ceil<TTimerDuration>(remaining).count()};
+
+        if (FALSE != SetWaitableTimer(state.timerHandle, &dueTime, 0, nullptr, nullptr, FALSE))
+        {
+          const HANDLE waitHandles[] = {state.timerHandle, state.wakeEventHandle};
+          WaitForMultipleObjects(_countof(waitHandles), waitHandles, FALSE, INFINITE);
+          return;
+        }
+      }
+
+      WaitForSingleObject(
+          state.wakeEventHandle,
+          (DWORD)std::chrono::ceil<std::chrono::milliseconds>(remaining).count());
+    }
+
+    /// Finds the task with the earliest deadline and, if that deadline already passed, marks it as
+    /// running. Must be invoked with the scheduler state's mutex held.
+    /// @param [in,out] state Scheduler state.
+    /// @param [out] earliestDeadline Filled in with the earliest deadline of any task, or left
+    /// empty if there are no tasks.
+    /// @param [out] earliestTaskIdentifier Filled in with the identifier of the task that has the
+    /// earliest deadline.
+    /// @return Pointer to the task that is due, or `nullptr` if no task is due yet.
+    static STask* FindDueTask(
+        SSchedulerState& state,
+        std::optional<TClock::time_point>& earliestDeadline,
+        TTaskIdentifier& earliestTaskIdentifier)
+    {
+      for (const auto& [taskIdentifier, task] : state.tasks)
+      {
+        if ((false == earliestDeadline.has_value()) || (task.deadline < *earliestDeadline))
+        {
+          earliestDeadline = task.deadline;
+          earliestTaskIdentifier = taskIdentifier;
+        }
+      }
+
+      if ((false == earliestDeadline.has_value()) || (*earliestDeadline > TClock::now()))
+        return nullptr;
+
+      // Pointers to elements of a map remain valid while other elements are inserted and removed,
+      // and a running task is only ever erased by the scheduler thread itself.
+      state.runningTaskIdentifier = earliestTaskIdentifier;
+      return &state.tasks.at(earliestTaskIdentifier);
+    }
+
+    /// Repeatedly invokes whichever task has the earliest deadline, once that deadline passes.
+    /// Intended to be a thread entry point. Never returns.
+    static void RunScheduler(void)
+    {
+      SSchedulerState& state = GetSchedulerState();
+
+      while (true)
+      {
+        std::optional<TClock::time_point> earliestDeadline;
+        TTaskIdentifier earliestTaskIdentifier = 0;
+        STask* dueTask = nullptr;
+
+        {
+          std::scoped_lock lock(state.mutex);
+          dueTask = FindDueTask(state, earliestDeadline, earliestTaskIdentifier);
+        }
+
+        if (nullptr == dueTask)
+        {
+          WaitForDeadline(state, earliestDeadline);
+          continue;
+        }
+
+        const unsigned int periodMilliseconds = dueTask->taskFunction();
+        unsigned int missedInvocations = 0;
+
+        {
+          std::scoped_lock lock(state.mutex);
+          state.runningTaskIdentifier = 0;
+
+          if (true == dueTask->removed)
+          {
+            state.tasks.erase(earliestTaskIdentifier);
+            continue;
+          }
+
+          dueTask->deadline = NextDeadline(
+              dueTask->deadline, periodMilliseconds, TClock::now(), missedInvocations);
+        }
+
+        if (0 != missedInvocations)
+          Message::OutputFormatted(
+              Message::ESeverity::SuperDebug,
+              L"Scheduler: Task %llu fell behind and skipped %u invocation(s).",
+              (unsigned long long)earliestTaskIdentifier,
+              missedInvocations);
+      }
+    }
+
+    /// Creates the scheduler's synchronization objects and starts the scheduler thread.
+    /// Idempotent and concurrency-safe.
+    static void StartSchedulerThread(void)
+    {
+      static std::once_flag startFlag;
+      std::call_once(
+          startFlag,
+          []() -> void
+          {
+            SSchedulerState& state = GetSchedulerState();
+            state.timerHandle = CreateSchedulerTimer();
+            state.wakeEventHandle = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+
+            std::thread(RunScheduler).detach();
+            Message::Output(Message::ESeverity::Info, L"Initialized the scheduler thread.");
+          });
+    }
+
+    TTaskIdentifier AddTask(unsigned int initialPeriodMilliseconds, TTaskFunction taskFunction)
+    {
+      StartSchedulerThread();
+
+      SSchedulerState& state = GetSchedulerState();
+      TTaskIdentifier taskIdentifier = 0;
+
+      {
+        std::scoped_lock lock(state.mutex);
+
+        taskIdentifier = state.nextTaskIdentifier;
+        state.nextTaskIdentifier += 1;
+
+        state.tasks.emplace(
+            taskIdentifier,
+            STask{
+                .taskFunction = std::move(taskFunction),
+                .deadline = TClock::now() +
+                    std::chrono::milliseconds(
+                                std::max(initialPeriodMilliseconds, kMinimumPeriodMilliseconds)),
+                .removed = false});
+      }
+
+      SetEvent(state.wakeEventHandle);
+      return taskIdentifier;
+    }
+
+    TClock::time_point NextDeadline(
+        TClock::time_point previousDeadline,
+        unsigned int periodMilliseconds,
+        TClock::time_point now,
+        unsigned int& missedInvocations)
+    {
+      const TClock::duration period =
+          std::chrono::milliseconds(std::max(periodMilliseconds, kMinimumPeriodMilliseconds));
+      TClock::time_point nextDeadline = previousDeadline + period;
+
+      missedInvocations = 0;
+      if (nextDeadline < now)
+      {
+        // Every deadline that already passed is skipped, but one that falls exactly on the
+        // current time is still due.
+        missedInvocations =
+            (unsigned int)(((now - nextDeadline) + period - TClock::duration(1)) / period);
+        nextDeadline += (period * missedInvocations);
+      }
+
+      return nextDeadline;
+    }
+
+    void RemoveTask(TTaskIdentifier taskIdentifier)
+    {
+      SSchedulerState& state = GetSchedulerState();
+      std::scoped_lock lock(state.mutex);
+
+      auto taskIter = state.tasks.find(taskIdentifier);
+      if (state.tasks.end() == taskIter) return;
+
+      if (taskIdentifier == state.runningTaskIdentifier)
+        taskIter->second.removed = true;
+      else
+        state.tasks.erase(taskIter);
+    }
+  } // namespace Scheduler
+} // namespace Xidi
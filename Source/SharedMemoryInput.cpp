@@ -0,0 +1,1360 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file SharedMemoryInput.cpp
+ *   Implementation of functionality for reading input supplied by external producers via shared
+ *   memory.
+ **************************************************************************************************/
+
+#include "SharedMemoryInput.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "ApiWindows.h"
+#include "Configuration.h"
+#include "ControllerTypes.h"
+#include "Globals.h"
+#include "Keyboard.h"
+#include "Message.h"
+#include "Mouse.h"
+#include "SharedMemoryJson.h"
+#include "SharedMemoryTypes.h"
+#include "Strings.h"
+
+namespace Xidi
+{
+  namespace SharedMemory
+  {
+    /// Holds the state needed to read input from a single shared memory channel. Each channel is a
+    /// separate named mapping, optionally accompanied by a named event, written by its own
+    /// producer.
+    struct SChannel
+    {
+      /// Name of the shared memory mapping.
+      std::wstring mappingName;
+
+      /// Name of the optional event that the producer signals after writing a frame.
+      std::wstring eventName;
+
+      /// Handle to the shared memory mapping, once it has been successfully opened.
+      HANDLE mappingHandle = nullptr;
+
+      /// Read-only view of the entire shared memory mapping, once it has been successfully mapped.
+      const void* mappingView = nullptr;
+
+      /// Number of readable bytes in the view of the shared memory mapping.
+      size_t mappingViewSizeBytes = 0;
+
+      /// Producer instance identifier that was present in the frame when the mapping was opened.
+      uint32_t mappingInstanceIdentifier = 0;
+
+      /// Time, in milliseconds since system start, of the most recent attempt to open the mapping.
+      ULONGLONG mappingLastOpenAttemptTime = 0;
+
+      /// Indicates whether an attempt to open the mapping has been made at all.
+      bool mappingOpenAttempted = false;
+
+      /// Handle to the event that the producer signals after writing a frame, once it has been
+      /// successfully opened.
+      HANDLE signalEventHandle = nullptr;
+
+      /// Time, in milliseconds since system start, of the most recent attempt to open the event.
+      ULONGLONG signalEventLastOpenAttemptTime = 0;
+
+      /// Indicates whether an attempt to open the event has been made at all.
+      bool signalEventOpenAttempted = false;
+
+      /// Producer instance identifier of the frame that was most recently examined.
+      uint32_t lastFrameInstanceIdentifier = 0;
+
+      /// Generation counter value of the frame that was most recently examined.
+      uint32_t lastFrameGeneration = 0;
+
+      /// Indicates whether a frame has been examined since the mapping was opened, and hence
+      /// whether the identifying information about the most recently examined frame is valid.
+      bool lastFrameValid = false;
+
+      /// Input decoded from the most recent frame that does not carry a generation counter. Used
+      /// to detect whether such frames have changed.
+      SFrameInput lastUnversionedFrameInput = {};
+
+      /// Number of the ring payload frame that was most recently examined.
+      uint32_t lastRingFrameNumber = 0;
+
+      /// Input decoded from the ring payload frame that was most recently read. Delta frames are
+      /// applied on top of it.
+      SFrameInput lastRingFrameInput = {};
+
+      /// Indicates whether the input decoded from the most recently read ring payload frame is
+      /// valid and can be used as the base for the next delta frame.
+      bool lastRingFrameInputValid = false;
+
+      /// Running totals of relative mouse motion up to which motion was already consumed.
+      SMouseMotionCursor mouseMotionCursor = {};
+    };
+
+    /// Channels from which input is read, in priority order. Only the first `channelCount`
+    /// elements are used.
+    static SChannel channels[kMaxChannelCount];
+
+    /// Number of channels from which input is read.
+    static unsigned int channelCount = 0;
+
+    /// Most recent input decoded from each channel, one element per channel. Kept apart from the
+    /// rest of the per-channel state so that it can be merged as a contiguous array.
+    static SFrameInput channelFrameInput[kMaxChannelCount];
+
+    /// Policies used to merge input from multiple channels.
+    static SMergePolicy mergePolicy;
+
+    /// Index of the channel to be checked first for a new frame. Rotates so that a channel with a
+    /// busy producer cannot prevent the others from being read.
+    static unsigned int nextChannelIndex = 0;
+
+    /// Closes the view of a channel's shared memory mapping and the mapping itself, if they are
+    /// open.
+    /// @param [in,out] channel Channel whose mapping is to be closed.
+    static void CloseMappingView(SChannel& channel)
+    {
+      if (nullptr != channel.mappingView)
+      {
+        UnmapViewOfFile(channel.mappingView);
+        channel.mappingView = nullptr;
+        channel.mappingViewSizeBytes = 0;
+      }
+
+      if (nullptr != channel.mappingHandle)
+      {
+        CloseHandle(channel.mappingHandle);
+        channel.mappingHandle = nullptr;
+      }
+    }
+
+    /// Attempts to open a channel's shared memory mapping and map a read-only view of the whole
+    /// mapping. Any previously-opened mapping is closed first.
+    /// @param [in,out] channel Channel whose mapping is to be opened.
+    static void OpenMappingView(SChannel& channel)
+    {
+      CloseMappingView(channel);
+
+      channel.mappingOpenAttempted = true;
+      channel.mappingLastOpenAttemptTime = GetTickCount64();
+      channel.lastFrameValid = false;
+      channel.mouseMotionCursor = {};
+
+      channel.mappingHandle = OpenFileMappingW(FILE_MAP_READ, FALSE, channel.mappingName.c_str());
+      if (nullptr == channel.mappingHandle) return;
+
+      channel.mappingView = MapViewOfFile(channel.mappingHandle, FILE_MAP_READ, 0, 0, 0);
+      if (nullptr == channel.mappingView)
+      {
+        Message::OutputFormatted(
+            Message::ESeverity::Warning,
+            L"Failed to map a view of the shared memory input mapping (%s): %s.",
+            channel.mappingName.c_str(),
+            Strings::SystemErrorCodeString(GetLastError()).AsCString());
+        CloseMappingView(channel);
+        return;
+      }
+
+      MEMORY_BASIC_INFORMATION mappingViewInfo = {};
+      if (0 == VirtualQuery(channel.mappingView, &mappingViewInfo, sizeof(mappingViewInfo)))
+      {
+        CloseMappingView(channel);
+        return;
+      }
+
+      channel.mappingViewSizeBytes = mappingViewInfo.RegionSize;
+      channel.mappingInstanceIdentifier =
+          GetFrameInstanceIdentifier(channel.mappingView, channel.mappingViewSizeBytes);
+
+      Message::OutputFormatted(
+          Message::ESeverity::Info,
+          L"Opened shared memory input mapping (%s), size = %zu bytes, producer instance = %u.",
+          channel.mappingName.c_str(),
+          channel.mappingViewSizeBytes,
+          channel.mappingInstanceIdentifier);
+    }
+
+    /// Determines if a channel's shared memory mapping should be opened or re-opened. This is the
+    /// case if it is not open and enough time has passed since the last attempt to open it, or if
+    /// it is open but the producer has restarted since it was opened.
+    /// @param [in] channel Channel whose mapping is to be checked.
+    /// @return `true` if the mapping should be opened or re-opened, `false` otherwise.
+    static bool MappingViewNeedsRefresh(const SChannel& channel)
+    {
+      if (nullptr == channel.mappingView)
+      {
+        return (
+            (false == channel.mappingOpenAttempted) ||
+            ((GetTickCount64() - channel.mappingLastOpenAttemptTime) >=
+             kMappingOpenRetryPeriodMilliseconds));
+      }
+
+      return (
+          channel.mappingInstanceIdentifier !=
+          GetFrameInstanceIdentifier(channel.mappingView, channel.mappingViewSizeBytes));
+    }
+
+    /// Attempts to open the event that a channel's producer signals after writing a frame, if it is
+    /// not already open and enough time has passed since the last attempt to open it. Once open,
+    /// the event remains open, because a restarted producer that creates an event with the same
+    /// name obtains the same event object for as long as any handle to it exists.
+    /// @param [in,out] channel Channel whose event is to be opened.
+    static void OpenSignalEventIfNeeded(SChannel& channel)
+    {
+      if (nullptr != channel.signalEventHandle) return;
+
+      if ((true == channel.signalEventOpenAttempted) &&
+          ((GetTickCount64() - channel.signalEventLastOpenAttemptTime) <
+           kMappingOpenRetryPeriodMilliseconds))
+        return;
+
+      channel.signalEventOpenAttempted = true;
+      channel.signalEventLastOpenAttemptTime = GetTickCount64();
+
+      channel.signalEventHandle = OpenEventW(SYNCHRONIZE, FALSE, channel.eventName.c_str());
+      if (nullptr == channel.signalEventHandle) return;
+
+      Message::OutputFormatted(
+          Message::ESeverity::Info,
+          L"Opened shared memory input event (%s). New frames are ingested as soon as they are signalled.",
+          channel.eventName.c_str());
+    }
+
+    /// Reads a merge policy from the configuration, if it is specified there, and checks that it
+    /// can be applied to the intended type of element.
+    /// @param [in] settingName Name of the configuration setting that holds the merge policy.
+    /// @param [in] allowedPolicies Merge policies that can be applied to the intended type of
+    /// element.
+    /// @param [in,out] policy On input, the merge policy to use if none is configured. On output,
+    /// the configured merge policy if it is valid, otherwise left unmodified.
+    static void ReadMergePolicyConfiguration(
+        std::wstring_view settingName,
+        std::initializer_list<EMergePolicy> allowedPolicies,
+        EMergePolicy& policy)
+    {
+      const std::optional<std::wstring_view> maybePolicyString =
+          Globals::GetConfigurationData().GetFirstStringValue(
+              Strings::kStrConfigurationSectionSharedMemory, settingName);
+      if (false == maybePolicyString.has_value()) return;
+
+      const std::optional<EMergePolicy> maybePolicy = MergePolicyFromString(*maybePolicyString);
+      if ((false == maybePolicy.has_value()) ||
+          (allowedPolicies.end() ==
+           std::find(allowedPolicies.begin(), allowedPolicies.end(), *maybePolicy)))
+      {
+        Message::OutputFormatted(
+            Message::ESeverity::Warning,
+            L"Ignoring shared memory merge policy %s = %s because it is not recognized or does not apply to that type of element.",
+            settingName.data(),
+            maybePolicyString->data());
+        return;
+      }
+
+      policy = *maybePolicy;
+    }
+
+    /// Reads the channels and merge policies from the configuration, the first time it is
+    /// invoked. If no channels are configured, input is read from a single channel that uses the
+    /// default mapping name.
+    static void InitializeChannelsIfNeeded(void)
+    {
+      static std::once_flag initFlag;
+      std::call_once(
+          initFlag,
+          []() -> void
+          {
+            for (unsigned int i = 0; i < kMaxChannelCount; ++i)
+            {
+              const std::optional<std::wstring_view> maybeMappingName =
+                  Globals::GetConfigurationData().GetFirstStringValue(
+                      Strings::kStrConfigurationSectionSharedMemory,
+                      Strings::SharedMemoryChannelConfigurationNameString(i));
+              if (false == maybeMappingName.has_value()) continue;
+
+              channels[channelCount].mappingName = *maybeMappingName;
+              channelCount += 1;
+            }
+
+            if (0 == channelCount)
+            {
+              channels[0].mappingName = Strings::kStrSharedMemoryInputMappingName;
+              channelCount = 1;
+            }
+
+            for (unsigned int i = 0; i < channelCount; ++i)
+            {
+              channels[i].eventName = channels[i].mappingName +
+                  std::wstring(Strings::kStrSharedMemoryInputEventNameSuffix);
+
+              Message::OutputFormatted(
+                  Message::ESeverity::Info,
+                  L"Shared memory input channel %u reads from mapping %s.",
+                  (1 + i),
+                  channels[i].mappingName.c_str());
+            }
+
+            ReadMergePolicyConfiguration(
+                Strings::kStrConfigurationSettingSharedMemoryButtonMerge,
+                {EMergePolicy::Or, EMergePolicy::Priority},
+                mergePolicy.button);
+
+            EMergePolicy defaultAxisPolicy = EMergePolicy::Priority;
+            ReadMergePolicyConfiguration(
+                Strings::kStrConfigurationSettingSharedMemoryAxisMerge,
+                {EMergePolicy::Sum, EMergePolicy::Max, EMergePolicy::Priority},
+                defaultAxisPolicy);
+
+            for (int i = 0; i < static_cast<int>(Controller::EAxis::Count); ++i)
+            {
+              mergePolicy.axis[i] = defaultAxisPolicy;
+              ReadMergePolicyConfiguration(
+                  Strings::SharedMemoryAxisMergeConfigurationNameString(
+                      static_cast<Controller::EAxis>(i)),
+                  {EMergePolicy::Sum, EMergePolicy::Max, EMergePolicy::Priority},
+                  mergePolicy.axis[i]);
+            }
+          });
+    }
+
+    /// Decodes a keyboard block into keyboard input.
+    /// @param [in] keyboardBlock Keyboard block to decode.
+    /// @param [in,out] keyboardMouseInput Keyboard and mouse input to which the pressed and
+    /// released keys are added, or to which the key state is written if the keyboard block holds a
+    /// key state bitmap.
+    static void DecodeKeyboardBlock(
+        const SKeyboardBlock& keyboardBlock, SKeyboardMouseInput& keyboardMouseInput)
+    {
+      if (0 != (keyboardBlock.flags & kKeyboardBlockFlagBitmap))
+      {
+        keyboardMouseInput.keyStatePresent = true;
+        std::memcpy(
+            keyboardMouseInput.keyState.data(),
+            keyboardBlock.pressed,
+            sizeof(keyboardMouseInput.keyState));
+        return;
+      }
+
+      const unsigned int pressedCount =
+          std::min((unsigned int)keyboardBlock.pressedCount, kKeyboardBlockMaxKeys);
+      for (unsigned int i = 0; i < pressedCount; ++i)
+        keyboardMouseInput.keyPressed[keyboardBlock.pressed[i]] = true;
+
+      const unsigned int releasedCount =
+          std::min((unsigned int)keyboardBlock.releasedCount, kKeyboardBlockMaxKeys);
+      for (unsigned int i = 0; i < releasedCount; ++i)
+        keyboardMouseInput.keyReleased[keyboardBlock.released[i]] = true;
+    }
+
+    /// Decodes a mouse block into mouse input.
+    /// @param [in] mouseBlock Mouse block to decode.
+    /// @param [in,out] keyboardMouseInput Keyboard and mouse input to which the mouse button states
+    /// and either the movement values or the relative motion totals are written, if the mouse
+    /// block flags them as valid.
+    static void DecodeMouseBlock(
+        const SMouseBlock& mouseBlock, SKeyboardMouseInput& keyboardMouseInput)
+    {
+      if (0 != (mouseBlock.flags & kMouseBlockFlagButtons))
+      {
+        keyboardMouseInput.mouseButtonPresent.set();
+        for (int i = 0; i < static_cast<int>(Mouse::EMouseButton::Count); ++i)
+          keyboardMouseInput.mouseButtonPressed[i] = (0 != mouseBlock.button[i]);
+      }
+
+      if (0 != (mouseBlock.flags & kMouseBlockFlagMotion))
+      {
+        keyboardMouseInput.mouseMotionPresent.set();
+        for (int i = 0; i < static_cast<int>(Mouse::EMouseAxis::Count); ++i)
+          keyboardMouseInput.mouseMotion[i] = mouseBlock.movement[i];
+      }
+      else if (0 != (mouseBlock.flags & kMouseBlockFlagMovement))
+      {
+        keyboardMouseInput.mouseMovementPresent.set();
+        for (int i = 0; i < static_cast<int>(Mouse::EMouseAxis::Count); ++i)
+          keyboardMouseInput.mouseMovement[i] = mouseBlock.movement[i];
+      }
+    }
+
+    /// Decodes a keyboard block, a mouse block, and a sequence of controller blocks, laid out
+    /// contiguously in the same way as in a binary payload. The caller is responsible for ensuring
+    /// that all of the blocks are readable.
+    /// @param [in] blocks Pointer to the start of the keyboard block.
+    /// @param [in] controllerCount Number of controller blocks that follow the mouse block.
+    /// @param [out] frameInput Filled in with the input supplied by the blocks.
+    static void DecodeBinaryBlocks(
+        const uint8_t* blocks, unsigned int controllerCount, SFrameInput& frameInput)
+    {
+      static constexpr size_t kMouseBlockRelativeOffset = kMouseBlockOffset - kKeyboardBlockOffset;
+      static constexpr size_t kControllerBlockRelativeOffset =
+          kControllerBlockOffset - kKeyboardBlockOffset;
+
+      controllerCount = std::min(controllerCount, (unsigned int)frameInput.controller.size());
+      for (unsigned int controllerIdentifier = 0; controllerIdentifier < controllerCount;
+           ++controllerIdentifier)
+      {
+        Controller::SStateOverlay& overlay = frameInput.controller[controllerIdentifier];
+
+        SControllerBlock controllerBlock;
+        std::memcpy(
+            &controllerBlock,
+            &blocks
+                [kControllerBlockRelativeOffset +
+                 (sizeof(SControllerBlock) * controllerIdentifier)],
+            sizeof(controllerBlock));
+
+        static_assert(
+            sizeof(controllerBlock.axis) == sizeof(overlay.values.axis),
+            "Controller block axis layout does not match the virtual controller state.");
+        std::memcpy(overlay.values.axis.data(), controllerBlock.axis, sizeof(controllerBlock.axis));
+
+        overlay.values.button = (decltype(overlay.values.button)(controllerBlock.button[1]) << 64) |
+            decltype(overlay.values.button)(controllerBlock.button[0]);
+
+        for (int i = 0; i < static_cast<int>(Controller::EPovDirection::Count); ++i)
+          overlay.values.povDirection.components[i] = (0 != controllerBlock.povDirection[i]);
+
+        overlay.axisPresent.set();
+        overlay.buttonPresent.set();
+        overlay.povDirectionPresent.set();
+      }
+
+      SKeyboardBlock keyboardBlock;
+      std::memcpy(&keyboardBlock, blocks, sizeof(keyboardBlock));
+      DecodeKeyboardBlock(keyboardBlock, frameInput.keyboardMouse);
+
+      SMouseBlock mouseBlock;
+      std::memcpy(&mouseBlock, &blocks[kMouseBlockRelativeOffset], sizeof(mouseBlock));
+      DecodeMouseBlock(mouseBlock, frameInput.keyboardMouse);
+    }
+
+    /// Applies the blocks of a delta frame on top of the input decoded from the preceding frame.
+    /// Blocks are tightly packed, so every read is checked against the bounds of the slot.
+    /// @param [in] blocks Pointer to the first byte following the ring slot header.
+    /// @param [in] blocksSizeBytes Number of readable bytes starting at the blocks pointer.
+    /// @param [in] flags Flags from the ring slot header, which identify the blocks present.
+    /// @param [in] controllerCount Number of controller delta blocks present.
+    /// @param [in,out] frameInput On input, the input decoded from the preceding frame. On output,
+    /// updated with the changes that the delta frame supplies.
+    /// @return `true` if all of the blocks fit within the slot and are valid, `false` otherwise.
+    static bool DecodeDeltaBlocks(
+        const uint8_t* blocks,
+        size_t blocksSizeBytes,
+        uint32_t flags,
+        unsigned int controllerCount,
+        SFrameInput& frameInput)
+    {
+      static constexpr int kButtonGroupCount = static_cast<int>(Controller::EButton::Count) / 64;
+
+      size_t offset = 0;
+      auto readNext = [blocks, blocksSizeBytes, &offset](void* destination, size_t sizeBytes)
+      {
+        if (sizeBytes > (blocksSizeBytes - offset)) return false;
+
+        std::memcpy(destination, &blocks[offset], sizeBytes);
+        offset += sizeBytes;
+        return true;
+      };
+
+      SKeyboardMouseInput& keyboardMouseInput = frameInput.keyboardMouse;
+
+      if (0 != (flags & kRingSlotFlagDeltaKeyboard))
+      {
+        SKeyboardBlock keyboardBlock;
+        if (false == readNext(&keyboardBlock, sizeof(keyboardBlock))) return false;
+
+        keyboardMouseInput.keyPressed.reset();
+        keyboardMouseInput.keyReleased.reset();
+        keyboardMouseInput.keyStatePresent = false;
+        keyboardMouseInput.keyState = {};
+        DecodeKeyboardBlock(keyboardBlock, keyboardMouseInput);
+      }
+
+      if (0 != (flags & kRingSlotFlagDeltaMouse))
+      {
+        SMouseBlock mouseBlock;
+        if (false == readNext(&mouseBlock, sizeof(mouseBlock))) return false;
+
+        keyboardMouseInput.mouseButtonPresent.reset();
+        keyboardMouseInput.mouseButtonPressed.reset();
+        keyboardMouseInput.mouseMovementPresent.reset();
+        keyboardMouseInput.mouseMovement = {};
+        keyboardMouseInput.mouseMotionPresent.reset();
+        keyboardMouseInput.mouseMotion = {};
+        DecodeMouseBlock(mouseBlock, keyboardMouseInput);
+      }
+
+      // Controller delta blocks vary in size, so there is no need to read past the last one for
+      // which input is kept.
+      controllerCount = std::min(controllerCount, (unsigned int)frameInput.controller.size());
+      for (unsigned int controllerIdentifier = 0; controllerIdentifier < controllerCount;
+           ++controllerIdentifier)
+      {
+        Controller::SStateOverlay& overlay = frameInput.controller[controllerIdentifier];
+
+        SControllerDeltaHeader deltaHeader;
+        if (false == readNext(&deltaHeader, sizeof(deltaHeader))) return false;
+
+        if ((0 != (deltaHeader.axisMask >> static_cast<int>(Controller::EAxis::Count))) ||
+            (0 != (deltaHeader.buttonGroupMask >> kButtonGroupCount)))
+          return false;
+
+        for (int group = 0; group < kButtonGroupCount; ++group)
+        {
+          if (0 == (deltaHeader.buttonGroupMask & (1u << group))) continue;
+
+          uint64_t buttonWords[2];
+          if (false == readNext(buttonWords, sizeof(buttonWords))) return false;
+
+          for (uint64_t changedButtons = buttonWords[0]; 0 != changedButtons;
+               changedButtons &= (changedButtons - 1))
+          {
+            const int bit = std::countr_zero(changedButtons);
+            const int button = (group * 64) + bit;
+
+            overlay.values.button[button] = (0 != ((buttonWords[1] >> bit) & 1));
+            overlay.buttonPresent[button] = true;
+          }
+        }
+
+        for (int axis = 0; axis < static_cast<int>(Controller::EAxis::Count); ++axis)
+        {
+          if (0 == (deltaHeader.axisMask & (1u << axis))) continue;
+
+          int32_t axisValue;
+          if (false == readNext(&axisValue, sizeof(axisValue))) return false;
+
+          overlay.values.axis[axis] = axisValue;
+          overlay.axisPresent[axis] = true;
+        }
+
+        for (int i = 0; i < static_cast<int>(Controller::EPovDirection::Count); ++i)
+        {
+          if (0 == (deltaHeader.povDirectionMask & (1u << i))) continue;
+
+          overlay.values.povDirection.components[i] =
+              (0 != (deltaHeader.povDirectionValue & (1u << i)));
+          overlay.povDirectionPresent[i] = true;
+        }
+      }
+
+      return true;
+    }
+
+    /// Decodes a binary payload that describes input for all controllers.
+    /// @param [in] frame Pointer to the start of the frame, including the header.
+    /// @param [in] frameSizeBytes Number of readable bytes starting at the frame pointer.
+    /// @param [in] header Frame header, already validated.
+    /// @param [out] frameInput Filled in with the input supplied by the payload.
+    /// @return `true` if the payload fits within the frame and was decoded, `false` otherwise.
+    static bool DecodeBinaryPayload(
+        const uint8_t* frame,
+        size_t frameSizeBytes,
+        const SFrameHeader& header,
+        SFrameInput& frameInput)
+    {
+      const size_t payloadEndOffset =
+          kControllerBlockOffset + (sizeof(SControllerBlock) * (size_t)header.controllerCount);
+      if (payloadEndOffset > frameSizeBytes) return false;
+
+      DecodeBinaryBlocks(&frame[kKeyboardBlockOffset], header.controllerCount, frameInput);
+      return true;
+    }
+
+    /// Reads the header of a ring payload and verifies that the entire ring fits within the frame.
+    /// @param [in] frame Pointer to the start of the frame, including the header.
+    /// @param [in] frameSizeBytes Number of readable bytes starting at the frame pointer.
+    /// @param [in] header Frame header, already validated.
+    /// @param [out] slotCount Filled in with the number of slots in the ring.
+    /// @param [out] slotSizeBytes Filled in with the size of each slot in the ring.
+    /// @return `true` if the ring is valid and fits within the frame, `false` otherwise.
+    static bool GetRingLayout(
+        const uint8_t* frame,
+        size_t frameSizeBytes,
+        const SFrameHeader& header,
+        uint32_t& slotCount,
+        size_t& slotSizeBytes)
+    {
+      if (frameSizeBytes < kRingSlotOffset) return false;
+
+      slotCount = std::atomic_ref<uint32_t>(
+                      const_cast<uint32_t&>(
+                          reinterpret_cast<const SRingHeader*>(&frame[kRingHeaderOffset])
+                              ->slotCount))
+                      .load(std::memory_order_relaxed);
+      slotSizeBytes = RingSlotSizeBytes(header.controllerCount);
+
+      return (
+          (0 != slotCount) &&
+          ((size_t)slotCount <= ((frameSizeBytes - kRingSlotOffset) / slotSizeBytes)));
+    }
+
+    /// Reads the write count of a ring payload, which is the number of the most recent frame.
+    /// @param [in] frame Pointer to the start of the frame, including the header.
+    /// @return Write count of the ring.
+    static uint32_t GetRingWriteCount(const uint8_t* frame)
+    {
+      return std::atomic_ref<uint32_t>(
+                 const_cast<uint32_t&>(
+                     reinterpret_cast<const SRingHeader*>(&frame[kRingHeaderOffset])->writeCount))
+          .load(std::memory_order_acquire);
+    }
+
+    /// Decodes a single frame held in a slot of a ring payload. Concurrency-safe with respect to a
+    /// producer that is writing to the ring.
+    /// @param [in] frame Pointer to the start of the frame, including the header.
+    /// @param [in] frameSizeBytes Number of readable bytes starting at the frame pointer.
+    /// @param [in] header Frame header, already validated.
+    /// @param [in] frameNumber Number of the frame to decode.
+    /// @param [in] previousFrameInput Input decoded from the frame that immediately precedes the
+    /// requested frame, on top of which a delta frame is applied. May be `nullptr`, in which case
+    /// only full frames can be decoded.
+    /// @param [out] frameInput Filled in with the input supplied by the frame. Might be partially
+    /// filled in on failure.
+    /// @return `true` if the frame was decoded, `false` if the ring is invalid, if the slot does
+    /// not hold the requested frame, either because it has not been written yet or because it has
+    /// already been overwritten, or if the frame is a delta frame that cannot be applied.
+    static bool DecodeRingPayload(
+        const uint8_t* frame,
+        size_t frameSizeBytes,
+        const SFrameHeader& header,
+        uint32_t frameNumber,
+        const SFrameInput* previousFrameInput,
+        SFrameInput& frameInput)
+    {
+      uint32_t slotCount = 0;
+      size_t slotSizeBytes = 0;
+      if (false == GetRingLayout(frame, frameSizeBytes, header, slotCount, slotSizeBytes))
+        return false;
+
+      if (0 == frameNumber) return false;
+
+      const uint8_t* const slot =
+          &frame[kRingSlotOffset + (slotSizeBytes * (size_t)((frameNumber - 1) % slotCount))];
+      std::atomic_ref<uint32_t> slotFrameNumber(const_cast<uint32_t&>(
+          reinterpret_cast<const SRingSlotHeader*>(slot)->frameNumber));
+
+      if (frameNumber != slotFrameNumber.load(std::memory_order_acquire)) return false;
+
+      SRingSlotHeader slotHeader;
+      std::memcpy(&slotHeader, slot, sizeof(slotHeader));
+
+      if (0 != (slotHeader.flags & kRingSlotFlagDelta))
+      {
+        if (nullptr == previousFrameInput) return false;
+
+        frameInput = *previousFrameInput;
+        if (false ==
+            DecodeDeltaBlocks(
+                &slot[sizeof(SRingSlotHeader)],
+                slotSizeBytes - sizeof(SRingSlotHeader),
+                slotHeader.flags,
+                header.controllerCount,
+                frameInput))
+          return false;
+      }
+      else
+      {
+        frameInput = {};
+        DecodeBinaryBlocks(&slot[sizeof(SRingSlotHeader)], header.controllerCount, frameInput);
+      }
+
+      frameInput.timestamp = slotHeader.timestamp;
+      frameInput.captureTime = slotHeader.captureTime;
+
+      // If the producer started overwriting the slot while it was being decoded, the decoded input
+      // might be a mix of two different frames.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return (frameNumber == slotFrameNumber.load(std::memory_order_relaxed));
+    }
+
+    /// Reconstructs the complete input for a frame held in a ring payload, whether it is a full
+    /// frame or a delta frame. The most recent full frame at or before the requested frame is
+    /// located, and all of the delta frames that follow it are applied in order.
+    /// @param [in] frame Pointer to the start of the frame, including the header.
+    /// @param [in] frameSizeBytes Number of readable bytes starting at the frame pointer.
+    /// @param [in] header Frame header, already validated.
+    /// @param [in] frameNumber Number of the frame to reconstruct.
+    /// @param [out] frameInput Filled in with the input supplied by the frame. Might be partially
+    /// filled in on failure.
+    /// @return `true` if the frame was reconstructed, `false` if no full frame could be located or
+    /// if any of the frames needed for reconstruction could not be decoded.
+    static bool ReconstructRingFrame(
+        const uint8_t* frame,
+        size_t frameSizeBytes,
+        const SFrameHeader& header,
+        uint32_t frameNumber,
+        SFrameInput& frameInput)
+    {
+      uint32_t slotCount = 0;
+      size_t slotSizeBytes = 0;
+      if (false == GetRingLayout(frame, frameSizeBytes, header, slotCount, slotSizeBytes))
+        return false;
+
+      if (0 == frameNumber) return false;
+
+      const uint32_t oldestFrameNumber =
+          ((frameNumber > slotCount) ? (frameNumber - slotCount + 1) : 1);
+
+      uint32_t fullFrameNumber = frameNumber;
+      while (false ==
+             DecodeRingPayload(frame, frameSizeBytes, header, fullFrameNumber, nullptr, frameInput))
+      {
+        if (oldestFrameNumber == fullFrameNumber) return false;
+        fullFrameNumber -= 1;
+      }
+
+      for (uint32_t deltaFrameNumber = fullFrameNumber + 1; deltaFrameNumber <= frameNumber;
+           ++deltaFrameNumber)
+      {
+        const SFrameInput previousFrameInput = frameInput;
+        if (false ==
+            DecodeRingPayload(
+                frame, frameSizeBytes, header, deltaFrameNumber, &previousFrameInput, frameInput))
+          return false;
+      }
+
+      return true;
+    }
+
+    bool DecodeFrame(const void* frame, size_t frameSizeBytes, SFrameInput& frameInput)
+    {
+      const uint8_t* const frameBytes = reinterpret_cast<const uint8_t*>(frame);
+      bool decodeResult = false;
+
+      frameInput = {};
+
+      if ((nullptr == frame) || (0 == frameSizeBytes)) return false;
+
+      SFrameHeader header = {};
+      if (frameSizeBytes >= sizeof(header)) std::memcpy(&header, frameBytes, sizeof(header));
+
+      if (kFrameMagic != header.magic)
+      {
+        // Legacy frames consist entirely of JSON text.
+        decodeResult = ParseJsonFrame(
+            reinterpret_cast<const char*>(frameBytes), frameSizeBytes, frameInput);
+      }
+      else if (kFrameVersion == header.version)
+      {
+        switch (static_cast<EPayloadFormat>(header.payloadFormat))
+        {
+          case EPayloadFormat::Binary:
+            decodeResult = DecodeBinaryPayload(frameBytes, frameSizeBytes, header, frameInput);
+            break;
+
+          case EPayloadFormat::Json:
+            if ((size_t)header.payloadSizeBytes <= (frameSizeBytes - sizeof(header)))
+            {
+              decodeResult = ParseJsonFrame(
+                  reinterpret_cast<const char*>(&frameBytes[sizeof(header)]),
+                  (size_t)header.payloadSizeBytes,
+                  frameInput);
+            }
+            break;
+
+          case EPayloadFormat::Ring:
+            if (frameSizeBytes >= kRingSlotOffset)
+            {
+              decodeResult = ReconstructRingFrame(
+                  frameBytes,
+                  frameSizeBytes,
+                  header,
+                  GetRingWriteCount(frameBytes),
+                  frameInput);
+            }
+            break;
+
+          default:
+            break;
+        }
+      }
+
+      if (false == decodeResult) frameInput = {};
+
+      return decodeResult;
+    }
+
+    bool DecodeRingFrame(
+        const void* frame,
+        size_t frameSizeBytes,
+        uint32_t frameNumber,
+        const SFrameInput& previousFrameInput,
+        SFrameInput& frameInput)
+    {
+      const uint8_t* const frameBytes = reinterpret_cast<const uint8_t*>(frame);
+
+      frameInput = {};
+
+      if ((nullptr == frame) || (frameSizeBytes < sizeof(SFrameHeader))) return false;
+
+      SFrameHeader header;
+      std::memcpy(&header, frameBytes, sizeof(header));
+
+      if ((kFrameMagic != header.magic) || (kFrameVersion != header.version) ||
+          (EPayloadFormat::Ring != static_cast<EPayloadFormat>(header.payloadFormat)))
+        return false;
+
+      if (false ==
+          DecodeRingPayload(
+              frameBytes, frameSizeBytes, header, frameNumber, &previousFrameInput, frameInput))
+      {
+        frameInput = {};
+        return false;
+      }
+
+      return true;
+    }
+
+    uint32_t GetFrameGeneration(const void* frame, size_t frameSizeBytes)
+    {
+      if ((nullptr == frame) || (frameSizeBytes < sizeof(SFrameHeader))) return 0;
+
+      const SFrameHeader* const header = reinterpret_cast<const SFrameHeader*>(frame);
+      if (kFrameMagic != header->magic) return 0;
+
+      return std::atomic_ref<uint32_t>(const_cast<uint32_t&>(header->generation))
+          .load(std::memory_order_acquire);
+    }
+
+    uint32_t GetFrameInstanceIdentifier(const void* frame, size_t frameSizeBytes)
+    {
+      if ((nullptr == frame) || (frameSizeBytes < sizeof(SFrameHeader))) return 0;
+
+      const SFrameHeader* const header = reinterpret_cast<const SFrameHeader*>(frame);
+      if (kFrameMagic != header->magic) return 0;
+
+      return std::atomic_ref<uint32_t>(const_cast<uint32_t&>(header->instanceIdentifier))
+          .load(std::memory_order_relaxed);
+    }
+
+    /// Reads the next unread frame from a ring payload in a channel's shared memory mapping and
+    /// decodes it. Frames that were already overwritten by the time they are read are skipped.
+    /// Delta frames are applied on top of the previously-read frame, and if that frame is not
+    /// available, they are skipped until the next full frame. If there is no such full frame,
+    /// input is instead reconstructed for the most recent frame.
+    /// @param [in,out] channel Channel from which to read, with its mapping already open.
+    /// @param [in] header Frame header, already validated.
+    /// @param [in,out] frameInput On output, filled in with the newly-decoded input if a frame was
+    /// decoded, otherwise left unmodified.
+    /// @return `true` if a frame was decoded, `false` if there are no unread frames.
+    static bool ReadRingFrame(
+        SChannel& channel, const SFrameHeader& header, SFrameInput& frameInput)
+    {
+      const uint8_t* const frameBytes = reinterpret_cast<const uint8_t*>(channel.mappingView);
+      const uint32_t writeCount = GetRingWriteCount(frameBytes);
+
+      // When a ring is first examined, only its most recent frame is read. Any older frames were
+      // written before Xidi started reading them.
+      if ((false == channel.lastFrameValid) ||
+          (header.instanceIdentifier != channel.lastFrameInstanceIdentifier))
+      {
+        channel.lastFrameInstanceIdentifier = header.instanceIdentifier;
+        channel.lastFrameGeneration = 0;
+        channel.lastFrameValid = true;
+        channel.lastRingFrameNumber = ((0 == writeCount) ? 0 : (writeCount - 1));
+        channel.lastRingFrameInputValid = false;
+      }
+
+      uint32_t slotCount = 0;
+      size_t slotSizeBytes = 0;
+      if (false ==
+          GetRingLayout(
+              frameBytes, channel.mappingViewSizeBytes, header, slotCount, slotSizeBytes))
+        return false;
+
+      bool framesSkipped = false;
+      SFrameInput newFrameInput = {};
+
+      while (writeCount != channel.lastRingFrameNumber)
+      {
+        // Frames more than one ring's worth older than the most recent frame have been overwritten,
+        // so any delta frames that follow them cannot be applied.
+        if ((writeCount - channel.lastRingFrameNumber) > slotCount)
+        {
+          channel.lastRingFrameNumber = writeCount - slotCount;
+          channel.lastRingFrameInputValid = false;
+        }
+
+        channel.lastRingFrameNumber += 1;
+
+        if (true ==
+            DecodeRingPayload(
+                frameBytes,
+                channel.mappingViewSizeBytes,
+                header,
+                channel.lastRingFrameNumber,
+                ((true == channel.lastRingFrameInputValid) ? &channel.lastRingFrameInput : nullptr),
+                newFrameInput))
+        {
+          channel.lastRingFrameInput = newFrameInput;
+          channel.lastRingFrameInputValid = true;
+
+          frameInput = newFrameInput;
+          return true;
+        }
+
+        channel.lastRingFrameInputValid = false;
+        framesSkipped = true;
+      }
+
+      // Skipping delta frames until the producer next writes a full frame would leave the input
+      // stale in the meantime, so the most recent frame is reconstructed instead, if possible.
+      if ((true == framesSkipped) &&
+          (true ==
+           ReconstructRingFrame(
+               frameBytes, channel.mappingViewSizeBytes, header, writeCount, newFrameInput)))
+      {
+        channel.lastRingFrameInput = newFrameInput;
+        channel.lastRingFrameInputValid = true;
+
+        frameInput = newFrameInput;
+        return true;
+      }
+
+      return false;
+    }
+
+    /// Reads the frame that a producer most recently wrote to a channel's shared memory mapping,
+    /// for any payload that holds only a single frame, and decodes it if it changed.
+    /// @param [in,out] channel Channel from which to read, with its mapping already open.
+    /// @param [in,out] frameInput On output, filled in with the newly-decoded input if a new frame
+    /// was decoded, otherwise left unmodified.
+    /// @return `true` if a new frame was decoded, `false` otherwise.
+    static bool ReadSingleFrame(SChannel& channel, SFrameInput& frameInput)
+    {
+      const uint32_t instanceIdentifier =
+          GetFrameInstanceIdentifier(channel.mappingView, channel.mappingViewSizeBytes);
+      const uint32_t generation =
+          GetFrameGeneration(channel.mappingView, channel.mappingViewSizeBytes);
+
+      const bool lastFrameIsCurrent =
+          ((true == channel.lastFrameValid) && (0 != generation) &&
+           (generation == channel.lastFrameGeneration) &&
+           (instanceIdentifier == channel.lastFrameInstanceIdentifier));
+      if (true == lastFrameIsCurrent) return false;
+
+      // An odd generation number means the producer is in the middle of writing a frame, in which
+      // case the previously-decoded input continues to be used.
+      if (0 != (generation & 1)) return false;
+
+      SFrameInput newFrameInput = {};
+      const bool decodeResult =
+          DecodeFrame(channel.mappingView, channel.mappingViewSizeBytes, newFrameInput);
+
+      // Decoded input is kept only if the producer did not start writing a new frame while it was
+      // being decoded. Otherwise it might be a mix of old and new frame contents.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (generation != GetFrameGeneration(channel.mappingView, channel.mappingViewSizeBytes))
+        return false;
+
+      // Frames without a generation counter are decoded every time, but they are only reported
+      // as new if their contents changed.
+      const bool unversionedFrameIsCurrent =
+          ((true == channel.lastFrameValid) && (0 == generation) &&
+           (newFrameInput == channel.lastUnversionedFrameInput));
+
+      channel.lastFrameInstanceIdentifier = instanceIdentifier;
+      channel.lastFrameGeneration = generation;
+      channel.lastFrameValid = true;
+
+      if ((false == decodeResult) || (true == unversionedFrameIsCurrent)) return false;
+
+      if (0 == generation) channel.lastUnversionedFrameInput = newFrameInput;
+
+      frameInput = newFrameInput;
+      return true;
+    }
+
+    /// Reads the next new frame that a producer wrote to a channel's shared memory mapping and
+    /// decodes it. The mapping is opened on first use and re-opened only if the producer restarts.
+    /// @param [in,out] channel Channel from which to read.
+    /// @param [in,out] frameInput On output, filled in with the newly-decoded input if a new frame
+    /// was decoded, otherwise left unmodified.
+    /// @return `true` if a new frame was decoded, `false` otherwise.
+    static bool ReadChannelFrame(SChannel& channel, SFrameInput& frameInput)
+    {
+      if (true == MappingViewNeedsRefresh(channel)) OpenMappingView(channel);
+      if (nullptr == channel.mappingView) return false;
+
+      SFrameHeader header = {};
+      if (channel.mappingViewSizeBytes >= sizeof(header))
+        std::memcpy(&header, channel.mappingView, sizeof(header));
+
+      if ((kFrameMagic == header.magic) && (kFrameVersion == header.version) &&
+          (EPayloadFormat::Ring == static_cast<EPayloadFormat>(header.payloadFormat)))
+        return ReadRingFrame(channel, header, frameInput);
+
+      return ReadSingleFrame(channel, frameInput);
+    }
+
+    void DrainMouseMotion(SKeyboardMouseInput& keyboardMouseInput, SMouseMotionCursor& cursor)
+    {
+      for (int axis = 0; axis < static_cast<int>(Mouse::EMouseAxis::Count); ++axis)
+      {
+        if (false == keyboardMouseInput.mouseMotionPresent[axis]) continue;
+
+        const int32_t total = keyboardMouseInput.mouseMotion[axis];
+        const int32_t motion =
+            ((true == cursor.valid[axis])
+                 ? static_cast<int32_t>(
+                       static_cast<uint32_t>(total) - static_cast<uint32_t>(cursor.total[axis]))
+                 : 0);
+
+        cursor.valid[axis] = true;
+        cursor.total[axis] = total;
+
+        keyboardMouseInput.mouseMotionPresent[axis] = (0 != motion);
+        keyboardMouseInput.mouseMotion[axis] = motion;
+      }
+    }
+
+    std::optional<EMergePolicy> MergePolicyFromString(std::wstring_view policyString)
+    {
+      static constexpr std::pair<std::wstring_view, EMergePolicy> kMergePolicyStrings[] = {
+          {L"Priority", EMergePolicy::Priority},
+          {L"Or", EMergePolicy::Or},
+          {L"Sum", EMergePolicy::Sum},
+          {L"Max", EMergePolicy::Max}};
+
+      for (const auto& mergePolicyString : kMergePolicyStrings)
+      {
+        if (true == Strings::EqualsCaseInsensitive(mergePolicyString.first, policyString))
+          return mergePolicyString.second;
+      }
+
+      return std::nullopt;
+    }
+
+    const SMergePolicy& GetMergePolicy(void)
+    {
+      InitializeChannelsIfNeeded();
+      return mergePolicy;
+    }
+
+    void MergeFrameInputs(
+        const SFrameInput* channelFrameInputs,
+        unsigned int channelFrameInputCount,
+        const SMergePolicy& mergePolicy,
+        SFrameInput& mergedFrameInput)
+    {
+      mergedFrameInput = {};
+
+      for (int controllerIdentifier = 0;
+           controllerIdentifier < static_cast<int>(mergedFrameInput.controller.size());
+           ++controllerIdentifier)
+      {
+        Controller::SStateOverlay& mergedOverlay =
+            mergedFrameInput.controller[controllerIdentifier];
+
+        for (int axis = 0; axis < static_cast<int>(Controller::EAxis::Count); ++axis)
+        {
+          int64_t displacementSum = 0;
+
+          for (unsigned int i = 0; i < channelFrameInputCount; ++i)
+          {
+            const Controller::SStateOverlay& overlay =
+                channelFrameInputs[i].controller[controllerIdentifier];
+            if (false == overlay.axisPresent[axis]) continue;
+
+            const int32_t value = overlay.values.axis[axis];
+            const bool isFirstValue = (false == mergedOverlay.axisPresent[axis]);
+            mergedOverlay.axisPresent[axis] = true;
+
+            switch (mergePolicy.axis[axis])
+            {
+              case EMergePolicy::Sum:
+                displacementSum += ((int64_t)value - (int64_t)Controller::kAnalogValueNeutral);
+                break;
+
+              case EMergePolicy::Max:
+                if ((true == isFirstValue) ||
+                    (std::abs((int64_t)value - (int64_t)Controller::kAnalogValueNeutral) >
+                     std::abs(
+                         (int64_t)mergedOverlay.values.axis[axis] -
+                         (int64_t)Controller::kAnalogValueNeutral)))
+                  mergedOverlay.values.axis[axis] = value;
+                break;
+
+              default:
+                if (true == isFirstValue) mergedOverlay.values.axis[axis] = value;
+                break;
+            }
+          }
+
+          if ((EMergePolicy::Sum == mergePolicy.axis[axis]) &&
+              (true == mergedOverlay.axisPresent[axis]))
+            mergedOverlay.values.axis[axis] = (int32_t)std::clamp(
+                (int64_t)Controller::kAnalogValueNeutral + displacementSum,
+                (int64_t)Controller::kAnalogValueMin,
+                (int64_t)Controller::kAnalogValueMax);
+        }
+
+        // Buttons and POV directions supplied by a channel are merged all at once. With the
+        // priority policy, each channel only contributes the elements that no higher-priority
+        // channel supplied.
+        for (unsigned int i = 0; i < channelFrameInputCount; ++i)
+        {
+          const Controller::SStateOverlay& overlay =
+              channelFrameInputs[i].controller[controllerIdentifier];
+
+          const auto buttonsContributed =
+              ((EMergePolicy::Priority == mergePolicy.button)
+                   ? (overlay.buttonPresent & ~mergedOverlay.buttonPresent)
+                   : overlay.buttonPresent);
+          mergedOverlay.values.button |= (overlay.values.button & buttonsContributed);
+          mergedOverlay.buttonPresent |= overlay.buttonPresent;
+
+          for (int povDirection = 0;
+               povDirection < static_cast<int>(Controller::EPovDirection::Count);
+               ++povDirection)
+          {
+            if (false == overlay.povDirectionPresent[povDirection]) continue;
+
+            if ((EMergePolicy::Priority != mergePolicy.button) ||
+                (false == mergedOverlay.povDirectionPresent[povDirection]))
+              mergedOverlay.values.povDirection.components[povDirection] =
+                  (mergedOverlay.values.povDirection.components[povDirection] ||
+                   overlay.values.povDirection.components[povDirection]);
+
+            mergedOverlay.povDirectionPresent[povDirection] = true;
+          }
+        }
+      }
+
+      SKeyboardMouseInput& mergedKeyboardMouseInput = mergedFrameInput.keyboardMouse;
+
+      for (unsigned int i = 0; i < channelFrameInputCount; ++i)
+      {
+        const SKeyboardMouseInput& keyboardMouseInput = channelFrameInputs[i].keyboardMouse;
+
+        mergedKeyboardMouseInput.keyPressed |= keyboardMouseInput.keyPressed;
+        mergedKeyboardMouseInput.keyReleased |= keyboardMouseInput.keyReleased;
+
+        if (true == keyboardMouseInput.keyStatePresent)
+        {
+          mergedKeyboardMouseInput.keyStatePresent = true;
+          for (unsigned int word = 0; word < kKeyStateWordCount; ++word)
+            mergedKeyboardMouseInput.keyState[word] |= keyboardMouseInput.keyState[word];
+        }
+
+        mergedKeyboardMouseInput.mouseButtonPresent |= keyboardMouseInput.mouseButtonPresent;
+        mergedKeyboardMouseInput.mouseButtonPressed |=
+            (keyboardMouseInput.mouseButtonPressed & keyboardMouseInput.mouseButtonPresent);
+        mergedKeyboardMouseInput.mouseMovementPresent |= keyboardMouseInput.mouseMovementPresent;
+
+        mergedKeyboardMouseInput.mouseMotionPresent |= keyboardMouseInput.mouseMotionPresent;
+
+        for (int axis = 0; axis < static_cast<int>(Mouse::EMouseAxis::Count); ++axis)
+        {
+          if (true == keyboardMouseInput.mouseMovementPresent[axis])
+            mergedKeyboardMouseInput.mouseMovement[axis] += keyboardMouseInput.mouseMovement[axis];
+
+          if (true == keyboardMouseInput.mouseMotionPresent[axis])
+            mergedKeyboardMouseInput.mouseMotion[axis] += keyboardMouseInput.mouseMotion[axis];
+        }
+      }
+    }
+
+    bool ReadFrame(SFrameInput& frameInput)
+    {
+      InitializeChannelsIfNeeded();
+
+      for (unsigned int i = 0; i < channelCount; ++i)
+      {
+        const unsigned int channelIndex = ((nextChannelIndex + i) % channelCount);
+        if (false == ReadChannelFrame(channels[channelIndex], channelFrameInput[channelIndex]))
+          continue;
+
+        nextChannelIndex = ((channelIndex + 1) % channelCount);
+
+        SKeyboardMouseInput& channelKeyboardMouseInput =
+            channelFrameInput[channelIndex].keyboardMouse;
+        DrainMouseMotion(channelKeyboardMouseInput, channels[channelIndex].mouseMotionCursor);
+
+        // With only one channel there is nothing to merge.
+        if (1 == channelCount)
+        {
+          frameInput = channelFrameInput[channelIndex];
+        }
+        else
+        {
+          MergeFrameInputs(channelFrameInput, channelCount, mergePolicy, frameInput);
+          frameInput.timestamp = channelFrameInput[channelIndex].timestamp;
+          frameInput.captureTime = channelFrameInput[channelIndex].captureTime;
+        }
+
+        // Relative mouse motion is passed on exactly once, so it is not retained for merging with
+        // frames that other channels supply later.
+        channelKeyboardMouseInput.mouseMotionPresent.reset();
+        channelKeyboardMouseInput.mouseMotion = {};
+
+        return true;
+      }
+
+      return false;
+    }
+
+    bool WaitForFrameSignal(
+        unsigned int timeoutMilliseconds,
+        std::initializer_list<HANDLE> additionalSignalEventHandles)
+    {
+      InitializeChannelsIfNeeded();
+
+      HANDLE signalEventHandles[kMaxChannelCount + kMaxAdditionalSignalEventCount] = {};
+      DWORD signalEventHandleCount = 0;
+
+      for (HANDLE additionalSignalEventHandle : additionalSignalEventHandles)
+      {
+        if (signalEventHandleCount >= kMaxAdditionalSignalEventCount) break;
+        if (nullptr != additionalSignalEventHandle)
+          signalEventHandles[signalEventHandleCount++] = additionalSignalEventHandle;
+      }
+
+      for (unsigned int i = 0; i < channelCount; ++i)
+      {
+        OpenSignalEventIfNeeded(channels[i]);
+        if (nullptr != channels[i].signalEventHandle)
+          signalEventHandles[signalEventHandleCount++] = channels[i].signalEventHandle;
+      }
+
+      if (0 == signalEventHandleCount)
+      {
+        Sleep(timeoutMilliseconds);
+        return false;
+      }
+
+      const DWORD waitResult = WaitForMultipleObjects(
+          signalEventHandleCount, signalEventHandles, FALSE, timeoutMilliseconds);
+      return (
+          (waitResult >= WAIT_OBJECT_0) &&
+          (waitResult < (WAIT_OBJECT_0 + signalEventHandleCount)));
+    }
+
+    /// Converts a set of keys held as a bitset into a bitmap of 64-bit words, so that it can be
+    /// scanned a word at a time.
+    /// @param [in] keys Set of keys to convert.
+    /// @return Bitmap holding the same set of keys.
+    static TKeyStateBitmap KeyBitmapFromBitset(
+        const std::bitset<Keyboard::kVirtualKeyboardKeyCount>& keys)
+    {
+      static const std::bitset<Keyboard::kVirtualKeyboardKeyCount> kWordMask(~0ull);
+
+      TKeyStateBitmap keyBitmap;
+      for (unsigned int word = 0; word < kKeyStateWordCount; ++word)
+        keyBitmap[word] = ((keys >> (word * 64)) & kWordMask).to_ullong();
+
+      return keyBitmap;
+    }
+
+    /// Invokes a function once for each key in a bitmap, in ascending order of key identifier.
+    /// Each word is scanned only for the bits that are set, so the cost is proportional to the
+    /// number of keys in the bitmap.
+    /// @tparam KeyFunctionType Type of function to invoke, which accepts a key identifier.
+    /// @param [in] keyBitmap Bitmap of keys to visit.
+    /// @param [in] keyFunction Function to invoke for each key.
+    template <typename KeyFunctionType> static inline void ForEachKeyInBitmap(
+        const TKeyStateBitmap& keyBitmap, KeyFunctionType keyFunction)
+    {
+      for (unsigned int word = 0; word < kKeyStateWordCount; ++word)
+      {
+        uint64_t remainingKeys = keyBitmap[word];
+
+        while (0 != remainingKeys)
+        {
+          const unsigned int bit = static_cast<unsigned int>(std::countr_zero(remainingKeys));
+          remainingKeys &= (remainingKeys - 1);
+          keyFunction(static_cast<Keyboard::TKeyIdentifier>((word * 64) + bit));
+        }
+      }
+    }
+
+    void SubmitKeyboardMouseInput(
+        const SKeyboardMouseInput& keyboardMouseInput,
+        const SKeyboardMouseInput& previousKeyboardMouseInput)
+    {
+      static constexpr TKeyStateBitmap kKeyStateNonePressed = {};
+
+      const TKeyStateBitmap& keyState =
+          ((true == keyboardMouseInput.keyStatePresent) ? keyboardMouseInput.keyState
+                                                        : kKeyStateNonePressed);
+      const TKeyStateBitmap& previousKeyState =
+          ((true == previousKeyboardMouseInput.keyStatePresent)
+               ? previousKeyboardMouseInput.keyState
+               : kKeyStateNonePressed);
+
+      // Keys whose states did not change were already submitted, so each word of the key state is
+      // scanned only for the bits that differ.
+      TKeyStateBitmap transitionedKeys;
+      for (unsigned int word = 0; word < kKeyStateWordCount; ++word)
+        transitionedKeys[word] = (keyState[word] ^ previousKeyState[word]);
+
+      ForEachKeyInBitmap(
+          transitionedKeys,
+          [&keyState](Keyboard::TKeyIdentifier key) -> void
+          {
+            if (0 != (keyState[key / 64] & (1ull << (key % 64))))
+              Keyboard::SubmitKeyPressedState(key);
+            else
+              Keyboard::SubmitKeyReleasedState(key);
+          });
+
+      if (true == keyboardMouseInput.keyPressed.any())
+        ForEachKeyInBitmap(
+            KeyBitmapFromBitset(keyboardMouseInput.keyPressed), Keyboard::SubmitKeyPressedState);
+
+      if (true == keyboardMouseInput.keyReleased.any())
+        ForEachKeyInBitmap(
+            KeyBitmapFromBitset(keyboardMouseInput.keyReleased), Keyboard::SubmitKeyReleasedState);
+
+      for (int i = 0; i < static_cast<int>(Mouse::EMouseButton::Count); ++i)
+      {
+        if (false == keyboardMouseInput.mouseButtonPresent[i]) continue;
+
+        if (true == keyboardMouseInput.mouseButtonPressed[i])
+          Mouse::SubmitMouseButtonPressedState(static_cast<Mouse::EMouseButton>(i));
+        else
+          Mouse::SubmitMouseButtonReleasedState(static_cast<Mouse::EMouseButton>(i));
+      }
+
+      for (int i = 0; i < static_cast<int>(Mouse::EMouseAxis::Count); ++i)
+      {
+        if (false == keyboardMouseInput.mouseMovementPresent[i]) continue;
+
+        Mouse::SubmitMouseMovement(
+            static_cast<Mouse::EMouseAxis>(i), keyboardMouseInput.mouseMovement[i], 0);
+      }
+    }
+
+    void SubmitMouseMotion(SKeyboardMouseInput& keyboardMouseInput)
+    {
+      for (int i = 0; i < static_cast<int>(Mouse::EMouseAxis::Count); ++i)
+      {
+        if (false == keyboardMouseInput.mouseMotionPresent[i]) continue;
+
+        Mouse::SubmitMouseRelativeMovement(
+            static_cast<Mouse::EMouseAxis>(i), keyboardMouseInput.mouseMotion[i]);
+      }
+
+      keyboardMouseInput.mouseMotionPresent.reset();
+      keyboardMouseInput.mouseMotion = {};
+    }
+  } // namespace SharedMemory
+} // namespace Xidi
@@ -0,0 +1,838 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file SharedMemoryJson.cpp
+ *   Implementation of a parser for the JSON format that external producers can use to supply
+ *   input via shared memory.
+ **************************************************************************************************/
+
+#include "SharedMemoryJson.h"
+
+#include <array>
+#include <bitset>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "Keyboard.h"
+#include "Mouse.h"
+#include "SharedMemoryTypes.h"
+
+namespace Xidi
+{
+  namespace SharedMemory
+  {
+    /// Names of the JSON object members that hold axis values, in axis enumeration order.
+    static constexpr std::string_view kJsonAxisNames[] = {
+        "X", "Y", "Z", "RotX", "RotY", "RotZ", "Slider", "Dial"};
+    static_assert(
+        _countof(kJsonAxisNames) == static_cast<int>(Controller::EAxis::Count),
+        "Axis name list is out of sync with the axis enumeration.");
+
+    /// Names of the JSON object members that hold POV direction states, in POV direction
+    /// enumeration order.
+    static constexpr std::string_view kJsonPovDirectionNames[] = {"Up", "Down", "Left", "Right"};
+    static_assert(
+        _countof(kJsonPovDirectionNames) == static_cast<int>(Controller::EPovDirection::Count),
+        "POV direction name list is out of sync with the POV direction enumeration.");
+
+    /// Names of the JSON object members that hold mouse button states, in mouse button
+    /// enumeration order.
+    static constexpr std::string_view kJsonMouseButtonNames[] = {
+        "left", "middle", "right", "x1", "x2"};
+    static_assert(
+        _countof(kJsonMouseButtonNames) == static_cast<int>(Mouse::EMouseButton::Count),
+        "Mouse button name list is out of sync with the mouse button enumeration.");
+
+    /// Names of the JSON object members that hold mouse movement values, in mouse axis enumeration
+    /// order.
+    static constexpr std::string_view kJsonMouseAxisNames[] = {"x", "y", "wheelX", "wheelY"};
+    static_assert(
+        _countof(kJsonMouseAxisNames) == static_cast<int>(Mouse::EMouseAxis::Count),
+        "Mouse axis name list is out of sync with the mouse axis enumeration.");
+
+    /// Type used to hold the name of a JSON object member that holds a button state.
+    using TJsonButtonName = std::array<char, 5>;
+
+    /// Generates the names of the JSON object members that hold button states, which are "b1"
+    /// through "b128" in button enumeration order.
+    /// @return Array of null-terminated button names.
+    static constexpr std::array<TJsonButtonName, static_cast<int>(Controller::EButton::Count)>
+        GenerateJsonButtonNames(void)
+    {
+      std::array<TJsonButtonName, static_cast<int>(Controller::EButton::Count)> buttonNames = {};
+
+      for (unsigned int i = 0; i < buttonNames.size(); ++i)
+      {
+        const unsigned int buttonNumber = (i + 1);
+        unsigned int nameLength = 0;
+
+        buttonNames[i][nameLength++] = 'b';
+        if (buttonNumber >= 100) buttonNames[i][nameLength++] = (char)('0' + (buttonNumber / 100));
+        if (buttonNumber >= 10)
+          buttonNames[i][nameLength++] = (char)('0' + ((buttonNumber / 10) % 10));
+        buttonNames[i][nameLength++] = (char)('0' + (buttonNumber % 10));
+      }
+
+      return buttonNames;
+    }
+
+    /// Names of the JSON object members that hold button states, in button enumeration order.
+    static constexpr auto kJsonButtonNames = GenerateJsonButtonNames();
+
+    /// Holds the definition of a JSON object member that the parser recognizes.
+    struct SJsonKeyDefinition
+    {
+      /// Object member name.
+      std::string_view name;
+
+      /// Identification of the object member.
+      SJsonKey key;
+    };
+
+    /// Number of JSON object member names that the parser recognizes. Named members that are not
+    /// part of a name list are the keyboard and mouse objects, the pressed and released key
+    /// arrays, and the mouse movement and motion flags.
+    static constexpr unsigned int kJsonKeyCount = _countof(kJsonAxisNames) +
+        kJsonButtonNames.size() + _countof(kJsonPovDirectionNames) +
+        _countof(kJsonMouseButtonNames) + _countof(kJsonMouseAxisNames) + 6;
+
+    /// Generates the definitions of all JSON object members that the parser recognizes.
+    /// @return Array of object member definitions.
+    static constexpr std::array<SJsonKeyDefinition, kJsonKeyCount> GenerateJsonKeyDefinitions(void)
+    {
+      std::array<SJsonKeyDefinition, kJsonKeyCount> keyDefinitions = {};
+      unsigned int keyCount = 0;
+
+      for (unsigned int i = 0; i < _countof(kJsonAxisNames); ++i)
+        keyDefinitions[keyCount++] = {kJsonAxisNames[i], {EJsonKeyType::Axis, (uint8_t)i}};
+
+      for (unsigned int i = 0; i < kJsonButtonNames.size(); ++i)
+        keyDefinitions[keyCount++] = {
+            kJsonButtonNames[i].data(), {EJsonKeyType::Button, (uint8_t)i}};
+
+      for (unsigned int i = 0; i < _countof(kJsonPovDirectionNames); ++i)
+        keyDefinitions[keyCount++] = {
+            kJsonPovDirectionNames[i], {EJsonKeyType::PovDirection, (uint8_t)i}};
+
+      for (unsigned int i = 0; i < _countof(kJsonMouseButtonNames); ++i)
+        keyDefinitions[keyCount++] = {
+            kJsonMouseButtonNames[i], {EJsonKeyType::MouseButton, (uint8_t)i}};
+
+      for (unsigned int i = 0; i < _countof(kJsonMouseAxisNames); ++i)
+        keyDefinitions[keyCount++] = {
+            kJsonMouseAxisNames[i], {EJsonKeyType::MouseAxis, (uint8_t)i}};
+
+      keyDefinitions[keyCount++] = {"keyboard", {EJsonKeyType::Keyboard, 0}};
+      keyDefinitions[keyCount++] = {"mouse", {EJsonKeyType::Mouse, 0}};
+      keyDefinitions[keyCount++] = {"pressed", {EJsonKeyType::KeyboardPressed, 0}};
+      keyDefinitions[keyCount++] = {"released", {EJsonKeyType::KeyboardReleased, 0}};
+      keyDefinitions[keyCount++] = {"mouseMove", {EJsonKeyType::MouseMove, 0}};
+      keyDefinitions[keyCount++] = {"mouseMotion", {EJsonKeyType::MouseMotion, 0}};
+
+      return keyDefinitions;
+    }
+
+    /// Definitions of all JSON object members that the parser recognizes.
+    static constexpr auto kJsonKeyDefinitions = GenerateJsonKeyDefinitions();
+
+    /// Number of buckets in the first level of the perfect hash table. Must be a power of two.
+    static constexpr unsigned int kJsonKeyBucketCount = 64;
+
+    /// Number of slots in the second level of the perfect hash table. Must be a power of two.
+    static constexpr unsigned int kJsonKeySlotCount = 256;
+
+    /// Value of a perfect hash table slot that does not hold any object member.
+    static constexpr uint8_t kJsonKeySlotEmpty = UINT8_MAX;
+
+    /// Upper bound on the displacement values to try for each bucket when generating the perfect
+    /// hash table.
+    static constexpr uint32_t kJsonKeyDisplacementLimit = 4096;
+
+    static_assert(
+        0 == (kJsonKeyBucketCount & (kJsonKeyBucketCount - 1)),
+        "JSON key bucket count must be a power of two.");
+    static_assert(
+        0 == (kJsonKeySlotCount & (kJsonKeySlotCount - 1)),
+        "JSON key slot count must be a power of two.");
+    static_assert(
+        (kJsonKeyCount < kJsonKeySlotEmpty) && (kJsonKeyCount <= kJsonKeySlotCount),
+        "Too many JSON keys for the perfect hash table.");
+
+    /// Perfect hash table for looking up JSON object member names. Uses the "hash and displace"
+    /// technique: names are first grouped into buckets, and each bucket is assigned a
+    /// displacement value that causes all of its names to land in distinct unused slots.
+    struct SJsonKeyTable
+    {
+      /// Displacement value for each bucket.
+      std::array<uint32_t, kJsonKeyBucketCount> displacement;
+
+      /// Index into the object member definitions for each slot.
+      std::array<uint8_t, kJsonKeySlotCount> slot;
+
+      /// Whether or not a displacement value was successfully found for every bucket.
+      bool valid;
+    };
+
+    /// Computes the hash of a JSON object member name using the 64-bit FNV-1a function followed by
+    /// a finalizer step. FNV-1a alone leaves the upper bits poorly mixed for short names that
+    /// differ only in their last few characters, such as button names.
+    /// @param [in] name Object member name to hash.
+    /// @return Hash of the object member name.
+    static constexpr uint64_t HashJsonKeyName(std::string_view name)
+    {
+      uint64_t hash = 14695981039346656037ull;
+
+      for (const char c : name)
+      {
+        hash ^= (uint64_t)(uint8_t)c;
+        hash *= 1099511628211ull;
+      }
+
+      hash ^= (hash >> 33);
+      hash *= 0xff51afd7ed558ccdull;
+      hash ^= (hash >> 33);
+
+      return hash;
+    }
+
+    /// Selects the perfect hash table bucket for a JSON object member name.
+    /// @param [in] hash Hash of the object member name.
+    /// @return Bucket index.
+    static constexpr unsigned int JsonKeyBucket(uint64_t hash)
+    {
+      return (unsigned int)(hash >> 32) & (kJsonKeyBucketCount - 1);
+    }
+
+    /// Selects the perfect hash table slot for a JSON object member name.
+    /// @param [in] hash Hash of the object member name.
+    /// @param [in] displacement Displacement value of the bucket that holds the name.
+    /// @return Slot index.
+    static constexpr unsigned int JsonKeySlot(uint64_t hash, uint32_t displacement)
+    {
+      uint32_t mixedHash = (uint32_t)hash ^ (displacement * 0x9e3779b9u);
+
+      mixedHash ^= (mixedHash >> 16);
+      mixedHash *= 0x85ebca6bu;
+      mixedHash ^= (mixedHash >> 13);
+      mixedHash *= 0xc2b2ae35u;
+      mixedHash ^= (mixedHash >> 16);
+
+      return mixedHash & (kJsonKeySlotCount - 1);
+    }
+
+    /// Generates the perfect hash table for looking up JSON object member names.
+    /// @return Perfect hash table.
+    static constexpr SJsonKeyTable GenerateJsonKeyTable(void)
+    {
+      SJsonKeyTable keyTable = {};
+      keyTable.slot.fill(kJsonKeySlotEmpty);
+
+      // Group names by bucket so that each bucket can be placed without looking at all the names.
+      std::array<uint64_t, kJsonKeyCount> keyHash = {};
+      std::array<unsigned int, kJsonKeyBucketCount + 1> bucketStart = {};
+      std::array<unsigned int, kJsonKeyBucketCount> bucketSize = {};
+      std::array<uint8_t, kJsonKeyCount> bucketKeys = {};
+
+      for (unsigned int i = 0; i < kJsonKeyCount; ++i)
+      {
+        keyHash[i] = HashJsonKeyName(kJsonKeyDefinitions[i].name);
+        bucketStart[JsonKeyBucket(keyHash[i]) + 1] += 1;
+      }
+
+      for (unsigned int bucket = 0; bucket < kJsonKeyBucketCount; ++bucket)
+        bucketStart[bucket + 1] += bucketStart[bucket];
+
+      unsigned int bucketSizeMax = 0;
+      for (unsigned int i = 0; i < kJsonKeyCount; ++i)
+      {
+        const unsigned int bucket = JsonKeyBucket(keyHash[i]);
+
+        bucketKeys[bucketStart[bucket] + bucketSize[bucket]] = (uint8_t)i;
+        bucketSize[bucket] += 1;
+        if (bucketSize[bucket] > bucketSizeMax) bucketSizeMax = bucketSize[bucket];
+      }
+
+      // Larger buckets are harder to place once the table starts filling up, so they go first.
+      for (unsigned int size = bucketSizeMax; size > 0; --size)
+      {
+        for (unsigned int bucket = 0; bucket < kJsonKeyBucketCount; ++bucket)
+        {
+          if (size != bucketSize[bucket]) continue;
+
+          bool bucketPlaced = false;
+
+          for (uint32_t displacement = 0;
+               (false == bucketPlaced) && (displacement < kJsonKeyDisplacementLimit);
+               ++displacement)
+          {
+            unsigned int placedCount = 0;
+
+            for (; placedCount < size; ++placedCount)
+            {
+              const uint8_t key = bucketKeys[bucketStart[bucket] + placedCount];
+              const unsigned int slot = JsonKeySlot(keyHash[key], displacement);
+
+              if (kJsonKeySlotEmpty != keyTable.slot[slot]) break;
+              keyTable.slot[slot] = key;
+            }
+
+            if (size == placedCount)
+            {
+              keyTable.displacement[bucket] = displacement;
+              bucketPlaced = true;
+            }
+            else
+            {
+              for (unsigned int i = 0; i < placedCount; ++i)
+              {
+                const uint8_t key = bucketKeys[bucketStart[bucket] + i];
+                keyTable.slot[JsonKeySlot(keyHash[key], displacement)] = kJsonKeySlotEmpty;
+              }
+            }
+          }
+
+          if (false == bucketPlaced) return keyTable;
+        }
+      }
+
+      keyTable.valid = true;
+      return keyTable;
+    }
+
+    /// Perfect hash table for looking up JSON object member names.
+    static constexpr SJsonKeyTable kJsonKeyTable = GenerateJsonKeyTable();
+    static_assert(
+        true == kJsonKeyTable.valid, "Failed to generate the JSON key perfect hash table.");
+
+    /// Looks up a JSON object member name in the perfect hash table.
+    /// @param [in] name Object member name to look up.
+    /// @return Identification of the object member if the name is recognized, or no value
+    /// otherwise.
+    static constexpr std::optional<SJsonKey> FindJsonKey(std::string_view name)
+    {
+      const uint64_t hash = HashJsonKeyName(name);
+      const uint8_t keyIndex =
+          kJsonKeyTable.slot[JsonKeySlot(hash, kJsonKeyTable.displacement[JsonKeyBucket(hash)])];
+
+      if ((kJsonKeySlotEmpty == keyIndex) || (name != kJsonKeyDefinitions[keyIndex].name))
+        return std::nullopt;
+
+      return kJsonKeyDefinitions[keyIndex].key;
+    }
+
+    /// Verifies that every JSON object member name that the parser recognizes is found in the
+    /// perfect hash table.
+    /// @return `true` if all names are found and identified correctly, `false` otherwise.
+    static constexpr bool VerifyJsonKeyTable(void)
+    {
+      for (const auto& keyDefinition : kJsonKeyDefinitions)
+      {
+        if (FindJsonKey(keyDefinition.name) != keyDefinition.key) return false;
+      }
+
+      return true;
+    }
+
+    static_assert(true == VerifyJsonKeyTable(), "JSON key perfect hash table is inconsistent.");
+
+    /// Tracks the position of the parser within JSON text.
+    struct SJsonCursor
+    {
+      /// Next character to be parsed.
+      const char* position;
+
+      /// One past the last character that can be parsed.
+      const char* end;
+    };
+
+    /// Retrieves the next character to be parsed without consuming it.
+    /// @param [in] cursor Parser position.
+    /// @return Next character, or a null character if the end of the text has been reached.
+    static inline char JsonPeek(const SJsonCursor& cursor)
+    {
+      return ((cursor.position < cursor.end) ? *cursor.position : '\0');
+    }
+
+    /// Advances past any whitespace. As is common among JSON parsers, all control characters other
+    /// than the null character are treated as whitespace.
+    /// @param [in,out] cursor Parser position.
+    static inline void JsonSkipWhitespace(SJsonCursor& cursor)
+    {
+      while ((cursor.position < cursor.end) && ('\0' != *cursor.position) &&
+             ((unsigned char)*cursor.position <= ' '))
+        cursor.position += 1;
+    }
+
+    /// Determines if the next non-whitespace character is the specified character, without
+    /// consuming it.
+    /// @param [in,out] cursor Parser position. Advanced past any whitespace.
+    /// @param [in] expected Expected character.
+    /// @return `true` if the next character matches, `false` otherwise.
+    static inline bool JsonIsNext(SJsonCursor& cursor, char expected)
+    {
+      JsonSkipWhitespace(cursor);
+      return (expected == JsonPeek(cursor));
+    }
+
+    /// Consumes the next non-whitespace character if it is the specified character.
+    /// @param [in,out] cursor Parser position.
+    /// @param [in] expected Expected character.
+    /// @return `true` if the next character matches and was consumed, `false` otherwise.
+    static inline bool JsonConsume(SJsonCursor& cursor, char expected)
+    {
+      if (false == JsonIsNext(cursor, expected)) return false;
+
+      cursor.position += 1;
+      return true;
+    }
+
+    /// Consumes the specified literal if it appears at the current position.
+    /// @param [in,out] cursor Parser position.
+    /// @param [in] literal Expected literal.
+    /// @return `true` if the literal matches and was consumed, `false` otherwise.
+    static bool JsonConsumeLiteral(SJsonCursor& cursor, std::string_view literal)
+    {
+      if ((size_t)(cursor.end - cursor.position) < literal.length()) return false;
+      if (literal != std::string_view(cursor.position, literal.length())) return false;
+
+      cursor.position += literal.length();
+      return true;
+    }
+
+    /// Parses a JSON string. Escape sequences are skipped but not translated.
+    /// @param [in,out] cursor Parser position.
+    /// @param [out] contents Filled in with the raw contents of the string, without the
+    /// surrounding quotation marks. Refers directly to the JSON text.
+    /// @return `true` if a string was parsed successfully, `false` otherwise.
+    static bool JsonParseString(SJsonCursor& cursor, std::string_view& contents)
+    {
+      if (false == JsonConsume(cursor, '"')) return false;
+
+      const char* const contentsStart = cursor.position;
+
+      while ('"' != JsonPeek(cursor))
+      {
+        if ('\0' == JsonPeek(cursor)) return false;
+
+        if ('\\' == JsonPeek(cursor))
+        {
+          cursor.position += 1;
+          if ('\0' == JsonPeek(cursor)) return false;
+        }
+
+        cursor.position += 1;
+      }
+
+      contents = std::string_view(contentsStart, (size_t)(cursor.position - contentsStart));
+      cursor.position += 1;
+      return true;
+    }
+
+    /// Parses a JSON number and converts it to an integer by truncating it towards zero and
+    /// saturating it to the range of the integer type.
+    /// @param [in,out] cursor Parser position. Must already be advanced past any whitespace.
+    /// @param [out] value Filled in with the integer value of the number.
+    /// @return `true` if a number was parsed successfully, `false` otherwise.
+    static bool JsonParseNumber(SJsonCursor& cursor, int& value)
+    {
+      const char* const numberStart = cursor.position;
+
+      if ('-' == JsonPeek(cursor)) cursor.position += 1;
+      if ((JsonPeek(cursor) < '0') || (JsonPeek(cursor) > '9')) return false;
+
+      while (true)
+      {
+        const char c = JsonPeek(cursor);
+        if (((c < '0') || (c > '9')) && ('.' != c) && ('e' != c) && ('E' != c) && ('+' != c) &&
+            ('-' != c))
+          break;
+
+        cursor.position += 1;
+      }
+
+      double number = 0.0;
+      const std::from_chars_result conversionResult =
+          std::from_chars(numberStart, cursor.position, number);
+      if (conversionResult.ptr != cursor.position) return false;
+
+      switch (conversionResult.ec)
+      {
+        case std::errc():
+          break;
+
+        case std::errc::result_out_of_range:
+        {
+          const std::string_view numberText(
+              numberStart, (size_t)(cursor.position - numberStart));
+          if ((std::string_view::npos != numberText.find("e-")) ||
+              (std::string_view::npos != numberText.find("E-")))
+            number = 0.0;
+          else
+            number = (('-' == *numberStart) ? -HUGE_VAL : HUGE_VAL);
+          break;
+        }
+
+        default:
+          return false;
+      }
+
+      if (number >= (double)INT_MAX)
+        value = INT_MAX;
+      else if (number <= (double)INT_MIN)
+        value = INT_MIN;
+      else
+        value = (int)number;
+
+      return true;
+    }
+
+    /// Parses a JSON object, invoking the supplied member parser once per member.
+    /// @tparam MemberParser Callable type that accepts the member name, the parser position, and
+    /// the nesting depth of the member value, and returns `true` if it successfully consumed the
+    /// member value.
+    /// @param [in,out] cursor Parser position.
+    /// @param [in] depth Nesting depth of the enclosing value.
+    /// @param [in] parseMember Member parser.
+    /// @return `true` if an object was parsed successfully, `false` otherwise.
+    template <typename MemberParser> static bool JsonParseObject(
+        SJsonCursor& cursor, unsigned int depth, MemberParser parseMember)
+    {
+      if (depth >= kJsonMaxNestingDepth) return false;
+      if (false == JsonConsume(cursor, '{')) return false;
+      if (true == JsonConsume(cursor, '}')) return true;
+
+      do
+      {
+        std::string_view name;
+        if (false == JsonParseString(cursor, name)) return false;
+        if (false == JsonConsume(cursor, ':')) return false;
+        if (false == parseMember(name, cursor, (depth + 1))) return false;
+      }
+      while (true == JsonConsume(cursor, ','));
+
+      return JsonConsume(cursor, '}');
+    }
+
+    /// Parses a JSON array, invoking the supplied element parser once per element.
+    /// @tparam ElementParser Callable type that accepts the element index, the parser position,
+    /// and the nesting depth of the element value, and returns `true` if it successfully consumed
+    /// the element value.
+    /// @param [in,out] cursor Parser position.
+    /// @param [in] depth Nesting depth of the enclosing value.
+    /// @param [in] parseElement Element parser.
+    /// @return `true` if an array was parsed successfully, `false` otherwise.
+    template <typename ElementParser> static bool JsonParseArray(
+        SJsonCursor& cursor, unsigned int depth, ElementParser parseElement)
+    {
+      if (depth >= kJsonMaxNestingDepth) return false;
+      if (false == JsonConsume(cursor, '[')) return false;
+      if (true == JsonConsume(cursor, ']')) return true;
+
+      unsigned int index = 0;
+
+      do
+      {
+        if (false == parseElement(index, cursor, (depth + 1))) return false;
+        index += 1;
+      }
+      while (true == JsonConsume(cursor, ','));
+
+      return JsonConsume(cursor, ']');
+    }
+
+    /// Parses and discards any JSON value.
+    /// @param [in,out] cursor Parser position.
+    /// @param [in] depth Nesting depth of the value.
+    /// @return `true` if a value was parsed successfully, `false` otherwise.
+    static bool JsonSkipValue(SJsonCursor& cursor, unsigned int depth)
+    {
+      JsonSkipWhitespace(cursor);
+
+      switch (JsonPeek(cursor))
+      {
+        case '{':
+          return JsonParseObject(
+              cursor,
+              depth,
+              [](std::string_view, SJsonCursor& memberCursor, unsigned int memberDepth) -> bool
+              {
+                return JsonSkipValue(memberCursor, memberDepth);
+              });
+
+        case '[':
+          return JsonParseArray(
+              cursor,
+              depth,
+              [](unsigned int, SJsonCursor& elementCursor, unsigned int elementDepth) -> bool
+              {
+                return JsonSkipValue(elementCursor, elementDepth);
+              });
+
+        case '"':
+        {
+          std::string_view ignoredContents;
+          return JsonParseString(cursor, ignoredContents);
+        }
+
+        case 't':
+          return JsonConsumeLiteral(cursor, "true");
+
+        case 'f':
+          return JsonConsumeLiteral(cursor, "false");
+
+        case 'n':
+          return JsonConsumeLiteral(cursor, "null");
+
+        default:
+        {
+          int ignoredValue = 0;
+          return JsonParseNumber(cursor, ignoredValue);
+        }
+      }
+    }
+
+    /// Parses any JSON value and interprets it as an integer. Numbers are converted as described
+    /// for #JsonParseNumber, `true` is interpreted as 1, and all other values are interpreted as 0.
+    /// @param [in,out] cursor Parser position.
+    /// @param [in] depth Nesting depth of the value.
+    /// @param [out] value Filled in with the integer interpretation of the value.
+    /// @return `true` if a value was parsed successfully, `false` otherwise.
+    static bool JsonParseInteger(SJsonCursor& cursor, unsigned int depth, int& value)
+    {
+      JsonSkipWhitespace(cursor);
+
+      const char firstCharacter = JsonPeek(cursor);
+      if (('-' == firstCharacter) || (('0' <= firstCharacter) && (firstCharacter <= '9')))
+        return JsonParseNumber(cursor, value);
+
+      value = (('t' == firstCharacter) ? 1 : 0);
+      return JsonSkipValue(cursor, depth);
+    }
+
+    /// Parses a JSON object that describes keyboard input.
+    /// @param [in,out] cursor Parser position.
+    /// @param [in] depth Nesting depth of the enclosing value.
+    /// @param [in,out] keyboardMouseInput Modified with the keyboard input present in the object.
+    /// @return `true` if the object was parsed successfully, `false` otherwise.
+    static bool JsonParseKeyboard(
+        SJsonCursor& cursor, unsigned int depth, SKeyboardMouseInput& keyboardMouseInput)
+    {
+      return JsonParseObject(
+          cursor,
+          depth,
+          [&keyboardMouseInput](
+              std::string_view name, SJsonCursor& memberCursor, unsigned int memberDepth) -> bool
+          {
+            const std::optional<SJsonKey> key = FindJsonKey(name);
+            if ((false == key.has_value()) || (false == JsonIsNext(memberCursor, '[')))
+              return JsonSkipValue(memberCursor, memberDepth);
+
+            std::bitset<Keyboard::kVirtualKeyboardKeyCount>* keys = nullptr;
+            switch (key->type)
+            {
+              case EJsonKeyType::KeyboardPressed:
+                keys = &keyboardMouseInput.keyPressed;
+                break;
+
+              case EJsonKeyType::KeyboardReleased:
+                keys = &keyboardMouseInput.keyReleased;
+                break;
+
+              default:
+                return JsonSkipValue(memberCursor, memberDepth);
+            }
+
+            return JsonParseArray(
+                memberCursor,
+                memberDepth,
+                [keys](
+                    unsigned int, SJsonCursor& elementCursor, unsigned int elementDepth) -> bool
+                {
+                  int keyIdentifier = 0;
+                  if (false == JsonParseInteger(elementCursor, elementDepth, keyIdentifier))
+                    return false;
+
+                  if ((keyIdentifier >= 0) &&
+                      ((unsigned int)keyIdentifier < Keyboard::kVirtualKeyboardKeyCount))
+                    (*keys)[keyIdentifier] = true;
+
+                  return true;
+                });
+          });
+    }
+
+    /// Parses a JSON object that describes mouse input. Movement values are used only if the
+    /// object also contains a non-zero mouse movement flag, irrespective of member order. If the
+    /// object instead contains a non-zero mouse motion flag, they are used as relative motion
+    /// accumulators.
+    /// @param [in,out] cursor Parser position.
+    /// @param [in] depth Nesting depth of the enclosing value.
+    /// @param [in,out] keyboardMouseInput Modified with the mouse input present in the object.
+    /// @return `true` if the object was parsed successfully, `false` otherwise.
+    static bool JsonParseMouse(
+        SJsonCursor& cursor, unsigned int depth, SKeyboardMouseInput& keyboardMouseInput)
+    {
+      bool mouseMove = false;
+      bool mouseMotion = false;
+      decltype(keyboardMouseInput.mouseMovementPresent) mouseMovementPresent;
+      decltype(keyboardMouseInput.mouseMovement) mouseMovement = {};
+
+      const bool parseResult = JsonParseObject(
+          cursor,
+          depth,
+          [&keyboardMouseInput, &mouseMove, &mouseMotion, &mouseMovementPresent, &mouseMovement](
+              std::string_view name, SJsonCursor& memberCursor, unsigned int memberDepth) -> bool
+          {
+            const std::optional<SJsonKey> key = FindJsonKey(name);
+            if (false == key.has_value()) return JsonSkipValue(memberCursor, memberDepth);
+
+            int value = 0;
+            switch (key->type)
+            {
+              case EJsonKeyType::MouseButton:
+                if (false == JsonParseInteger(memberCursor, memberDepth, value)) return false;
+                keyboardMouseInput.mouseButtonPresent[key->index] = true;
+                keyboardMouseInput.mouseButtonPressed[key->index] = (0 != value);
+                return true;
+
+              case EJsonKeyType::MouseMove:
+                if (false == JsonParseInteger(memberCursor, memberDepth, value)) return false;
+                mouseMove = (0 != value);
+                return true;
+
+              case EJsonKeyType::MouseMotion:
+                if (false == JsonParseInteger(memberCursor, memberDepth, value)) return false;
+                mouseMotion = (0 != value);
+                return true;
+
+              case EJsonKeyType::MouseAxis:
+                if (false == JsonParseInteger(memberCursor, memberDepth, value)) return false;
+                mouseMovementPresent[key->index] = true;
+                mouseMovement[key->index] = value;
+                return true;
+
+              default:
+                return JsonSkipValue(memberCursor, memberDepth);
+            }
+          });
+
+      if (false == parseResult) return false;
+
+      if (true == mouseMotion)
+      {
+        keyboardMouseInput.mouseMotionPresent = mouseMovementPresent;
+        keyboardMouseInput.mouseMotion = mouseMovement;
+      }
+      else if (true == mouseMove)
+      {
+        keyboardMouseInput.mouseMovementPresent = mouseMovementPresent;
+        keyboardMouseInput.mouseMovement = mouseMovement;
+      }
+
+      return true;
+    }
+
+    /// Parses a JSON object that describes the input for a single controller.
+    /// @param [in,out] cursor Parser position.
+    /// @param [in] depth Nesting depth of the enclosing value.
+    /// @param [out] overlay Filled in with the controller elements present in the object.
+    /// @param [out] keyboardMouseInput Filled in with the keyboard and mouse input present in the
+    /// object, or `nullptr` if keyboard and mouse input should be ignored.
+    /// @return `true` if the object was parsed successfully, `false` otherwise.
+    static bool JsonParseController(
+        SJsonCursor& cursor,
+        unsigned int depth,
+        Controller::SStateOverlay& overlay,
+        SKeyboardMouseInput* keyboardMouseInput)
+    {
+      return JsonParseObject(
+          cursor,
+          depth,
+          [&overlay, keyboardMouseInput](
+              std::string_view name, SJsonCursor& memberCursor, unsigned int memberDepth) -> bool
+          {
+            const std::optional<SJsonKey> key = FindJsonKey(name);
+            if (false == key.has_value()) return JsonSkipValue(memberCursor, memberDepth);
+
+            int value = 0;
+            switch (key->type)
+            {
+              case EJsonKeyType::Axis:
+                if (false == JsonParseInteger(memberCursor, memberDepth, value)) return false;
+                overlay.values.axis[key->index] = value;
+                overlay.axisPresent[key->index] = true;
+                return true;
+
+              case EJsonKeyType::Button:
+                if (false == JsonParseInteger(memberCursor, memberDepth, value)) return false;
+                overlay.values.button[key->index] = (0 != value);
+                overlay.buttonPresent[key->index] = true;
+                return true;
+
+              case EJsonKeyType::PovDirection:
+                if (false == JsonParseInteger(memberCursor, memberDepth, value)) return false;
+                overlay.values.povDirection.components[key->index] = (0 != value);
+                overlay.povDirectionPresent[key->index] = true;
+                return true;
+
+              case EJsonKeyType::Keyboard:
+                if ((nullptr == keyboardMouseInput) || (false == JsonIsNext(memberCursor, '{')))
+                  break;
+                return JsonParseKeyboard(memberCursor, memberDepth, *keyboardMouseInput);
+
+              case EJsonKeyType::Mouse:
+                if ((nullptr == keyboardMouseInput) || (false == JsonIsNext(memberCursor, '{')))
+                  break;
+                return JsonParseMouse(memberCursor, memberDepth, *keyboardMouseInput);
+
+              default:
+                break;
+            }
+
+            return JsonSkipValue(memberCursor, memberDepth);
+          });
+    }
+
+    std::optional<SJsonKey> LookupJsonKey(std::string_view name)
+    {
+      return FindJsonKey(name);
+    }
+
+    bool ParseJsonFrame(const char* text, size_t maxTextLength, SFrameInput& frameInput)
+    {
+      SJsonCursor cursor = {.position = text, .end = &text[maxTextLength]};
+
+      // Any valid JSON text is accepted, but only an array supplies input.
+      if (false == JsonIsNext(cursor, '[')) return JsonSkipValue(cursor, 0);
+
+      return JsonParseArray(
+          cursor,
+          0,
+          [&frameInput](
+              unsigned int index, SJsonCursor& elementCursor, unsigned int elementDepth) -> bool
+          {
+            if ((index >= frameInput.controller.size()) ||
+                (false == JsonIsNext(elementCursor, '{')))
+              return JsonSkipValue(elementCursor, elementDepth);
+
+            return JsonParseController(
+                elementCursor,
+                elementDepth,
+                frameInput.controller[index],
+                ((0 == index) ? &frameInput.keyboardMouse : nullptr));
+          });
+    }
+  } // namespace SharedMemory
+} // namespace Xidi
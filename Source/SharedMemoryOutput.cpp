@@ -0,0 +1,233 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file SharedMemoryOutput.cpp
+ *   Implementation of functionality for publishing force feedback output to external consumers
+ *   via shared memory.
+ **************************************************************************************************/
+
+#include "SharedMemoryOutput.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "ForceFeedbackTypes.h"
+#include "ImportApiWinMM.h"
+#include "Message.h"
+#include "PhysicalController.h"
+#include "SharedMemoryTypes.h"
+#include "Strings.h"
+
+namespace Xidi
+{
+  namespace SharedMemory
+  {
+    /// Holds all of the state needed to publish force feedback output to the named mapping.
+    struct SForceFeedbackOutputState
+    {
+      /// Protects against concurrent writes from the threads that actuate different controllers.
+      std::mutex mutex;
+
+      /// Indicates whether an attempt was made to create the mapping. Creation is attempted once.
+      bool creationAttempted;
+
+      /// Handle of the mapping, or `nullptr` if it could not be created.
+      HANDLE mappingHandle;
+
+      /// View of the whole mapping, or `nullptr` if it could not be mapped.
+      void* mappingView;
+
+      /// Handle of the event that is signalled after each write, or `nullptr` if it could not be
+      /// created.
+      HANDLE signalEventHandle;
+    };
+
+    /// Retrieves the state used to publish force feedback output to the named mapping.
+    /// @return Mutable reference to the state.
+    static SForceFeedbackOutputState& GetForceFeedbackOutputState(void)
+    {
+      static SForceFeedbackOutputState forceFeedbackOutputState;
+      return forceFeedbackOutputState;
+    }
+
+    /// Attempts to create the force feedback output mapping and its event and to initialize the
+    /// mapping. Must be invoked with the state's mutex held.
+    /// @param [in,out] state State used to publish force feedback output.
+    static void CreateForceFeedbackOutput(SForceFeedbackOutputState& state)
+    {
+      state.creationAttempted = true;
+
+      state.mappingView = CreateForceFeedbackOutputMapping(
+          Strings::kStrSharedMemoryForceFeedbackMappingName,
+          (uint16_t)Controller::GetControllerCount(),
+          state.mappingHandle);
+      if (nullptr == state.mappingView) return;
+
+      state.signalEventHandle = CreateEventW(
+          nullptr, FALSE, FALSE, Strings::kStrSharedMemoryForceFeedbackEventName.data());
+    }
+
+    /// Obtains a pointer to a force feedback output record.
+    /// @param [in] output Pointer to the start of the mapping.
+    /// @param [in] offset Byte offset of the first record in a contiguous group of records.
+    /// @param [in] index Index of the record within the group.
+    /// @return Pointer to the record.
+    static inline SForceFeedbackOutputRecord* ForceFeedbackOutputRecordAt(
+        void* output, size_t offset, size_t index)
+    {
+      return reinterpret_cast<SForceFeedbackOutputRecord*>(
+                 static_cast<uint8_t*>(output) + offset) +
+          index;
+    }
+
+    void* CreateForceFeedbackOutputMapping(
+        std::wstring_view mappingName, uint16_t controllerCount, HANDLE& mappingHandle)
+    {
+      const size_t mappingSizeBytes = ForceFeedbackOutputSizeBytes(controllerCount);
+
+      mappingHandle = CreateFileMappingW(
+          INVALID_HANDLE_VALUE,
+          nullptr,
+          PAGE_READWRITE,
+          0,
+          (DWORD)mappingSizeBytes,
+          mappingName.data());
+      if (nullptr == mappingHandle)
+      {
+        Message::OutputFormatted(
+            Message::ESeverity::Warning,
+            L"Failed to create the shared memory force feedback output mapping (%s): %s.",
+            mappingName.data(),
+            Strings::SystemErrorCodeString(GetLastError()).AsCString());
+        return nullptr;
+      }
+
+      // Writers in different instances do not synchronize with one another, and an existing
+      // mapping might have been created for a different number of controllers, so the first
+      // instance to create the mapping is its only publisher.
+      if (ERROR_ALREADY_EXISTS == GetLastError())
+      {
+        Message::OutputFormatted(
+            Message::ESeverity::Warning,
+            L"Shared memory force feedback output mapping (%s) is already published by another instance, so this instance will not publish force feedback output.",
+            mappingName.data());
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+        return nullptr;
+      }
+
+      void* const mappingView =
+          MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, mappingSizeBytes);
+      if (nullptr == mappingView)
+      {
+        Message::OutputFormatted(
+            Message::ESeverity::Warning,
+            L"Failed to map a view of the shared memory force feedback output mapping (%s): %s.",
+            mappingName.data(),
+            Strings::SystemErrorCodeString(GetLastError()).AsCString());
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+        return nullptr;
+      }
+
+      InitializeForceFeedbackOutput(mappingView, controllerCount, GetCurrentProcessId());
+
+      Message::OutputFormatted(
+          Message::ESeverity::Info,
+          L"Created shared memory force feedback output mapping (%s), size = %zu bytes.",
+          mappingName.data(),
+          mappingSizeBytes);
+
+      return mappingView;
+    }
+
+    void InitializeForceFeedbackOutput(
+        void* output, uint16_t controllerCount, uint32_t instanceIdentifier)
+    {
+      std::memset(output, 0, ForceFeedbackOutputSizeBytes(controllerCount));
+
+      for (uint16_t controllerIdentifier = 0; controllerIdentifier < controllerCount;
+           ++controllerIdentifier)
+        ForceFeedbackOutputRecordAt(
+            output, kForceFeedbackOutputCurrentOffset, controllerIdentifier)
+            ->controllerIdentifier = controllerIdentifier;
+
+      SForceFeedbackOutputHeader* const header = static_cast<SForceFeedbackOutputHeader*>(output);
+      header->version = kForceFeedbackOutputVersion;
+      header->controllerCount = controllerCount;
+      header->slotCount = kForceFeedbackOutputSlotCount;
+      header->instanceIdentifier = instanceIdentifier;
+
+      // Consumers that observe the magic value also observe the rest of the initialized mapping.
+      std::atomic_ref<uint32_t>(header->magic)
+          .store(kForceFeedbackOutputMagic, std::memory_order_release);
+    }
+
+    void WriteForceFeedbackOutput(
+        void* output,
+        Controller::TControllerIdentifier controllerIdentifier,
+        const Controller::ForceFeedback::SPhysicalActuatorComponents& actuatorValues,
+        uint32_t timestamp)
+    {
+      SForceFeedbackOutputHeader* const header = static_cast<SForceFeedbackOutputHeader*>(output);
+      if (controllerIdentifier >= header->controllerCount) return;
+
+      const uint32_t recordNumber = header->writeCount + 1;
+      SForceFeedbackOutputRecord* const records[] = {
+          ForceFeedbackOutputRecordAt(
+              output,
+              ForceFeedbackOutputRingOffset(header->controllerCount),
+              (recordNumber - 1) % header->slotCount),
+          ForceFeedbackOutputRecordAt(
+              output, kForceFeedbackOutputCurrentOffset, controllerIdentifier)};
+
+      for (SForceFeedbackOutputRecord* record : records)
+        std::atomic_ref<uint32_t>(record->sequence).store(0, std::memory_order_relaxed);
+
+      std::atomic_thread_fence(std::memory_order_release);
+
+      for (SForceFeedbackOutputRecord* record : records)
+      {
+        record->timestamp = timestamp;
+        record->controllerIdentifier = (uint16_t)controllerIdentifier;
+        record->reserved = 0;
+        record->actuator[0] = actuatorValues.leftMotor;
+        record->actuator[1] = actuatorValues.rightMotor;
+        record->actuator[2] = actuatorValues.leftImpulseTrigger;
+        record->actuator[3] = actuatorValues.rightImpulseTrigger;
+      }
+
+      for (SForceFeedbackOutputRecord* record : records)
+        std::atomic_ref<uint32_t>(record->sequence)
+            .store(recordNumber, std::memory_order_release);
+
+      std::atomic_ref<uint32_t>(header->writeCount).store(recordNumber, std::memory_order_release);
+    }
+
+    void PublishForceFeedbackOutput(
+        Controller::TControllerIdentifier controllerIdentifier,
+        const Controller::ForceFeedback::SPhysicalActuatorComponents& actuatorValues)
+    {
+      SForceFeedbackOutputState& state = GetForceFeedbackOutputState();
+      std::scoped_lock lock(state.mutex);
+
+      if (false == state.creationAttempted) CreateForceFeedbackOutput(state);
+      if (nullptr == state.mappingView) return;
+
+      WriteForceFeedbackOutput(
+          state.mappingView, controllerIdentifier, actuatorValues, ImportApiWinMM::timeGetTime());
+
+      if (nullptr != state.signalEventHandle) SetEvent(state.signalEventHandle);
+    }
+  } // namespace SharedMemory
+} // namespace Xidi
@@ -24,6 +24,7 @@
 #include "ApiWindows.h"
 #include "ControllerTypes.h"
 #include "Globals.h"
+#include "SharedMemoryTypes.h"
 #include "TemporaryBuffer.h"
 
 namespace Xidi
@@ -525,7 +526,7 @@ namespace Xidi
     std::wstring_view MapperTypeConfigurationNameString(
         Controller::TControllerIdentifier controllerIdentifier)
     {
-      static std::wstring initStrings[Controller::kPhysicalControllerCount];
+      static std::wstring initStrings[Controller::kMaxControllerCount];
       static std::once_flag initFlag;
 
       std::call_once(
@@ -543,11 +544,62 @@ namespace Xidi
             }
           });
 
-      if (controllerIdentifier >= Controller::kPhysicalControllerCount) return std::wstring_view();
+      if (controllerIdentifier >= Controller::kMaxControllerCount) return std::wstring_view();
 
       return initStrings[controllerIdentifier];
     }
 
+    std::wstring_view SharedMemoryChannelConfigurationNameString(unsigned int channelIndex)
+    {
+      static std::wstring initStrings[SharedMemory::kMaxChannelCount];
+      static std::once_flag initFlag;
+
+      std::call_once(
+          initFlag,
+          []() -> void
+          {
+            TemporaryString perChannelNameString;
+
+            for (unsigned int i = 0; i < _countof(initStrings); ++i)
+            {
+              perChannelNameString.Clear();
+              perChannelNameString << kStrConfigurationSettingSharedMemoryChannel
+                                   << kCharConfigurationSettingSeparator << (1 + i);
+              initStrings[i] = perChannelNameString;
+            }
+          });
+
+      if (channelIndex >= SharedMemory::kMaxChannelCount) return std::wstring_view();
+
+      return initStrings[channelIndex];
+    }
+
+    std::wstring_view SharedMemoryAxisMergeConfigurationNameString(Controller::EAxis axis)
+    {
+      static std::wstring initStrings[static_cast<int>(Controller::EAxis::Count)];
+      static std::once_flag initFlag;
+
+      std::call_once(
+          initFlag,
+          []() -> void
+          {
+            TemporaryString perAxisMergeString;
+
+            for (int i = 0; i < _countof(initStrings); ++i)
+            {
+              perAxisMergeString.Clear();
+              perAxisMergeString << kStrConfigurationSettingSharedMemoryAxisMerge
+                                 << kCharConfigurationSettingSeparator
+                                 << AxisTypeString(static_cast<Controller::EAxis>(i));
+              initStrings[i] = perAxisMergeString;
+            }
+          });
+
+      if (static_cast<int>(axis) >= _countof(initStrings)) return std::wstring_view();
+
+      return initStrings[static_cast<int>(axis)];
+    }
+
     TemporaryVector<std::wstring_view> SplitString(
         std::wstring_view stringToSplit, std::wstring_view delimiter)
     {
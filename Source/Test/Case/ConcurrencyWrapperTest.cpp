@@ -0,0 +1,137 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file ConcurrencyWrapperTest.cpp
+ *   Unit tests for the lock-free version of the concurrency wrapper, which is used for trivially
+ *   copyable data types.
+ **************************************************************************************************/
+
+#include "TestCase.h"
+
+#include "ConcurrencyWrapper.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stop_token>
+#include <thread>
+
+namespace XidiTest
+{
+  using ::Xidi::ConcurrencyWrapper;
+
+  /// Trivially copyable data type whose elements are always written with the same value, so that
+  /// a torn read is detectable. Large enough that it cannot be copied in a single operation.
+  struct STestData
+  {
+    uint64_t value[8];
+
+    bool operator==(const STestData& other) const = default;
+
+    /// Determines if all elements hold the same value.
+    /// @return `true` if so, `false` otherwise.
+    bool IsConsistent(void) const
+    {
+      for (const uint64_t element : value)
+      {
+        if (element != value[0]) return false;
+      }
+
+      return true;
+    }
+  };
+
+  /// Creates a test data object whose elements all hold the specified value.
+  /// @param [in] value Value for all elements.
+  /// @return Test data object.
+  static STestData MakeTestData(uint64_t value)
+  {
+    return {.value = {value, value, value, value, value, value, value, value}};
+  }
+
+  // Updates the data continuously on one thread while reading it on another and verifies that no
+  // read ever observes a partially-written update.
+  TEST_CASE(ConcurrencyWrapper_Lockfree_NoTornReads)
+  {
+    constexpr uint64_t kUpdateCount = 100000;
+
+    ConcurrencyWrapper<STestData> wrapper;
+    wrapper.Set(MakeTestData(0));
+
+    std::atomic<bool> producerDone = false;
+    std::thread producer(
+        [&wrapper, &producerDone]() -> void
+        {
+          for (uint64_t value = 1; value <= kUpdateCount; ++value)
+            wrapper.Update(MakeTestData(value));
+
+          producerDone = true;
+        });
+
+    bool allReadsConsistent = true;
+    uint64_t lastValue = 0;
+    while (false == producerDone)
+    {
+      const STestData data = wrapper.Get();
+      if ((false == data.IsConsistent()) || (data.value[0] < lastValue))
+        allReadsConsistent = false;
+
+      lastValue = data.value[0];
+    }
+
+    producer.join();
+    TEST_ASSERT(true == allReadsConsistent);
+    TEST_ASSERT(MakeTestData(kUpdateCount) == wrapper.Get());
+  }
+
+  // Waits for an update that is made on another thread and verifies that the updated data are
+  // returned.
+  TEST_CASE(ConcurrencyWrapper_Lockfree_WaitForUpdate)
+  {
+    ConcurrencyWrapper<STestData> wrapper;
+    wrapper.Set(MakeTestData(1));
+
+    std::thread producer(
+        [&wrapper]() -> void
+        {
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          wrapper.Update(MakeTestData(2));
+        });
+
+    STestData data = MakeTestData(1);
+    const bool waitResult = wrapper.WaitForUpdate(data, std::stop_source().get_token());
+    producer.join();
+
+    TEST_ASSERT(true == waitResult);
+    TEST_ASSERT(MakeTestData(2) == data);
+  }
+
+  // Waits for an update that never happens and verifies that the wait can be interrupted, both
+  // while it is in progress and before it begins, without affecting the data.
+  TEST_CASE(ConcurrencyWrapper_Lockfree_WaitInterrupted)
+  {
+    ConcurrencyWrapper<STestData> wrapper;
+    wrapper.Set(MakeTestData(1));
+
+    std::stop_source stopSource;
+    std::thread interrupter(
+        [&stopSource]() -> void
+        {
+          std::this_thread::sleep_for(std::chrono::milliseconds(10));
+          stopSource.request_stop();
+        });
+
+    STestData data = MakeTestData(1);
+    const bool waitResult = wrapper.WaitForUpdate(data, stopSource.get_token());
+    interrupter.join();
+
+    TEST_ASSERT(false == waitResult);
+    TEST_ASSERT(false == wrapper.WaitForUpdate(data, stopSource.get_token()));
+    TEST_ASSERT(MakeTestData(1) == data);
+    TEST_ASSERT(MakeTestData(1) == wrapper.Get());
+  }
+} // namespace XidiTest
@@ -0,0 +1,100 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file InputInjectionTest.cpp
+ *   Unit tests for accepting input injected directly by other modules loaded into the same
+ *   process.
+ **************************************************************************************************/
+
+#include "TestCase.h"
+
+#include "InputInjection.h"
+
+#include "ControllerTypes.h"
+#include "PhysicalController.h"
+#include "SharedMemoryTypes.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::InputInjection;
+  using ::Xidi::Controller::EAxis;
+  using ::Xidi::Controller::EButton;
+  using ::Xidi::Controller::GetControllerCount;
+  using ::Xidi::SharedMemory::SKeyboardMouseInput;
+
+  // Injects a batch of input for two controllers and the keyboard and verifies that it is read
+  // back as a single batch that only marks those controllers as present.
+  TEST_CASE(InputInjection_SubmitAndRead)
+  {
+    SControllerInput controllerInputs[2] = {
+        {.controllerIdentifier = 0}, {.controllerIdentifier = 2}};
+    controllerInputs[0].overlay.axisPresent[(int)EAxis::X] = true;
+    controllerInputs[0].overlay.values.axis[(int)EAxis::X] = 1234;
+    controllerInputs[1].overlay.buttonPresent[(int)EButton::B3] = true;
+    controllerInputs[1].overlay.values.button[(int)EButton::B3] = true;
+
+    SKeyboardMouseInput keyboardMouseInput = {};
+    keyboardMouseInput.keyPressed[30] = true;
+
+    TEST_ASSERT(
+        true == SubmitInput(controllerInputs, _countof(controllerInputs), &keyboardMouseInput));
+
+    SInjectedInput injectedInput = {};
+    TEST_ASSERT(true == ReadInjectedInput(injectedInput));
+    TEST_ASSERT(2 == injectedInput.controllerPresent.count());
+    TEST_ASSERT(true == injectedInput.controllerPresent[0]);
+    TEST_ASSERT(true == injectedInput.controllerPresent[2]);
+    TEST_ASSERT(injectedInput.controller[0] == controllerInputs[0].overlay);
+    TEST_ASSERT(injectedInput.controller[2] == controllerInputs[1].overlay);
+    TEST_ASSERT(true == injectedInput.keyboardMousePresent);
+    TEST_ASSERT(injectedInput.keyboardMouse == keyboardMouseInput);
+
+    TEST_ASSERT(false == ReadInjectedInput(injectedInput));
+  }
+
+  // Verifies that a batch that identifies a controller that does not exist is rejected in its
+  // entirety.
+  TEST_CASE(InputInjection_InvalidController)
+  {
+    const SControllerInput controllerInputs[2] = {
+        {.controllerIdentifier = 0}, {.controllerIdentifier = GetControllerCount()}};
+
+    TEST_ASSERT(false == SubmitInput(controllerInputs, _countof(controllerInputs), nullptr));
+    TEST_ASSERT(false == SubmitInput(nullptr, 1, nullptr));
+
+    SInjectedInput injectedInput = {};
+    TEST_ASSERT(false == ReadInjectedInput(injectedInput));
+  }
+
+  // Fills the queue of pending batches and verifies that further batches are rejected until
+  // pending batches are read, and that batches are read in the order in which they were injected.
+  TEST_CASE(InputInjection_PendingCapacity)
+  {
+    SControllerInput controllerInput = {.controllerIdentifier = 0};
+    controllerInput.overlay.axisPresent[(int)EAxis::Y] = true;
+
+    for (unsigned int i = 0; i < kPendingInputCapacity; ++i)
+    {
+      controllerInput.overlay.values.axis[(int)EAxis::Y] = (int32_t)i;
+      TEST_ASSERT(true == SubmitInput(&controllerInput, 1, nullptr));
+    }
+
+    TEST_ASSERT(false == SubmitInput(&controllerInput, 1, nullptr));
+
+    SInjectedInput injectedInput = {};
+    for (unsigned int i = 0; i < kPendingInputCapacity; ++i)
+    {
+      TEST_ASSERT(true == ReadInjectedInput(injectedInput));
+      TEST_ASSERT((int32_t)i == injectedInput.controller[0].values.axis[(int)EAxis::Y]);
+      TEST_ASSERT(false == injectedInput.keyboardMousePresent);
+    }
+
+    TEST_ASSERT(false == ReadInjectedInput(injectedInput));
+    TEST_ASSERT(true == SubmitInput(&controllerInput, 1, nullptr));
+    TEST_ASSERT(true == ReadInjectedInput(injectedInput));
+  }
+} // namespace XidiTest
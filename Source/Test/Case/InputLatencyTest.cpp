@@ -0,0 +1,79 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file InputLatencyTest.cpp
+ *   Unit tests for measuring the latency between external producers capturing input and
+ *   applications reading it.
+ **************************************************************************************************/
+
+#include "TestCase.h"
+
+#include "InputLatency.h"
+
+#include <cstdint>
+
+namespace XidiTest
+{
+  using namespace ::Xidi::InputLatency;
+
+  // Verifies that small latency values each get their own bucket and that every bucket holds
+  // exactly the values between the upper bounds of the bucket before it and itself.
+  TEST_CASE(InputLatency_Buckets)
+  {
+    for (uint32_t latency = 0; latency < 8; ++latency)
+    {
+      TEST_ASSERT(latency == Histogram::BucketIndex(latency));
+      TEST_ASSERT(latency == Histogram::BucketUpperBound(latency));
+    }
+
+    for (unsigned int bucketIndex = 1; bucketIndex < kBucketCount; ++bucketIndex)
+    {
+      const uint32_t lowerBound = (1 + Histogram::BucketUpperBound(bucketIndex - 1));
+      const uint32_t upperBound = Histogram::BucketUpperBound(bucketIndex);
+
+      TEST_ASSERT(upperBound >= lowerBound);
+      TEST_ASSERT(bucketIndex == Histogram::BucketIndex(lowerBound));
+      TEST_ASSERT(bucketIndex == Histogram::BucketIndex(upperBound));
+    }
+
+    TEST_ASSERT(UINT32_MAX == Histogram::BucketUpperBound(kBucketCount - 1));
+  }
+
+  // Records a known distribution of latency values and verifies the resulting summary. Reported
+  // percentiles are bucket upper bounds, so they can exceed the exact values by one bucket width.
+  TEST_CASE(InputLatency_Summary)
+  {
+    Histogram histogram;
+    TEST_ASSERT(SSummary() == histogram.GetSummary());
+
+    for (uint32_t i = 0; i < 98; ++i)
+      histogram.Record(100);
+
+    histogram.Record(1000);
+    TEST_ASSERT(100 == histogram.Record(5000));
+
+    const SSummary actualSummary = histogram.GetSummary();
+    TEST_ASSERT(100 == actualSummary.sampleCount);
+    TEST_ASSERT(5000 == actualSummary.max);
+    TEST_ASSERT(Histogram::BucketUpperBound(Histogram::BucketIndex(100)) == actualSummary.p50);
+    TEST_ASSERT(Histogram::BucketUpperBound(Histogram::BucketIndex(1000)) == actualSummary.p99);
+  }
+
+  // Verifies that percentiles never exceed the largest recorded value and that resetting a
+  // histogram discards all recorded samples.
+  TEST_CASE(InputLatency_SummaryBoundedAndReset)
+  {
+    Histogram histogram;
+    histogram.Record(1000);
+
+    const SSummary expectedSummary = {.sampleCount = 1, .p50 = 1000, .p99 = 1000, .max = 1000};
+    TEST_ASSERT(expectedSummary == histogram.GetSummary());
+
+    histogram.Reset();
+    TEST_ASSERT(SSummary() == histogram.GetSummary());
+  }
+} // namespace XidiTest
@@ -0,0 +1,183 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file InputSourceTest.cpp
+ *   Unit tests for sources of controller input.
+ **************************************************************************************************/
+
+#include "TestCase.h"
+
+#include "InputSource.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "ControllerTypes.h"
+#include "InputInjection.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::Controller;
+  using ::Xidi::InputInjection::SControllerInput;
+  using ::Xidi::InputInjection::SubmitInput;
+
+  /// Input sink that records all of the external input it receives.
+  class RecordingInputSink : public IInputSink
+  {
+  public:
+
+    /// Single piece of external input received by this sink.
+    struct SRecord
+    {
+      TControllerIdentifier controllerIdentifier;
+      SStateOverlay overlay;
+      uint32_t timestamp;
+    };
+
+    /// All of the external input received, in order.
+    std::vector<SRecord> records;
+
+    // IInputSink
+    void PublishPhysicalState(
+        TControllerIdentifier controllerIdentifier, const SPhysicalState& physicalState) override
+    {}
+
+    void PublishExternalInput(
+        TControllerIdentifier controllerIdentifier,
+        const SStateOverlay& overlay,
+        uint32_t timestamp,
+        uint32_t captureTime) override
+    {
+      records.push_back(
+          {.controllerIdentifier = controllerIdentifier,
+           .overlay = overlay,
+           .timestamp = timestamp});
+    }
+  };
+
+  // Verifies that the external input source passes injected input on to the sink only for the
+  // controllers for which it is supplied and only when it changes.
+  TEST_CASE(InputSource_External_InjectedInputChangesOnly)
+  {
+    ExternalInputSource inputSource;
+    RecordingInputSink sink;
+
+    SControllerInput controllerInput = {.controllerIdentifier = 1};
+    controllerInput.overlay.axisPresent[(int)EAxis::RotX] = true;
+    controllerInput.overlay.values.axis[(int)EAxis::RotX] = -500;
+
+    TEST_ASSERT(true == SubmitInput(&controllerInput, 1, nullptr));
+    TEST_ASSERT(true == SubmitInput(&controllerInput, 1, nullptr));
+    inputSource.ReadInput(sink);
+
+    TEST_ASSERT(1 == sink.records.size());
+    TEST_ASSERT(1 == sink.records[0].controllerIdentifier);
+    TEST_ASSERT(sink.records[0].overlay == controllerInput.overlay);
+
+    controllerInput.overlay.values.axis[(int)EAxis::RotX] = 500;
+    TEST_ASSERT(true == SubmitInput(&controllerInput, 1, nullptr));
+    inputSource.ReadInput(sink);
+
+    TEST_ASSERT(2 == sink.records.size());
+    TEST_ASSERT(1 == sink.records[1].controllerIdentifier);
+    TEST_ASSERT(sink.records[1].overlay == controllerInput.overlay);
+  }
+
+  // Verifies that a batch of injected input replaces the input previously injected for each
+  // controller it covers, leaving the input injected for other controllers unchanged.
+  TEST_CASE(InputSource_External_InjectedInputReplacedPerController)
+  {
+    ExternalInputSource inputSource;
+    RecordingInputSink sink;
+
+    SControllerInput controllerInputs[2] = {
+        {.controllerIdentifier = 0}, {.controllerIdentifier = 1}};
+    controllerInputs[0].overlay.axisPresent[(int)EAxis::X] = true;
+    controllerInputs[0].overlay.values.axis[(int)EAxis::X] = 1000;
+    controllerInputs[1].overlay.axisPresent[(int)EAxis::Y] = true;
+    controllerInputs[1].overlay.values.axis[(int)EAxis::Y] = -1000;
+
+    TEST_ASSERT(true == SubmitInput(controllerInputs, 2, nullptr));
+    inputSource.ReadInput(sink);
+    TEST_ASSERT(2 == sink.records.size());
+
+    SControllerInput replacementInput = {.controllerIdentifier = 1};
+    replacementInput.overlay.buttonPresent[(int)EButton::B1] = true;
+    replacementInput.overlay.values.button[(int)EButton::B1] = true;
+
+    TEST_ASSERT(true == SubmitInput(&replacementInput, 1, nullptr));
+    inputSource.ReadInput(sink);
+
+    TEST_ASSERT(3 == sink.records.size());
+    TEST_ASSERT(1 == sink.records[2].controllerIdentifier);
+    TEST_ASSERT(sink.records[2].overlay == replacementInput.overlay);
+  }
+
+  // Verifies that reading from the external input source when no input is available passes
+  // nothing on to the sink.
+  TEST_CASE(InputSource_External_NothingAvailable)
+  {
+    ExternalInputSource inputSource;
+    RecordingInputSink sink;
+
+    inputSource.ReadInput(sink);
+    TEST_ASSERT(true == sink.records.empty());
+  }
+
+  // Verifies that adaptive polling starts at the idle period, switches to the active period as
+  // soon as input changes, and stays there until input has been unchanged for the idle delay.
+  TEST_CASE(InputSource_AdaptivePolling_ActiveUntilIdleDelay)
+  {
+    AdaptivePollingRate pollingRate(
+        {.enabled = true,
+         .activePeriodMilliseconds = 1,
+         .idlePeriodMilliseconds = 16,
+         .idleDelayMilliseconds = 100});
+
+    TEST_ASSERT(16 == pollingRate.GetPeriodMilliseconds());
+    TEST_ASSERT(false == pollingRate.IsActive());
+
+    TEST_ASSERT(1 == pollingRate.Update(true, 1000));
+    TEST_ASSERT(true == pollingRate.IsActive());
+
+    TEST_ASSERT(1 == pollingRate.Update(false, 1050));
+    TEST_ASSERT(1 == pollingRate.Update(true, 1060));
+    TEST_ASSERT(1 == pollingRate.Update(false, 1159));
+    TEST_ASSERT(true == pollingRate.IsActive());
+  }
+
+  // Verifies that adaptive polling decays by doubling the period until it reaches the idle
+  // period, snaps back to the active period on the next change, and reports statistics about the
+  // period of active polling that ended.
+  TEST_CASE(InputSource_AdaptivePolling_DecayAndSnapBack)
+  {
+    AdaptivePollingRate pollingRate(
+        {.enabled = true,
+         .activePeriodMilliseconds = 2,
+         .idlePeriodMilliseconds = 10,
+         .idleDelayMilliseconds = 100});
+
+    pollingRate.Update(true, 1000);
+    pollingRate.Update(false, 1050);
+    pollingRate.Update(true, 1060);
+
+    TEST_ASSERT(4 == pollingRate.Update(false, 1160));
+    TEST_ASSERT(false == pollingRate.IsActive());
+    TEST_ASSERT(8 == pollingRate.Update(false, 1164));
+    TEST_ASSERT(10 == pollingRate.Update(false, 1172));
+    TEST_ASSERT(10 == pollingRate.Update(false, 1182));
+
+    const SAdaptivePollingStatistics statistics = pollingRate.GetStatistics();
+    TEST_ASSERT(160 == statistics.durationMilliseconds);
+    TEST_ASSERT(4 == statistics.pollCount);
+    TEST_ASSERT(2 == statistics.changedPollCount);
+
+    TEST_ASSERT(2 == pollingRate.Update(true, 1192));
+    TEST_ASSERT(true == pollingRate.IsActive());
+    TEST_ASSERT(1 == pollingRate.GetStatistics().pollCount);
+  }
+} // namespace XidiTest
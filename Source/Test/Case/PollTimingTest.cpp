@@ -0,0 +1,65 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file PollTimingTest.cpp
+ *   Unit tests for measuring how regularly and how quickly physical controllers are polled.
+ **************************************************************************************************/
+
+#include "TestCase.h"
+
+#include "ControllerTypes.h"
+#include "PollTiming.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::PollTiming;
+  using ::Xidi::Controller::kMaxControllerCount;
+  using ::Xidi::Controller::TControllerIdentifier;
+
+  // Records measurements of each kind for one controller and verifies that each kind is summarized
+  // separately, that no other controller is affected, and that resetting discards everything.
+  TEST_CASE(PollTiming_RecordAndReset)
+  {
+    constexpr TControllerIdentifier kTestControllerIdentifier = 1;
+    ResetSummary(kTestControllerIdentifier);
+
+    RecordPollInterval(kTestControllerIdentifier, 5);
+    RecordPollInterval(kTestControllerIdentifier, 5);
+    RecordPollInterval(kTestControllerIdentifier, 5);
+    RecordReadDuration(kTestControllerIdentifier, 3);
+    RecordReadDuration(kTestControllerIdentifier, 3);
+    RecordChangedPoll(kTestControllerIdentifier, 2, 2);
+    RecordChangedPoll(kTestControllerIdentifier, 2, 1);
+
+    const SSummary summary = GetSummary(kTestControllerIdentifier);
+    TEST_ASSERT(3 == summary.pollInterval.sampleCount);
+    TEST_ASSERT(5 == summary.pollInterval.max);
+    TEST_ASSERT(2 == summary.readDuration.sampleCount);
+    TEST_ASSERT(3 == summary.readDuration.max);
+    TEST_ASSERT(2 == summary.mapDuration.sampleCount);
+    TEST_ASSERT(2 == summary.mapDuration.max);
+    TEST_ASSERT(2 == summary.changedPollCount);
+    TEST_ASSERT(3 == summary.notificationCount);
+
+    TEST_ASSERT(SSummary() == GetSummary(kTestControllerIdentifier + 1));
+
+    ResetSummary(kTestControllerIdentifier);
+    TEST_ASSERT(SSummary() == GetSummary(kTestControllerIdentifier));
+  }
+
+  // Verifies that measurements for an invalid controller identifier are ignored and that its
+  // summary is empty.
+  TEST_CASE(PollTiming_InvalidController)
+  {
+    RecordPollInterval(kMaxControllerCount, 5);
+    RecordReadDuration(kMaxControllerCount, 5);
+    RecordChangedPoll(kMaxControllerCount, 5, 1);
+    ResetSummary(kMaxControllerCount);
+
+    TEST_ASSERT(SSummary() == GetSummary(kMaxControllerCount));
+  }
+} // namespace XidiTest
@@ -0,0 +1,80 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file SchedulerTest.cpp
+ *   Unit tests for deadline tracking in the scheduler that runs all periodic tasks.
+ **************************************************************************************************/
+
+#include "TestCase.h"
+
+#include "Scheduler.h"
+
+#include <chrono>
+
+namespace XidiTest
+{
+  using namespace ::Xidi::Scheduler;
+  using std::chrono::milliseconds;
+
+  /// Arbitrary point in time used as the first deadline throughout these tests.
+  static const TClock::time_point kTestDeadline = TClock::time_point(milliseconds(1000000));
+
+  // Completes an invocation before the next deadline and verifies that the next deadline is
+  // exactly one period after the previous one, regardless of how late the invocation ran.
+  TEST_CASE(Scheduler_NextDeadline_OnTime)
+  {
+    unsigned int missedInvocations = 1;
+
+    TEST_ASSERT(
+        (kTestDeadline + milliseconds(5)) ==
+        NextDeadline(kTestDeadline, 5, kTestDeadline, missedInvocations));
+    TEST_ASSERT(0 == missedInvocations);
+
+    TEST_ASSERT(
+        (kTestDeadline + milliseconds(5)) ==
+        NextDeadline(kTestDeadline, 5, kTestDeadline + milliseconds(4), missedInvocations));
+    TEST_ASSERT(0 == missedInvocations);
+
+    TEST_ASSERT(
+        (kTestDeadline + milliseconds(5)) ==
+        NextDeadline(kTestDeadline, 5, kTestDeadline + milliseconds(5), missedInvocations));
+    TEST_ASSERT(0 == missedInvocations);
+  }
+
+  // Completes an invocation after one or more subsequent deadlines already passed and verifies
+  // that the missed deadlines are skipped while staying aligned to the original period.
+  TEST_CASE(Scheduler_NextDeadline_FellBehind)
+  {
+    unsigned int missedInvocations = 0;
+
+    TEST_ASSERT(
+        (kTestDeadline + milliseconds(10)) ==
+        NextDeadline(kTestDeadline, 5, kTestDeadline + milliseconds(6), missedInvocations));
+    TEST_ASSERT(1 == missedInvocations);
+
+    TEST_ASSERT(
+        (kTestDeadline + milliseconds(10)) ==
+        NextDeadline(kTestDeadline, 5, kTestDeadline + milliseconds(10), missedInvocations));
+    TEST_ASSERT(1 == missedInvocations);
+
+    TEST_ASSERT(
+        (kTestDeadline + milliseconds(25)) ==
+        NextDeadline(kTestDeadline, 5, kTestDeadline + milliseconds(21), missedInvocations));
+    TEST_ASSERT(4 == missedInvocations);
+  }
+
+  // Requests a period of zero and verifies that the minimum period is used instead.
+  TEST_CASE(Scheduler_NextDeadline_MinimumPeriod)
+  {
+    unsigned int missedInvocations = 1;
+
+    TEST_ASSERT(
+        (kTestDeadline + milliseconds(kMinimumPeriodMilliseconds)) ==
+        NextDeadline(kTestDeadline, 0, kTestDeadline, missedInvocations));
+    TEST_ASSERT(0 == missedInvocations);
+  }
+} // namespace XidiTest
@@ -0,0 +1,827 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file SharedMemoryInputTest.cpp
+ *   Unit tests for decoding input supplied by external producers via shared memory.
+ **************************************************************************************************/
+
+#include "TestCase.h"
+
+#include "SharedMemoryInput.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ApiWindows.h"
+#include "ControllerTypes.h"
+#include "Keyboard.h"
+#include "MockKeyboard.h"
+#include "Mouse.h"
+#include "SharedMemoryTypes.h"
+#include "Strings.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::SharedMemory;
+  using ::Xidi::Controller::EAxis;
+  using ::Xidi::Controller::EButton;
+  using ::Xidi::Controller::EPovDirection;
+  using ::Xidi::Controller::SState;
+  using ::Xidi::Controller::SStateOverlay;
+  using ::Xidi::Mouse::EMouseAxis;
+  using ::Xidi::Mouse::EMouseButton;
+
+  /// Creates a versioned frame with a binary payload and the specified number of controllers,
+  /// with all payload bytes initialized to zero.
+  /// @param [in] controllerCount Number of controller blocks to include in the frame.
+  /// @return Buffer holding the frame.
+  static std::vector<uint8_t> CreateBinaryFrame(uint16_t controllerCount)
+  {
+    std::vector<uint8_t> frame(
+        kControllerBlockOffset + (sizeof(SControllerBlock) * controllerCount), 0);
+
+    const SFrameHeader header = {
+        .magic = kFrameMagic,
+        .version = kFrameVersion,
+        .payloadFormat = static_cast<uint16_t>(EPayloadFormat::Binary),
+        .controllerCount = controllerCount,
+        .payloadSizeBytes = (uint32_t)(frame.size() - sizeof(SFrameHeader))};
+    std::memcpy(frame.data(), &header, sizeof(header));
+
+    return frame;
+  }
+
+  /// Writes a controller block into a binary frame.
+  /// @param [in,out] frame Frame to be modified.
+  /// @param [in] controllerIdentifier Identifier of the controller whose block is to be written.
+  /// @param [in] controllerBlock Controller block to write.
+  static void WriteControllerBlock(
+      std::vector<uint8_t>& frame,
+      unsigned int controllerIdentifier,
+      const SControllerBlock& controllerBlock)
+  {
+    std::memcpy(
+        &frame[kControllerBlockOffset + (sizeof(SControllerBlock) * controllerIdentifier)],
+        &controllerBlock,
+        sizeof(controllerBlock));
+  }
+
+  /// Creates a versioned frame with a ring payload that has the specified number of slots, each
+  /// holding one controller block, with all slots empty.
+  /// @param [in] slotCount Number of slots in the ring.
+  /// @return Buffer holding the frame.
+  static std::vector<uint8_t> CreateRingFrame(uint32_t slotCount)
+  {
+    std::vector<uint8_t> frame(kRingSlotOffset + (RingSlotSizeBytes(1) * slotCount), 0);
+
+    const SFrameHeader header = {
+        .magic = kFrameMagic,
+        .version = kFrameVersion,
+        .payloadFormat = static_cast<uint16_t>(EPayloadFormat::Ring),
+        .controllerCount = 1,
+        .payloadSizeBytes = (uint32_t)(frame.size() - sizeof(SFrameHeader))};
+    std::memcpy(frame.data(), &header, sizeof(header));
+
+    const SRingHeader ringHeader = {.slotCount = slotCount, .writeCount = 0};
+    std::memcpy(&frame[kRingHeaderOffset], &ringHeader, sizeof(ringHeader));
+
+    return frame;
+  }
+
+  /// Writes the next frame into a ring payload, in the same way as a producer would, supplying a
+  /// value for the X axis of the only controller.
+  /// @param [in,out] frame Frame holding the ring payload to be modified.
+  /// @param [in] timestamp Timestamp of the frame being written.
+  /// @param [in] axisValue Value of the X axis in the frame being written.
+  static void WriteRingFrame(std::vector<uint8_t>& frame, uint32_t timestamp, int32_t axisValue)
+  {
+    SRingHeader ringHeader;
+    std::memcpy(&ringHeader, &frame[kRingHeaderOffset], sizeof(ringHeader));
+
+    const uint32_t frameNumber = ringHeader.writeCount + 1;
+    uint8_t* const slot = &frame
+        [kRingSlotOffset + (RingSlotSizeBytes(1) * ((frameNumber - 1) % ringHeader.slotCount))];
+
+    const SRingSlotHeader slotHeader = {.frameNumber = frameNumber, .timestamp = timestamp};
+    std::memcpy(slot, &slotHeader, sizeof(slotHeader));
+
+    const SControllerBlock controllerBlock = {.axis = {axisValue}};
+    std::memcpy(
+        &slot[sizeof(SRingSlotHeader) + sizeof(SKeyboardBlock) + sizeof(SMouseBlock)],
+        &controllerBlock,
+        sizeof(controllerBlock));
+
+    ringHeader.writeCount = frameNumber;
+    std::memcpy(&frame[kRingHeaderOffset], &ringHeader, sizeof(ringHeader));
+  }
+
+  /// Writes the next frame into a ring payload as a delta frame, in the same way as a producer
+  /// would.
+  /// @param [in,out] frame Frame holding the ring payload to be modified.
+  /// @param [in] timestamp Timestamp of the frame being written.
+  /// @param [in] flags Delta flags, other than the delta flag itself, to write to the slot header.
+  /// @param [in] deltaBlocks Blocks that follow the slot header, already tightly packed.
+  static void WriteRingDeltaFrame(
+      std::vector<uint8_t>& frame,
+      uint32_t timestamp,
+      uint32_t flags,
+      const std::vector<uint8_t>& deltaBlocks)
+  {
+    SRingHeader ringHeader;
+    std::memcpy(&ringHeader, &frame[kRingHeaderOffset], sizeof(ringHeader));
+
+    const uint32_t frameNumber = ringHeader.writeCount + 1;
+    uint8_t* const slot = &frame
+        [kRingSlotOffset + (RingSlotSizeBytes(1) * ((frameNumber - 1) % ringHeader.slotCount))];
+
+    const SRingSlotHeader slotHeader = {
+        .frameNumber = frameNumber, .timestamp = timestamp, .flags = (kRingSlotFlagDelta | flags)};
+    std::memcpy(slot, &slotHeader, sizeof(slotHeader));
+    std::memcpy(&slot[sizeof(SRingSlotHeader)], deltaBlocks.data(), deltaBlocks.size());
+
+    ringHeader.writeCount = frameNumber;
+    std::memcpy(&frame[kRingHeaderOffset], &ringHeader, sizeof(ringHeader));
+  }
+
+  /// Appends the bytes of an object to a buffer of tightly-packed delta blocks.
+  /// @tparam ObjectType Type of object to append.
+  /// @param [in,out] deltaBlocks Buffer to which the object is appended.
+  /// @param [in] object Object to append.
+  template <typename ObjectType> static void AppendDeltaBlock(
+      std::vector<uint8_t>& deltaBlocks, const ObjectType& object)
+  {
+    const uint8_t* const objectBytes = reinterpret_cast<const uint8_t*>(&object);
+    deltaBlocks.insert(deltaBlocks.end(), objectBytes, &objectBytes[sizeof(object)]);
+  }
+
+  // Verifies that a binary controller block is decoded into an overlay that supplies every
+  // element and that applying it replaces the entire state.
+  TEST_CASE(SharedMemoryInput_Binary_ControllerBlock)
+  {
+    SControllerBlock controllerBlock = {
+        .axis = {1, -2, 3, -4, 5, -6, 7, -8},
+        .button = {0x8000000000000005ull, 0x0000000000000002ull},
+        .povDirection = {0, 1, 0, 1}};
+
+    std::vector<uint8_t> frame = CreateBinaryFrame(2);
+    WriteControllerBlock(frame, 1, controllerBlock);
+
+    SState expectedState = {.axis = {1, -2, 3, -4, 5, -6, 7, -8}};
+    expectedState[EButton::B1] = true;
+    expectedState[EButton::B3] = true;
+    expectedState[EButton::B64] = true;
+    expectedState[EButton::B66] = true;
+    expectedState[EPovDirection::Down] = true;
+    expectedState[EPovDirection::Right] = true;
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == DecodeFrame(frame.data(), frame.size(), actualInput));
+
+    const SStateOverlay& actualOverlay = actualInput.controller[1];
+    TEST_ASSERT(true == actualOverlay.axisPresent.all());
+    TEST_ASSERT(true == actualOverlay.buttonPresent.all());
+    TEST_ASSERT(true == actualOverlay.povDirectionPresent.all());
+
+    SState actualState = {.axis = {100, 200, 300, 400, 500, 600, 700, 800}};
+    actualState[EButton::B2] = true;
+    actualState[EPovDirection::Up] = true;
+    actualOverlay.ApplyTo(actualState);
+    TEST_ASSERT(actualState == expectedState);
+  }
+
+  // Verifies that controllers beyond the controller count in a binary frame receive no input, but
+  // the frame is still considered successfully decoded.
+  TEST_CASE(SharedMemoryInput_Binary_ControllerNotPresent)
+  {
+    const std::vector<uint8_t> frame = CreateBinaryFrame(1);
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == DecodeFrame(frame.data(), frame.size(), actualInput));
+    TEST_ASSERT(false == actualInput.controller[0].IsEmpty());
+
+    for (unsigned int i = 1; i < actualInput.controller.size(); ++i)
+      TEST_ASSERT(true == actualInput.controller[i].IsEmpty());
+  }
+
+  // Verifies that a binary frame can supply input for every controller that can be configured,
+  // including those beyond the ones backed by physical hardware, and that controller blocks beyond
+  // that maximum are ignored.
+  TEST_CASE(SharedMemoryInput_Binary_ControllersBeyondPhysical)
+  {
+    constexpr uint16_t kControllerCount = ::Xidi::Controller::kMaxControllerCount + 1;
+
+    std::vector<uint8_t> frame = CreateBinaryFrame(kControllerCount);
+    for (uint16_t i = 0; i < kControllerCount; ++i)
+      WriteControllerBlock(frame, i, {.axis = {(int32_t)(1 + i)}});
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == DecodeFrame(frame.data(), frame.size(), actualInput));
+    TEST_ASSERT(::Xidi::Controller::kMaxControllerCount == actualInput.controller.size());
+
+    for (unsigned int i = 0; i < actualInput.controller.size(); ++i)
+      TEST_ASSERT((int32_t)(1 + i) == actualInput.controller[i].values[EAxis::X]);
+  }
+
+  // Verifies that a binary frame whose controller count implies a payload larger than the
+  // readable region is rejected without reading beyond the bound.
+  TEST_CASE(SharedMemoryInput_Binary_Truncated)
+  {
+    const std::vector<uint8_t> frame = CreateBinaryFrame(4);
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(false == DecodeFrame(frame.data(), frame.size() - 1, actualInput));
+    TEST_ASSERT(actualInput == SFrameInput());
+  }
+
+  // Verifies that frames carrying an unrecognized version are rejected.
+  TEST_CASE(SharedMemoryInput_Binary_VersionMismatch)
+  {
+    std::vector<uint8_t> frame = CreateBinaryFrame(1);
+    reinterpret_cast<SFrameHeader*>(frame.data())->version = (kFrameVersion + 1);
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(false == DecodeFrame(frame.data(), frame.size(), actualInput));
+  }
+
+  // Verifies that the keyboard and mouse blocks of a binary frame are decoded.
+  TEST_CASE(SharedMemoryInput_Binary_KeyboardMouse)
+  {
+    std::vector<uint8_t> frame = CreateBinaryFrame(1);
+
+    SKeyboardBlock keyboardBlock = {.pressedCount = 2, .releasedCount = 1};
+    keyboardBlock.pressed[0] = 30;
+    keyboardBlock.pressed[1] = 255;
+    keyboardBlock.released[0] = 31;
+    std::memcpy(&frame[kKeyboardBlockOffset], &keyboardBlock, sizeof(keyboardBlock));
+
+    const SMouseBlock mouseBlock = {
+        .flags = (kMouseBlockFlagButtons | kMouseBlockFlagMovement),
+        .button = {1, 0, 0, 0, 1},
+        .movement = {10, -20, 0, 30}};
+    std::memcpy(&frame[kMouseBlockOffset], &mouseBlock, sizeof(mouseBlock));
+
+    SKeyboardMouseInput expectedInput = {};
+    expectedInput.keyPressed[30] = true;
+    expectedInput.keyPressed[255] = true;
+    expectedInput.keyReleased[31] = true;
+    expectedInput.mouseButtonPresent.set();
+    expectedInput.mouseButtonPressed[static_cast<int>(EMouseButton::Left)] = true;
+    expectedInput.mouseButtonPressed[static_cast<int>(EMouseButton::X2)] = true;
+    expectedInput.mouseMovementPresent.set();
+    expectedInput.mouseMovement = {10, -20, 0, 30};
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == DecodeFrame(frame.data(), frame.size(), actualInput));
+    TEST_ASSERT(actualInput.keyboardMouse == expectedInput);
+  }
+
+  // Verifies that a keyboard block flagged as holding a key state bitmap is decoded into a key
+  // state, ignoring the pressed and released counts.
+  TEST_CASE(SharedMemoryInput_Binary_KeyStateBitmap)
+  {
+    std::vector<uint8_t> frame = CreateBinaryFrame(1);
+
+    SKeyboardBlock keyboardBlock = {
+        .pressedCount = 1, .releasedCount = 1, .flags = kKeyboardBlockFlagBitmap};
+    keyboardBlock.pressed[0] = 0x01;
+    keyboardBlock.pressed[8] = 0x02;
+    keyboardBlock.pressed[31] = 0x80;
+    keyboardBlock.released[0] = 31;
+    std::memcpy(&frame[kKeyboardBlockOffset], &keyboardBlock, sizeof(keyboardBlock));
+
+    SKeyboardMouseInput expectedInput = {};
+    expectedInput.keyStatePresent = true;
+    expectedInput.keyState = {1ull << 0, 1ull << 1, 0, 1ull << 63};
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == DecodeFrame(frame.data(), frame.size(), actualInput));
+    TEST_ASSERT(actualInput.keyboardMouse == expectedInput);
+  }
+
+  // Verifies that submitting a key state only submits the keys whose states differ from the
+  // previously-submitted key state, pressing and releasing them as appropriate.
+  TEST_CASE(SharedMemoryInput_SubmitKeyState)
+  {
+    SKeyboardMouseInput firstInput = {.keyStatePresent = true};
+    firstInput.keyState[0] = (1ull << 1);
+    firstInput.keyState[1] = (1ull << (70 - 64));
+
+    SKeyboardMouseInput secondInput = {.keyStatePresent = true};
+    secondInput.keyState[1] = (1ull << (70 - 64));
+    secondInput.keyState[3] = (1ull << (200 - 192));
+
+    MockKeyboard expectedFirstKeyboardState;
+    expectedFirstKeyboardState.SubmitKeyPressedState(1);
+    expectedFirstKeyboardState.SubmitKeyPressedState(70);
+
+    MockKeyboard expectedSecondKeyboardState;
+    expectedSecondKeyboardState.SubmitKeyPressedState(70);
+    expectedSecondKeyboardState.SubmitKeyPressedState(200);
+
+    MockKeyboard actualKeyboardState;
+    actualKeyboardState.BeginCapture();
+    SubmitKeyboardMouseInput(firstInput, SKeyboardMouseInput());
+    TEST_ASSERT(actualKeyboardState == expectedFirstKeyboardState);
+    SubmitKeyboardMouseInput(secondInput, firstInput);
+    TEST_ASSERT(actualKeyboardState == expectedSecondKeyboardState);
+    SubmitKeyboardMouseInput(SKeyboardMouseInput(), secondInput);
+    TEST_ASSERT(actualKeyboardState == MockKeyboard());
+    actualKeyboardState.EndCapture();
+  }
+
+  // Verifies that keys flagged as pressed or released are submitted, including keys that fall in
+  // different words of the underlying bitmap, and that pressed keys are submitted before released
+  // keys.
+  TEST_CASE(SharedMemoryInput_SubmitKeyPressedReleased)
+  {
+    SKeyboardMouseInput input = {};
+    input.keyPressed[2] = true;
+    input.keyPressed[130] = true;
+    input.keyPressed[255] = true;
+    input.keyReleased[130] = true;
+
+    MockKeyboard expectedKeyboardState;
+    expectedKeyboardState.SubmitKeyPressedState(2);
+    expectedKeyboardState.SubmitKeyPressedState(255);
+
+    MockKeyboard actualKeyboardState;
+    actualKeyboardState.BeginCapture();
+    SubmitKeyboardMouseInput(input, SKeyboardMouseInput());
+    actualKeyboardState.EndCapture();
+
+    TEST_ASSERT(actualKeyboardState == expectedKeyboardState);
+  }
+
+  // Verifies that a mouse block flagged as holding relative motion accumulators is decoded into
+  // relative motion rather than movement, even if it is also flagged as holding movement.
+  TEST_CASE(SharedMemoryInput_Binary_MouseMotion)
+  {
+    std::vector<uint8_t> frame = CreateBinaryFrame(1);
+
+    const SMouseBlock mouseBlock = {
+        .flags = (kMouseBlockFlagMovement | kMouseBlockFlagMotion), .movement = {10, -20, 0, 30}};
+    std::memcpy(&frame[kMouseBlockOffset], &mouseBlock, sizeof(mouseBlock));
+
+    SKeyboardMouseInput expectedInput = {};
+    expectedInput.mouseMotionPresent.set();
+    expectedInput.mouseMotion = {10, -20, 0, 30};
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == DecodeFrame(frame.data(), frame.size(), actualInput));
+    TEST_ASSERT(actualInput.keyboardMouse == expectedInput);
+  }
+
+  // Verifies that draining relative motion accumulators yields exactly the motion added since the
+  // previous drain, that the first drain only establishes the cursor, that axes without motion
+  // are marked as not supplied, and that running totals can wrap around.
+  TEST_CASE(SharedMemoryInput_DrainMouseMotion)
+  {
+    constexpr int kAxisX = static_cast<int>(EMouseAxis::X);
+    constexpr int kAxisY = static_cast<int>(EMouseAxis::Y);
+
+    SMouseMotionCursor cursor = {};
+    SKeyboardMouseInput input = {};
+
+    input.mouseMotionPresent[kAxisX] = true;
+    input.mouseMotion[kAxisX] = 1000;
+    DrainMouseMotion(input, cursor);
+    TEST_ASSERT(input == SKeyboardMouseInput());
+
+    input.mouseMotionPresent[kAxisX] = true;
+    input.mouseMotionPresent[kAxisY] = true;
+    input.mouseMotion[kAxisX] = 1015;
+    input.mouseMotion[kAxisY] = -4;
+    DrainMouseMotion(input, cursor);
+
+    SKeyboardMouseInput expectedInput = {};
+    expectedInput.mouseMotionPresent[kAxisX] = true;
+    expectedInput.mouseMotion[kAxisX] = 15;
+    TEST_ASSERT(input == expectedInput);
+
+    input.mouseMotionPresent[kAxisX] = true;
+    input.mouseMotionPresent[kAxisY] = true;
+    input.mouseMotion[kAxisX] = 1015;
+    input.mouseMotion[kAxisY] = -10;
+    DrainMouseMotion(input, cursor);
+
+    expectedInput = {};
+    expectedInput.mouseMotionPresent[kAxisY] = true;
+    expectedInput.mouseMotion[kAxisY] = -6;
+    TEST_ASSERT(input == expectedInput);
+
+    cursor.total[kAxisX] = INT32_MAX - 2;
+    input = {};
+    input.mouseMotionPresent[kAxisX] = true;
+    input.mouseMotion[kAxisX] = INT32_MIN + 2;
+    DrainMouseMotion(input, cursor);
+
+    expectedInput = {};
+    expectedInput.mouseMotionPresent[kAxisX] = true;
+    expectedInput.mouseMotion[kAxisX] = 5;
+    TEST_ASSERT(input == expectedInput);
+  }
+
+  // Verifies that the generation counter and producer instance identifier are read from versioned
+  // frames and that frames without them, including legacy frames, report values of 0.
+  TEST_CASE(SharedMemoryInput_GenerationAndInstance)
+  {
+    constexpr uint32_t kTestGeneration = 1234;
+    constexpr uint32_t kTestInstanceIdentifier = 5678;
+    constexpr std::string_view kJsonText = R"([{"X": 1234}])";
+
+    std::vector<uint8_t> frame = CreateBinaryFrame(1);
+    TEST_ASSERT(0 == GetFrameGeneration(frame.data(), frame.size()));
+    TEST_ASSERT(0 == GetFrameInstanceIdentifier(frame.data(), frame.size()));
+
+    reinterpret_cast<SFrameHeader*>(frame.data())->generation = kTestGeneration;
+    reinterpret_cast<SFrameHeader*>(frame.data())->instanceIdentifier = kTestInstanceIdentifier;
+    TEST_ASSERT(kTestGeneration == GetFrameGeneration(frame.data(), frame.size()));
+    TEST_ASSERT(kTestInstanceIdentifier == GetFrameInstanceIdentifier(frame.data(), frame.size()));
+    TEST_ASSERT(0 == GetFrameGeneration(frame.data(), sizeof(SFrameHeader) - 1));
+    TEST_ASSERT(0 == GetFrameInstanceIdentifier(frame.data(), sizeof(SFrameHeader) - 1));
+    TEST_ASSERT(0 == GetFrameGeneration(kJsonText.data(), kJsonText.size()));
+    TEST_ASSERT(0 == GetFrameInstanceIdentifier(kJsonText.data(), kJsonText.size()));
+  }
+
+  // Verifies that a legacy frame, consisting only of JSON text, is decoded and that only the
+  // elements it mentions are marked as present.
+  TEST_CASE(SharedMemoryInput_Json_Legacy)
+  {
+    constexpr std::string_view kJsonText =
+        R"([{"b1": 1}, {"X": 1234, "Dial": -5, "b2": 1, "b128": true, "b5": 0, "Left": 1}])";
+
+    SStateOverlay expectedOverlay = {};
+    expectedOverlay.values[EAxis::X] = 1234;
+    expectedOverlay.values[EAxis::Dial] = -5;
+    expectedOverlay.values[EButton::B2] = true;
+    expectedOverlay.values[EButton::B128] = true;
+    expectedOverlay.values[EPovDirection::Left] = true;
+    expectedOverlay.axisPresent[static_cast<int>(EAxis::X)] = true;
+    expectedOverlay.axisPresent[static_cast<int>(EAxis::Dial)] = true;
+    expectedOverlay.buttonPresent[static_cast<int>(EButton::B2)] = true;
+    expectedOverlay.buttonPresent[static_cast<int>(EButton::B5)] = true;
+    expectedOverlay.buttonPresent[static_cast<int>(EButton::B128)] = true;
+    expectedOverlay.povDirectionPresent[static_cast<int>(EPovDirection::Left)] = true;
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == DecodeFrame(kJsonText.data(), kJsonText.size(), actualInput));
+    TEST_ASSERT(true == actualInput.controller[0].buttonPresent[static_cast<int>(EButton::B1)]);
+    TEST_ASSERT(actualInput.controller[1] == expectedOverlay);
+    TEST_ASSERT(true == actualInput.controller[2].IsEmpty());
+  }
+
+  // Verifies that a versioned frame can select a JSON payload, and that keyboard and mouse input
+  // are taken from the object for the first controller.
+  TEST_CASE(SharedMemoryInput_Json_Versioned)
+  {
+    constexpr std::string_view kJsonText =
+        R"([{"keyboard": {"pressed": [16, 17], "released": [18]}, )"
+        R"("mouse": {"right": 1, "mouseMove": 1, "x": 5, "wheelY": -7}}])";
+
+    std::vector<uint8_t> frame(sizeof(SFrameHeader) + kJsonText.size(), 0);
+    const SFrameHeader header = {
+        .magic = kFrameMagic,
+        .version = kFrameVersion,
+        .payloadFormat = static_cast<uint16_t>(EPayloadFormat::Json),
+        .payloadSizeBytes = (uint32_t)kJsonText.size()};
+    std::memcpy(frame.data(), &header, sizeof(header));
+    std::memcpy(&frame[sizeof(header)], kJsonText.data(), kJsonText.size());
+
+    SKeyboardMouseInput expectedInput = {};
+    expectedInput.keyPressed[16] = true;
+    expectedInput.keyPressed[17] = true;
+    expectedInput.keyReleased[18] = true;
+    expectedInput.mouseButtonPresent[static_cast<int>(EMouseButton::Right)] = true;
+    expectedInput.mouseButtonPressed[static_cast<int>(EMouseButton::Right)] = true;
+    expectedInput.mouseMovementPresent[static_cast<int>(EMouseAxis::X)] = true;
+    expectedInput.mouseMovementPresent[static_cast<int>(EMouseAxis::WheelVertical)] = true;
+    expectedInput.mouseMovement[static_cast<int>(EMouseAxis::X)] = 5;
+    expectedInput.mouseMovement[static_cast<int>(EMouseAxis::WheelVertical)] = -7;
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == DecodeFrame(frame.data(), frame.size(), actualInput));
+    TEST_ASSERT(true == actualInput.controller[0].IsEmpty());
+    TEST_ASSERT(actualInput.keyboardMouse == expectedInput);
+  }
+
+  // Verifies that malformed JSON text is rejected.
+  TEST_CASE(SharedMemoryInput_Json_Malformed)
+  {
+    constexpr std::string_view kJsonText = R"([{"X": 1234)";
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(false == DecodeFrame(kJsonText.data(), kJsonText.size(), actualInput));
+    TEST_ASSERT(actualInput == SFrameInput());
+  }
+
+  // Verifies that every frame still held in a ring is decoded with its own contents and timestamp,
+  // that frames already overwritten or not yet written are not, and that decoding the frame as a
+  // whole produces its most recent frame.
+  TEST_CASE(SharedMemoryInput_Ring_Nominal)
+  {
+    constexpr uint32_t kSlotCount = 4;
+    constexpr uint32_t kFramesWritten = 6;
+
+    std::vector<uint8_t> frame = CreateRingFrame(kSlotCount);
+    for (uint32_t i = 1; i <= kFramesWritten; ++i)
+      WriteRingFrame(frame, 1000 + i, (int32_t)(100 * i));
+
+    for (uint32_t frameNumber = 0; frameNumber <= (kFramesWritten + 1); ++frameNumber)
+    {
+      const bool frameIsInRing =
+          ((frameNumber > (kFramesWritten - kSlotCount)) && (frameNumber <= kFramesWritten));
+
+      SFrameInput actualInput = {};
+      TEST_ASSERT(
+          frameIsInRing ==
+          DecodeRingFrame(frame.data(), frame.size(), frameNumber, SFrameInput(), actualInput));
+
+      if (true == frameIsInRing)
+      {
+        TEST_ASSERT((1000 + frameNumber) == actualInput.timestamp);
+        TEST_ASSERT((int32_t)(100 * frameNumber) == actualInput.controller[0].values[EAxis::X]);
+        TEST_ASSERT(true == actualInput.controller[0].axisPresent.all());
+        TEST_ASSERT(true == actualInput.controller[1].IsEmpty());
+      }
+      else
+      {
+        TEST_ASSERT(actualInput == SFrameInput());
+      }
+    }
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == DecodeFrame(frame.data(), frame.size(), actualInput));
+    TEST_ASSERT((1000 + kFramesWritten) == actualInput.timestamp);
+    TEST_ASSERT((int32_t)(100 * kFramesWritten) == actualInput.controller[0].values[EAxis::X]);
+  }
+
+  // Verifies that a slot the producer is in the middle of writing is not decoded.
+  TEST_CASE(SharedMemoryInput_Ring_SlotBeingWritten)
+  {
+    std::vector<uint8_t> frame = CreateRingFrame(2);
+    WriteRingFrame(frame, 1000, 100);
+
+    reinterpret_cast<SRingSlotHeader*>(&frame[kRingSlotOffset])->frameNumber = 0;
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(
+        false == DecodeRingFrame(frame.data(), frame.size(), 1, SFrameInput(), actualInput));
+    TEST_ASSERT(false == DecodeFrame(frame.data(), frame.size(), actualInput));
+  }
+
+  // Verifies that rings which do not fit within the frame, or which have no slots, are rejected.
+  TEST_CASE(SharedMemoryInput_Ring_Invalid)
+  {
+    std::vector<uint8_t> frame = CreateRingFrame(2);
+    WriteRingFrame(frame, 1000, 100);
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(
+        false ==
+        DecodeRingFrame(frame.data(), frame.size() - 1, 1, SFrameInput(), actualInput));
+
+    reinterpret_cast<SRingHeader*>(&frame[kRingHeaderOffset])->slotCount = 0;
+    TEST_ASSERT(
+        false == DecodeRingFrame(frame.data(), frame.size(), 1, SFrameInput(), actualInput));
+
+    std::vector<uint8_t> binaryFrame = CreateBinaryFrame(1);
+    TEST_ASSERT(
+        false ==
+        DecodeRingFrame(binaryFrame.data(), binaryFrame.size(), 1, SFrameInput(), actualInput));
+  }
+
+  // Verifies that a delta frame changes only the elements it flags, that everything else is
+  // carried over from the preceding frame, and that keyboard and mouse blocks are replaced only if
+  // present.
+  TEST_CASE(SharedMemoryInput_Ring_DeltaFrame)
+  {
+    std::vector<uint8_t> frame = CreateRingFrame(4);
+    WriteRingFrame(frame, 1000, 100);
+
+    std::vector<uint8_t> deltaBlocks;
+    AppendDeltaBlock(deltaBlocks, SMouseBlock({.flags = kMouseBlockFlagMovement, .movement = {3}}));
+    AppendDeltaBlock(
+        deltaBlocks,
+        SControllerDeltaHeader(
+            {.axisMask = (1 << static_cast<int>(EAxis::Y)) | (1 << static_cast<int>(EAxis::Dial)),
+             .buttonGroupMask = 0b10,
+             .povDirectionMask = (1 << static_cast<int>(EPovDirection::Up)),
+             .povDirectionValue = (1 << static_cast<int>(EPovDirection::Up))}));
+    AppendDeltaBlock(deltaBlocks, (uint64_t)0b101);
+    AppendDeltaBlock(deltaBlocks, (uint64_t)0b001);
+    AppendDeltaBlock(deltaBlocks, (int32_t)-5);
+    AppendDeltaBlock(deltaBlocks, (int32_t)7);
+    WriteRingDeltaFrame(frame, 1001, kRingSlotFlagDeltaMouse, deltaBlocks);
+
+    SFrameInput previousInput = {};
+    TEST_ASSERT(
+        true == DecodeRingFrame(frame.data(), frame.size(), 1, SFrameInput(), previousInput));
+    previousInput.keyboardMouse.keyPressed[5] = true;
+
+    SFrameInput expectedInput = previousInput;
+    expectedInput.timestamp = 1001;
+    expectedInput.controller[0].values[EAxis::Y] = -5;
+    expectedInput.controller[0].values[EAxis::Dial] = 7;
+    expectedInput.controller[0].values.button[64] = true;
+    expectedInput.controller[0].values.button[66] = false;
+    expectedInput.controller[0].values.povDirection.components[static_cast<int>(
+        EPovDirection::Up)] = true;
+    expectedInput.keyboardMouse.mouseMovementPresent.set();
+    expectedInput.keyboardMouse.mouseMovement[static_cast<int>(EMouseAxis::X)] = 3;
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == DecodeRingFrame(frame.data(), frame.size(), 2, previousInput, actualInput));
+    TEST_ASSERT(actualInput == expectedInput);
+  }
+
+  // Verifies that decoding a ring as a whole reconstructs the input of a delta frame from the most
+  // recent full frame, and fails once that full frame has been overwritten.
+  TEST_CASE(SharedMemoryInput_Ring_DeltaReconstruction)
+  {
+    std::vector<uint8_t> frame = CreateRingFrame(2);
+    WriteRingFrame(frame, 1000, 100);
+
+    std::vector<uint8_t> deltaBlocks;
+    AppendDeltaBlock(
+        deltaBlocks, SControllerDeltaHeader({.axisMask = (1 << static_cast<int>(EAxis::Y))}));
+    AppendDeltaBlock(deltaBlocks, (int32_t)-5);
+    WriteRingDeltaFrame(frame, 1001, 0, deltaBlocks);
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == DecodeFrame(frame.data(), frame.size(), actualInput));
+    TEST_ASSERT(1001 == actualInput.timestamp);
+    TEST_ASSERT(100 == actualInput.controller[0].values[EAxis::X]);
+    TEST_ASSERT(-5 == actualInput.controller[0].values[EAxis::Y]);
+
+    WriteRingDeltaFrame(frame, 1002, 0, deltaBlocks);
+    TEST_ASSERT(false == DecodeFrame(frame.data(), frame.size(), actualInput));
+  }
+
+  // Verifies that a delta frame which flags button groups that do not exist is rejected.
+  TEST_CASE(SharedMemoryInput_Ring_DeltaInvalid)
+  {
+    std::vector<uint8_t> frame = CreateRingFrame(2);
+    WriteRingFrame(frame, 1000, 100);
+
+    std::vector<uint8_t> deltaBlocks;
+    AppendDeltaBlock(deltaBlocks, SControllerDeltaHeader({.buttonGroupMask = 0b100}));
+    WriteRingDeltaFrame(frame, 1001, 0, deltaBlocks);
+
+    SFrameInput previousInput = {};
+    TEST_ASSERT(
+        true == DecodeRingFrame(frame.data(), frame.size(), 1, SFrameInput(), previousInput));
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(
+        false == DecodeRingFrame(frame.data(), frame.size(), 2, previousInput, actualInput));
+    TEST_ASSERT(actualInput == SFrameInput());
+  }
+
+  // Verifies that merge policies are recognized irrespective of case and that anything else is
+  // rejected.
+  TEST_CASE(SharedMemoryInput_Merge_PolicyFromString)
+  {
+    TEST_ASSERT(EMergePolicy::Or == MergePolicyFromString(L"Or"));
+    TEST_ASSERT(EMergePolicy::Sum == MergePolicyFromString(L"sum"));
+    TEST_ASSERT(EMergePolicy::Max == MergePolicyFromString(L"MAX"));
+    TEST_ASSERT(EMergePolicy::Priority == MergePolicyFromString(L"Priority"));
+
+    for (std::wstring_view unrecognizedString : {L"", L"Or ", L"Average", L"Prio"})
+      TEST_ASSERT(false == MergePolicyFromString(unrecognizedString).has_value());
+  }
+
+  // Verifies that each axis merge policy combines only the channels that supply the axis, and
+  // that axes no channel supplies remain absent.
+  TEST_CASE(SharedMemoryInput_Merge_Axes)
+  {
+    SFrameInput channelInputs[3] = {};
+    channelInputs[1].controller[0].values[EAxis::X] = 20000;
+    channelInputs[1].controller[0].axisPresent[static_cast<int>(EAxis::X)] = true;
+    channelInputs[2].controller[0].values[EAxis::X] = 30000;
+    channelInputs[2].controller[0].axisPresent[static_cast<int>(EAxis::X)] = true;
+    channelInputs[0].controller[0].values[EAxis::Y] = 100;
+    channelInputs[0].controller[0].axisPresent[static_cast<int>(EAxis::Y)] = true;
+    channelInputs[2].controller[0].values[EAxis::Y] = -5000;
+    channelInputs[2].controller[0].axisPresent[static_cast<int>(EAxis::Y)] = true;
+
+    constexpr struct
+    {
+      EMergePolicy policy;
+      int32_t expectedX;
+      int32_t expectedY;
+    } kTestRecords[] = {
+        {.policy = EMergePolicy::Priority, .expectedX = 20000, .expectedY = 100},
+        {.policy = EMergePolicy::Max, .expectedX = 30000, .expectedY = -5000},
+        {.policy = EMergePolicy::Sum,
+         .expectedX = ::Xidi::Controller::kAnalogValueMax,
+         .expectedY = -4900},
+    };
+
+    for (const auto& testRecord : kTestRecords)
+    {
+      SMergePolicy mergePolicy = {};
+      mergePolicy.axis.fill(testRecord.policy);
+
+      SFrameInput actualInput = {};
+      MergeFrameInputs(channelInputs, _countof(channelInputs), mergePolicy, actualInput);
+
+      const SStateOverlay& actualOverlay = actualInput.controller[0];
+      TEST_ASSERT(2 == actualOverlay.axisPresent.count());
+      TEST_ASSERT(testRecord.expectedX == actualOverlay.values[EAxis::X]);
+      TEST_ASSERT(testRecord.expectedY == actualOverlay.values[EAxis::Y]);
+      TEST_ASSERT(true == actualInput.controller[1].IsEmpty());
+    }
+  }
+
+  // Verifies that buttons and POV directions are combined using either the OR policy or the
+  // priority policy.
+  TEST_CASE(SharedMemoryInput_Merge_ButtonsAndPov)
+  {
+    SFrameInput channelInputs[2] = {};
+    channelInputs[0].controller[0].values[EButton::B1] = false;
+    channelInputs[0].controller[0].buttonPresent[static_cast<int>(EButton::B1)] = true;
+    channelInputs[1].controller[0].values[EButton::B1] = true;
+    channelInputs[1].controller[0].buttonPresent[static_cast<int>(EButton::B1)] = true;
+    channelInputs[1].controller[0].values[EButton::B2] = true;
+    channelInputs[1].controller[0].buttonPresent[static_cast<int>(EButton::B2)] = true;
+    channelInputs[0].controller[0].povDirectionPresent[static_cast<int>(EPovDirection::Up)] =
+        true;
+    channelInputs[1].controller[0].values.povDirection.components[static_cast<int>(
+        EPovDirection::Up)] = true;
+    channelInputs[1].controller[0].povDirectionPresent[static_cast<int>(EPovDirection::Up)] =
+        true;
+
+    SFrameInput actualInput = {};
+    MergeFrameInputs(channelInputs, _countof(channelInputs), SMergePolicy(), actualInput);
+    TEST_ASSERT(true == actualInput.controller[0].values[EButton::B1]);
+    TEST_ASSERT(true == actualInput.controller[0].values[EButton::B2]);
+    TEST_ASSERT(true == actualInput.controller[0].values[EPovDirection::Up]);
+
+    MergeFrameInputs(
+        channelInputs,
+        _countof(channelInputs),
+        SMergePolicy({.button = EMergePolicy::Priority}),
+        actualInput);
+    TEST_ASSERT(false == actualInput.controller[0].values[EButton::B1]);
+    TEST_ASSERT(true == actualInput.controller[0].values[EButton::B2]);
+    TEST_ASSERT(false == actualInput.controller[0].values[EPovDirection::Up]);
+    TEST_ASSERT(2 == actualInput.controller[0].buttonPresent.count());
+  }
+
+  // Verifies that keys and mouse buttons from all channels are combined and that mouse movement
+  // is summed.
+  TEST_CASE(SharedMemoryInput_Merge_KeyboardMouse)
+  {
+    SFrameInput channelInputs[2] = {};
+    channelInputs[0].keyboardMouse.keyPressed[1] = true;
+    channelInputs[1].keyboardMouse.keyPressed[2] = true;
+    channelInputs[1].keyboardMouse.keyReleased[3] = true;
+    channelInputs[0].keyboardMouse.mouseButtonPresent.set();
+    channelInputs[0].keyboardMouse.mouseButtonPressed[static_cast<int>(EMouseButton::Left)] =
+        true;
+    channelInputs[0].keyboardMouse.mouseMovementPresent.set();
+    channelInputs[0].keyboardMouse.mouseMovement[static_cast<int>(EMouseAxis::X)] = 5;
+    channelInputs[1].keyboardMouse.mouseMovementPresent[static_cast<int>(EMouseAxis::X)] = true;
+    channelInputs[1].keyboardMouse.mouseMovement[static_cast<int>(EMouseAxis::X)] = -8;
+    channelInputs[1].keyboardMouse.mouseMovement[static_cast<int>(EMouseAxis::Y)] = 100;
+
+    SKeyboardMouseInput expectedInput = {};
+    expectedInput.keyPressed[1] = true;
+    expectedInput.keyPressed[2] = true;
+    expectedInput.keyReleased[3] = true;
+    expectedInput.mouseButtonPresent.set();
+    expectedInput.mouseButtonPressed[static_cast<int>(EMouseButton::Left)] = true;
+    expectedInput.mouseMovementPresent.set();
+    expectedInput.mouseMovement[static_cast<int>(EMouseAxis::X)] = -3;
+
+    SFrameInput actualInput = {};
+    MergeFrameInputs(channelInputs, _countof(channelInputs), SMergePolicy(), actualInput);
+    TEST_ASSERT(actualInput.keyboardMouse == expectedInput);
+  }
+
+  // Verifies that a producer signalling the named event wakes a waiting reader exactly once per
+  // signal and that waiting times out when there is no signal.
+  TEST_CASE(SharedMemoryInput_FrameSignal)
+  {
+    const std::wstring producerEventName =
+        std::wstring(::Xidi::Strings::kStrSharedMemoryInputMappingName) +
+        std::wstring(::Xidi::Strings::kStrSharedMemoryInputEventNameSuffix);
+    const HANDLE producerEvent = CreateEventW(nullptr, FALSE, FALSE, producerEventName.c_str());
+    if (nullptr == producerEvent) TEST_FAILED_BECAUSE(L"Failed to create the producer event.");
+
+    TEST_ASSERT(false == WaitForFrameSignal(0));
+
+    SetEvent(producerEvent);
+    TEST_ASSERT(true == WaitForFrameSignal(1000));
+    TEST_ASSERT(false == WaitForFrameSignal(0));
+
+    CloseHandle(producerEvent);
+  }
+} // namespace XidiTest
@@ -0,0 +1,246 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file SharedMemoryJsonTest.cpp
+ *   Unit tests for parsing the JSON format that external producers can use to supply input via
+ *   shared memory.
+ **************************************************************************************************/
+
+#include "TestCase.h"
+
+#include "SharedMemoryJson.h"
+
+#include <climits>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "ControllerTypes.h"
+#include "Mouse.h"
+#include "SharedMemoryTypes.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::SharedMemory;
+  using ::Xidi::Controller::EAxis;
+  using ::Xidi::Controller::EButton;
+  using ::Xidi::Controller::EPovDirection;
+  using ::Xidi::Controller::SStateOverlay;
+  using ::Xidi::Mouse::EMouseAxis;
+  using ::Xidi::Mouse::EMouseButton;
+
+  /// Parses the specified JSON text in its entirety.
+  /// @param [in] jsonText JSON text to parse.
+  /// @param [out] frameInput Filled in with the parsed input.
+  /// @return Result of parsing the JSON text.
+  static bool ParseJsonText(std::string_view jsonText, SFrameInput& frameInput)
+  {
+    frameInput = {};
+    return ParseJsonFrame(jsonText.data(), jsonText.size(), frameInput);
+  }
+
+  // Verifies that all recognized object member names are found with the correct identification,
+  // and that similar but unrecognized names are not found.
+  TEST_CASE(SharedMemoryJson_LookupKey)
+  {
+    TEST_ASSERT(LookupJsonKey("X") == SJsonKey({EJsonKeyType::Axis, (uint8_t)EAxis::X}));
+    TEST_ASSERT(LookupJsonKey("Dial") == SJsonKey({EJsonKeyType::Axis, (uint8_t)EAxis::Dial}));
+    TEST_ASSERT(LookupJsonKey("b1") == SJsonKey({EJsonKeyType::Button, (uint8_t)EButton::B1}));
+    TEST_ASSERT(LookupJsonKey("b64") == SJsonKey({EJsonKeyType::Button, (uint8_t)EButton::B64}));
+    TEST_ASSERT(
+        LookupJsonKey("b128") == SJsonKey({EJsonKeyType::Button, (uint8_t)EButton::B128}));
+    TEST_ASSERT(
+        LookupJsonKey("Right") ==
+        SJsonKey({EJsonKeyType::PovDirection, (uint8_t)EPovDirection::Right}));
+    TEST_ASSERT(LookupJsonKey("keyboard") == SJsonKey({EJsonKeyType::Keyboard, 0}));
+    TEST_ASSERT(LookupJsonKey("released") == SJsonKey({EJsonKeyType::KeyboardReleased, 0}));
+    TEST_ASSERT(
+        LookupJsonKey("x2") == SJsonKey({EJsonKeyType::MouseButton, (uint8_t)EMouseButton::X2}));
+    TEST_ASSERT(LookupJsonKey("x") == SJsonKey({EJsonKeyType::MouseAxis, (uint8_t)EMouseAxis::X}));
+    TEST_ASSERT(LookupJsonKey("mouseMove") == SJsonKey({EJsonKeyType::MouseMove, 0}));
+    TEST_ASSERT(LookupJsonKey("mouseMotion") == SJsonKey({EJsonKeyType::MouseMotion, 0}));
+
+    for (std::string_view unrecognizedName :
+         {"", "b", "b0", "b129", "b01", "B1", "x3", "XX", "dial", "keyboards", "mouse "})
+      TEST_ASSERT(false == LookupJsonKey(unrecognizedName).has_value());
+  }
+
+  // Verifies that numbers are truncated towards zero and saturated, and that values of other types
+  // are interpreted as 1 for `true` and 0 for everything else.
+  TEST_CASE(SharedMemoryJson_ValueConversion)
+  {
+    constexpr std::string_view kJsonText =
+        "[ {\"X\" : 1.9, \"Y\":-2.9 ,\"Z\":1e3,\r\n\t\"RotX\": 1e20, \"RotY\": -1E+20, "
+        "\"RotZ\": true, \"Slider\": false, \"Dial\": \"12\", \"b1\": 0.5, \"b2\": null, "
+        "\"b3\": -7, \"Up\": [1]} ]";
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == ParseJsonText(kJsonText, actualInput));
+
+    const SStateOverlay& actualOverlay = actualInput.controller[0];
+    TEST_ASSERT(true == actualOverlay.axisPresent.all());
+    TEST_ASSERT(1 == actualOverlay.values[EAxis::X]);
+    TEST_ASSERT(-2 == actualOverlay.values[EAxis::Y]);
+    TEST_ASSERT(1000 == actualOverlay.values[EAxis::Z]);
+    TEST_ASSERT(INT_MAX == actualOverlay.values[EAxis::RotX]);
+    TEST_ASSERT(INT_MIN == actualOverlay.values[EAxis::RotY]);
+    TEST_ASSERT(1 == actualOverlay.values[EAxis::RotZ]);
+    TEST_ASSERT(0 == actualOverlay.values[EAxis::Slider]);
+    TEST_ASSERT(0 == actualOverlay.values[EAxis::Dial]);
+
+    TEST_ASSERT(3 == actualOverlay.buttonPresent.count());
+    TEST_ASSERT(false == actualOverlay.values[EButton::B1]);
+    TEST_ASSERT(false == actualOverlay.values[EButton::B2]);
+    TEST_ASSERT(true == actualOverlay.values[EButton::B3]);
+
+    TEST_ASSERT(true == actualOverlay.povDirectionPresent[static_cast<int>(EPovDirection::Up)]);
+    TEST_ASSERT(false == actualOverlay.values[EPovDirection::Up]);
+  }
+
+  // Verifies that unrecognized object members are skipped entirely, including any recognized names
+  // nested within them, and that escape sequences in strings do not confuse the parser.
+  TEST_CASE(SharedMemoryJson_UnrecognizedMembersSkipped)
+  {
+    constexpr std::string_view kJsonText =
+        R"([{"name": "a \"quoted\" } string \\", "extra": {"nested": [1, [2, {"b1": 1}], null]},)"
+        R"( "b2": 1, "b2": 1}, "not an object", {"keyboard": {"pressed": [1]}, "b3": 1}])";
+
+    SFrameInput expectedInput = {};
+    expectedInput.controller[0].values[EButton::B2] = true;
+    expectedInput.controller[0].buttonPresent[static_cast<int>(EButton::B2)] = true;
+    expectedInput.controller[2].values[EButton::B3] = true;
+    expectedInput.controller[2].buttonPresent[static_cast<int>(EButton::B3)] = true;
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == ParseJsonText(kJsonText, actualInput));
+    TEST_ASSERT(actualInput == expectedInput);
+  }
+
+  // Verifies that keyboard input is parsed, that out-of-range keys are ignored, and that mouse
+  // movement values are used only with a non-zero movement flag, irrespective of member order.
+  TEST_CASE(SharedMemoryJson_KeyboardMouse)
+  {
+    constexpr std::string_view kJsonTextWithMovement =
+        R"([{"mouse": {"x": 5, "wheelX": -3, "left": 1, "x2": 0, "mouseMove": 1},)"
+        R"( "keyboard": {"pressed": [1, 255, 256, -1], "released": [2], "other": [3]}}])";
+    constexpr std::string_view kJsonTextWithoutMovement =
+        R"([{"mouse": {"x": 5, "wheelX": -3, "mouseMove": 0}}])";
+
+    SKeyboardMouseInput expectedInput = {};
+    expectedInput.keyPressed[1] = true;
+    expectedInput.keyPressed[255] = true;
+    expectedInput.keyReleased[2] = true;
+    expectedInput.mouseButtonPresent[static_cast<int>(EMouseButton::Left)] = true;
+    expectedInput.mouseButtonPresent[static_cast<int>(EMouseButton::X2)] = true;
+    expectedInput.mouseButtonPressed[static_cast<int>(EMouseButton::Left)] = true;
+    expectedInput.mouseMovementPresent[static_cast<int>(EMouseAxis::X)] = true;
+    expectedInput.mouseMovementPresent[static_cast<int>(EMouseAxis::WheelHorizontal)] = true;
+    expectedInput.mouseMovement[static_cast<int>(EMouseAxis::X)] = 5;
+    expectedInput.mouseMovement[static_cast<int>(EMouseAxis::WheelHorizontal)] = -3;
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == ParseJsonText(kJsonTextWithMovement, actualInput));
+    TEST_ASSERT(actualInput.keyboardMouse == expectedInput);
+
+    TEST_ASSERT(true == ParseJsonText(kJsonTextWithoutMovement, actualInput));
+    TEST_ASSERT(actualInput.keyboardMouse == SKeyboardMouseInput());
+  }
+
+  // Verifies that a non-zero motion flag causes mouse movement values to be parsed as relative
+  // motion accumulators, even if the movement flag is also present.
+  TEST_CASE(SharedMemoryJson_MouseMotion)
+  {
+    constexpr std::string_view kJsonText =
+        R"([{"mouse": {"x": 700, "mouseMove": 1, "y": -2, "mouseMotion": 1}}])";
+
+    SKeyboardMouseInput expectedInput = {};
+    expectedInput.mouseMotionPresent[static_cast<int>(EMouseAxis::X)] = true;
+    expectedInput.mouseMotionPresent[static_cast<int>(EMouseAxis::Y)] = true;
+    expectedInput.mouseMotion[static_cast<int>(EMouseAxis::X)] = 700;
+    expectedInput.mouseMotion[static_cast<int>(EMouseAxis::Y)] = -2;
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == ParseJsonText(kJsonText, actualInput));
+    TEST_ASSERT(actualInput.keyboardMouse == expectedInput);
+  }
+
+  // Verifies that array elements beyond the number of controllers are skipped and that any valid
+  // JSON text that is not an array is accepted but supplies no input.
+  TEST_CASE(SharedMemoryJson_NotControllers)
+  {
+    constexpr std::string_view kJsonTextExtraControllers =
+        R"([{}, {}, {}, {"X": 1}, {"X": 2}, {"X": 3}])";
+    constexpr std::string_view kJsonTextObject = R"({"X": 1})";
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == ParseJsonText(kJsonTextExtraControllers, actualInput));
+    TEST_ASSERT(1 == actualInput.controller[3].values[EAxis::X]);
+
+    TEST_ASSERT(true == ParseJsonText(kJsonTextObject, actualInput));
+    TEST_ASSERT(actualInput == SFrameInput());
+  }
+
+  // Verifies that text ends at the first null character or at the length bound, whichever comes
+  // first, and that nothing beyond the end of the text is read.
+  TEST_CASE(SharedMemoryJson_TextBounds)
+  {
+    constexpr std::string_view kJsonTextNullTerminated("[{\"X\": 1}]\0[", 12);
+    constexpr std::string_view kJsonTextNullInside("[{\"X\": 1\0}]", 11);
+    constexpr std::string_view kJsonTextUnbounded = R"([{"X": 1}])";
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == ParseJsonText(kJsonTextNullTerminated, actualInput));
+    TEST_ASSERT(1 == actualInput.controller[0].values[EAxis::X]);
+
+    TEST_ASSERT(false == ParseJsonText(kJsonTextNullInside, actualInput));
+
+    actualInput = {};
+    TEST_ASSERT(
+        false ==
+        ParseJsonFrame(kJsonTextUnbounded.data(), kJsonTextUnbounded.size() - 1, actualInput));
+  }
+
+  // Verifies that malformed JSON text is rejected.
+  TEST_CASE(SharedMemoryJson_Malformed)
+  {
+    constexpr std::string_view kMalformedJsonTexts[] = {
+        "",
+        "   ",
+        "[",
+        "[{}",
+        "[{},]",
+        "[{\"X\" 1}]",
+        "[{\"X\": }]",
+        "[{\"X\": -}]",
+        "[{\"X\": 1,}]",
+        "[{\"X: 1}]",
+        "[{X: 1}]",
+        "[{\"X\": tru}]",
+        "[{\"X\": 1} {}]",
+        "[{\"X\": 1.2.3}]"};
+
+    for (std::string_view malformedJsonText : kMalformedJsonTexts)
+    {
+      SFrameInput actualInput = {};
+      TEST_ASSERT(false == ParseJsonText(malformedJsonText, actualInput));
+    }
+  }
+
+  // Verifies that nesting is accepted up to the maximum depth and rejected beyond it.
+  TEST_CASE(SharedMemoryJson_NestingDepth)
+  {
+    const std::string kJsonTextMaxDepth =
+        std::string(kJsonMaxNestingDepth, '[') + std::string(kJsonMaxNestingDepth, ']');
+    const std::string kJsonTextTooDeep =
+        std::string(kJsonMaxNestingDepth + 1, '[') + std::string(kJsonMaxNestingDepth + 1, ']');
+
+    SFrameInput actualInput = {};
+    TEST_ASSERT(true == ParseJsonText(kJsonTextMaxDepth, actualInput));
+    TEST_ASSERT(false == ParseJsonText(kJsonTextTooDeep, actualInput));
+  }
+} // namespace XidiTest
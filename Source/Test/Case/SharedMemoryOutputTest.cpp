@@ -0,0 +1,181 @@
+/***************************************************************************************************
+ * Xidi
+ *   DirectInput interface for XInput controllers.
+ ***************************************************************************************************
+ * Authored by Samuel Grossman
+ * Copyright (c) 2016-2023
+ ***********************************************************************************************//**
+ * @file SharedMemoryOutputTest.cpp
+ *   Unit tests for publishing force feedback output to external consumers via shared memory.
+ **************************************************************************************************/
+
+#include "TestCase.h"
+
+#include "SharedMemoryOutput.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "ApiWindows.h"
+#include "ForceFeedbackTypes.h"
+#include "SharedMemoryTypes.h"
+
+namespace XidiTest
+{
+  using namespace ::Xidi::SharedMemory;
+  using ::Xidi::Controller::ForceFeedback::SPhysicalActuatorComponents;
+
+  /// Number of controllers used throughout these tests.
+  static constexpr uint16_t kTestControllerCount = 3;
+
+  /// Retrieves a force feedback output record from a buffer that holds a mapping.
+  /// @param [in] output Buffer that holds the mapping.
+  /// @param [in] offset Byte offset of the first record in a contiguous group of records.
+  /// @param [in] index Index of the record within the group.
+  /// @return Read-only reference to the record.
+  static const SForceFeedbackOutputRecord& RecordAt(
+      const std::vector<uint8_t>& output, size_t offset, size_t index)
+  {
+    return reinterpret_cast<const SForceFeedbackOutputRecord*>(output.data() + offset)[index];
+  }
+
+  // Initializes a mapping and verifies that it holds no records and that every controller's
+  // current actuator values are zero.
+  TEST_CASE(SharedMemoryOutput_Initialize)
+  {
+    std::vector<uint8_t> output(ForceFeedbackOutputSizeBytes(kTestControllerCount), 0xcc);
+    InitializeForceFeedbackOutput(output.data(), kTestControllerCount, 1234);
+
+    const SForceFeedbackOutputHeader& header =
+        *reinterpret_cast<const SForceFeedbackOutputHeader*>(output.data());
+    TEST_ASSERT(kForceFeedbackOutputMagic == header.magic);
+    TEST_ASSERT(kForceFeedbackOutputVersion == header.version);
+    TEST_ASSERT(kTestControllerCount == header.controllerCount);
+    TEST_ASSERT(kForceFeedbackOutputSlotCount == header.slotCount);
+    TEST_ASSERT(0 == header.writeCount);
+    TEST_ASSERT(1234 == header.instanceIdentifier);
+
+    for (uint16_t i = 0; i < kTestControllerCount; ++i)
+    {
+      const SForceFeedbackOutputRecord& current =
+          RecordAt(output, kForceFeedbackOutputCurrentOffset, i);
+      TEST_ASSERT(0 == current.sequence);
+      TEST_ASSERT(i == current.controllerIdentifier);
+      for (uint16_t actuatorValue : current.actuator)
+        TEST_ASSERT(0 == actuatorValue);
+    }
+  }
+
+  // Writes records for two controllers and verifies that each appears both in the ring and as the
+  // controller's current actuator values, including the impulse triggers.
+  TEST_CASE(SharedMemoryOutput_Write)
+  {
+    std::vector<uint8_t> output(ForceFeedbackOutputSizeBytes(kTestControllerCount));
+    InitializeForceFeedbackOutput(output.data(), kTestControllerCount, 1);
+
+    const SPhysicalActuatorComponents kFirstValues = {
+        .leftMotor = 100, .rightMotor = 200, .leftImpulseTrigger = 300, .rightImpulseTrigger = 400};
+    const SPhysicalActuatorComponents kSecondValues = {.leftMotor = 65535};
+
+    WriteForceFeedbackOutput(output.data(), 2, kFirstValues, 10);
+    WriteForceFeedbackOutput(output.data(), 0, kSecondValues, 20);
+
+    const SForceFeedbackOutputHeader& header =
+        *reinterpret_cast<const SForceFeedbackOutputHeader*>(output.data());
+    TEST_ASSERT(2 == header.writeCount);
+
+    const size_t ringOffset = ForceFeedbackOutputRingOffset(kTestControllerCount);
+
+    const SForceFeedbackOutputRecord& firstRecord = RecordAt(output, ringOffset, 0);
+    TEST_ASSERT(1 == firstRecord.sequence);
+    TEST_ASSERT(10 == firstRecord.timestamp);
+    TEST_ASSERT(2 == firstRecord.controllerIdentifier);
+    TEST_ASSERT(100 == firstRecord.actuator[0]);
+    TEST_ASSERT(200 == firstRecord.actuator[1]);
+    TEST_ASSERT(300 == firstRecord.actuator[2]);
+    TEST_ASSERT(400 == firstRecord.actuator[3]);
+
+    const SForceFeedbackOutputRecord& secondRecord = RecordAt(output, ringOffset, 1);
+    TEST_ASSERT(2 == secondRecord.sequence);
+    TEST_ASSERT(0 == secondRecord.controllerIdentifier);
+    TEST_ASSERT(65535 == secondRecord.actuator[0]);
+
+    const SForceFeedbackOutputRecord& currentFirst =
+        RecordAt(output, kForceFeedbackOutputCurrentOffset, 2);
+    TEST_ASSERT(1 == currentFirst.sequence);
+    TEST_ASSERT(400 == currentFirst.actuator[3]);
+
+    const SForceFeedbackOutputRecord& currentSecond =
+        RecordAt(output, kForceFeedbackOutputCurrentOffset, 0);
+    TEST_ASSERT(2 == currentSecond.sequence);
+    TEST_ASSERT(20 == currentSecond.timestamp);
+
+    TEST_ASSERT(0 == RecordAt(output, kForceFeedbackOutputCurrentOffset, 1).sequence);
+  }
+
+  // Writes more records than the ring holds and verifies that the oldest are overwritten, and
+  // that records for controllers that do not exist are ignored.
+  TEST_CASE(SharedMemoryOutput_RingWrapAndInvalidController)
+  {
+    std::vector<uint8_t> output(ForceFeedbackOutputSizeBytes(kTestControllerCount));
+    InitializeForceFeedbackOutput(output.data(), kTestControllerCount, 1);
+
+    for (uint32_t i = 0; i < kForceFeedbackOutputSlotCount + 1; ++i)
+      WriteForceFeedbackOutput(output.data(), 1, {.rightMotor = (uint16_t)i}, i);
+
+    WriteForceFeedbackOutput(output.data(), kTestControllerCount, {.leftMotor = 1}, 0);
+
+    const SForceFeedbackOutputHeader& header =
+        *reinterpret_cast<const SForceFeedbackOutputHeader*>(output.data());
+    TEST_ASSERT((kForceFeedbackOutputSlotCount + 1) == header.writeCount);
+
+    const size_t ringOffset = ForceFeedbackOutputRingOffset(kTestControllerCount);
+    TEST_ASSERT((kForceFeedbackOutputSlotCount + 1) == RecordAt(output, ringOffset, 0).sequence);
+    TEST_ASSERT(kForceFeedbackOutputSlotCount == RecordAt(output, ringOffset, 0).actuator[1]);
+    TEST_ASSERT(2 == RecordAt(output, ringOffset, 1).sequence);
+
+    const SForceFeedbackOutputRecord& current =
+        RecordAt(output, kForceFeedbackOutputCurrentOffset, 1);
+    TEST_ASSERT((kForceFeedbackOutputSlotCount + 1) == current.sequence);
+    TEST_ASSERT(kForceFeedbackOutputSlotCount == current.actuator[1]);
+  }
+
+  // Creates the same mapping twice, as two instances would, and verifies that only the first
+  // creation publishes to it and that the second leaves the first one's output untouched.
+  TEST_CASE(SharedMemoryOutput_CreateMappingTwice)
+  {
+    constexpr std::wstring_view kTestMappingName = L"Local\\XidiTestForceFeedbackOutput";
+
+    HANDLE firstMappingHandle = nullptr;
+    void* const firstMappingView = CreateForceFeedbackOutputMapping(
+        kTestMappingName, kTestControllerCount, firstMappingHandle);
+    TEST_ASSERT(nullptr != firstMappingView);
+    TEST_ASSERT(nullptr != firstMappingHandle);
+
+    WriteForceFeedbackOutput(firstMappingView, 1, {.leftMotor = 100, .rightMotor = 200}, 5000);
+
+    HANDLE secondMappingHandle = nullptr;
+    void* const secondMappingView = CreateForceFeedbackOutputMapping(
+        kTestMappingName, kTestControllerCount + 1, secondMappingHandle);
+    TEST_ASSERT(nullptr == secondMappingView);
+    TEST_ASSERT(nullptr == secondMappingHandle);
+
+    const SForceFeedbackOutputHeader& header =
+        *static_cast<const SForceFeedbackOutputHeader*>(firstMappingView);
+    TEST_ASSERT(kForceFeedbackOutputMagic == header.magic);
+    TEST_ASSERT(kTestControllerCount == header.controllerCount);
+    TEST_ASSERT(1 == header.writeCount);
+
+    const SForceFeedbackOutputRecord& current =
+        reinterpret_cast<const SForceFeedbackOutputRecord*>(
+            static_cast<const uint8_t*>(firstMappingView) + kForceFeedbackOutputCurrentOffset)[1];
+    TEST_ASSERT(1 == current.sequence);
+    TEST_ASSERT(100 == current.actuator[0]);
+    TEST_ASSERT(200 == current.actuator[1]);
+
+    UnmapViewOfFile(firstMappingView);
+    CloseHandle(firstMappingHandle);
+  }
+} // namespace XidiTest
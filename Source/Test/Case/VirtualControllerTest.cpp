@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <deque>
 #include <initializer_list>
+#include <limits>
 #include <memory>
 #include <optional>
 
@@ -25,6 +26,7 @@
 #include "ControllerTypes.h"
 #include "ElementMapper.h"
 #include "ForceFeedbackDevice.h"
+#include "InputLatency.h"
 #include "MockPhysicalController.h"
 #include "StateChangeEventBuffer.h"
 
@@ -153,6 +155,51 @@ namespace XidiTest
     return controllerState[kTestSingleAxis];
   }
 
+  /// Transforms a raw axis value by scaling it using integer division, which is the straightforward
+  /// way of applying axis properties. Used as a reference against which to verify the results
+  /// produced by virtual controllers.
+  /// @param [in] axisValueRaw Raw axis value to transform.
+  /// @param [in] axisProperties Axis properties to apply.
+  /// @return Axis value that results from applying the transformation.
+  static int32_t ReferenceTransformAxisValue(
+      int32_t axisValueRaw, const VirtualController::SAxisProperties& axisProperties)
+  {
+    int32_t oldRangeOrigin = 0;
+    int32_t oldRangeDispMax = 0;
+    int32_t newRangeDispMax = 0;
+
+    if (axisValueRaw > Controller::kAnalogValueNeutral)
+    {
+      if (axisValueRaw <= axisProperties.deadzoneRawCutoffPositive)
+        return axisProperties.rangeNeutral;
+      else if (axisValueRaw >= axisProperties.saturationRawCutoffPositive)
+        return axisProperties.rangeMax;
+
+      oldRangeOrigin = axisProperties.deadzoneRawCutoffPositive;
+      oldRangeDispMax = axisProperties.saturationRawCutoffPositive;
+      newRangeDispMax = axisProperties.rangeMax;
+    }
+    else
+    {
+      if (axisValueRaw >= axisProperties.deadzoneRawCutoffNegative)
+        return axisProperties.rangeNeutral;
+      else if (axisValueRaw <= axisProperties.saturationRawCutoffNegative)
+        return axisProperties.rangeMin;
+
+      oldRangeOrigin = axisProperties.deadzoneRawCutoffNegative;
+      oldRangeDispMax = axisProperties.saturationRawCutoffNegative;
+      newRangeDispMax = axisProperties.rangeMin;
+    }
+
+    const int64_t oldRangeValueDisp = (int64_t)axisValueRaw - (int64_t)oldRangeOrigin;
+    const int64_t newRangeMagnitudeMax =
+        (int64_t)newRangeDispMax - (int64_t)axisProperties.rangeNeutral;
+    const int64_t oldRangeMagnitudeMax = (int64_t)oldRangeDispMax - (int64_t)oldRangeOrigin;
+
+    return axisProperties.rangeNeutral +
+        (int32_t)((oldRangeValueDisp * newRangeMagnitudeMax) / oldRangeMagnitudeMax);
+  }
+
   /// Main test body for all axis property tests.
   /// Axis properties are deadzone, range, and saturation. The net result is to divide the expected
   /// output values into 5 regions. Region 1 is the negative saturation region, from extreme
@@ -328,6 +375,26 @@ namespace XidiTest
     }
   }
 
+  // Verifies that a virtual controller whose identifier is beyond the default number of
+  // controllers receives its state from the physical controller interface, as long as the
+  // configured number of controllers covers it.
+  TEST_CASE(VirtualController_GetState_ControllerBeyondDefaultCount)
+  {
+    constexpr TControllerIdentifier kControllerIndex = kMaxControllerCount - 1;
+    constexpr SPhysicalState kPhysicalStates[] = {
+        {.deviceStatus = EPhysicalDeviceStatus::Ok, .button = ButtonSet({EPhysicalButton::A})}};
+    constexpr Controller::SState kExpectedState = {.button = 0b0001};
+
+    MockControllerCount controllerCount(kMaxControllerCount);
+    MockPhysicalController physicalController(
+        kControllerIndex, kTestMapper, kPhysicalStates, _countof(kPhysicalStates));
+    VirtualController controller(kControllerIndex);
+    controller.SetAllAxisRange(Controller::kAnalogValueMin, Controller::kAnalogValueMax);
+
+    const Controller::SState actualState = controller.GetState();
+    TEST_ASSERT(actualState == kExpectedState);
+  }
+
   // Verifies that virtual controllers report everything neutral when no controller input is
   // provided and no properties have been set. In this test case no physical state has been supplied
   // to the virtual controller.
@@ -587,6 +654,66 @@ namespace XidiTest
     }
   }
 
+  // Sweeps combinations of deadzone, saturation, and range, including extreme values and
+  // overlapping deadzone and saturation regions. For every raw axis value, including some just
+  // beyond the analog range, the result is expected to exactly match the reference transformation.
+  TEST_CASE(VirtualController_ApplyAxisProperties_MatchesReference)
+  {
+    constexpr uint32_t kTestDeadzones[] = {
+        VirtualController::kAxisDeadzoneMin,
+        1,
+        DeadzoneValueByPercentage(10),
+        DeadzoneValueByPercentage(50),
+        VirtualController::kAxisDeadzoneMax};
+    constexpr uint32_t kTestSaturations[] = {
+        VirtualController::kAxisSaturationMin,
+        SaturationValueByPercentage(50),
+        SaturationValueByPercentage(90),
+        VirtualController::kAxisSaturationMax - 1,
+        VirtualController::kAxisSaturationMax};
+    constexpr std::pair<int32_t, int32_t> kTestRanges[] = {
+        {Controller::kAnalogValueMin, Controller::kAnalogValueMax},
+        {VirtualController::kRangeMinDefault, VirtualController::kRangeMaxDefault},
+        {-100, 100},
+        {0, 1},
+        {-1, 0},
+        {-10000000, 7},
+        {std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()}};
+
+    MockPhysicalController physicalController(0, kTestSingleAxisMapper);
+    VirtualController controller(0);
+
+    for (const auto& testRange : kTestRanges)
+    {
+      for (const uint32_t testDeadzone : kTestDeadzones)
+      {
+        for (const uint32_t testSaturation : kTestSaturations)
+        {
+          VirtualController::SAxisProperties referenceAxisProperties;
+          referenceAxisProperties.SetRange(testRange.first, testRange.second);
+          referenceAxisProperties.SetDeadzone(testDeadzone);
+          referenceAxisProperties.SetSaturation(testSaturation);
+
+          TEST_ASSERT(
+              true == controller.SetAxisRange(kTestSingleAxis, testRange.first, testRange.second));
+          TEST_ASSERT(true == controller.SetAxisDeadzone(kTestSingleAxis, testDeadzone));
+          TEST_ASSERT(true == controller.SetAxisSaturation(kTestSingleAxis, testSaturation));
+
+          for (int32_t inputAxisValue = Controller::kAnalogValueMin - 2;
+               inputAxisValue <= Controller::kAnalogValueMax + 2;
+               ++inputAxisValue)
+          {
+            const int32_t expectedAxisValue =
+                ReferenceTransformAxisValue(inputAxisValue, referenceAxisProperties);
+            const int32_t actualAxisValue =
+                GetAxisPropertiesApplyResult(controller, inputAxisValue);
+            TEST_ASSERT(actualAxisValue == expectedAxisValue);
+          }
+        }
+      }
+    }
+  }
+
   // Valid deadzone value set on a single axis and then on all axes.
   TEST_CASE(VirtualController_SetProperty_DeadzoneValid)
   {
@@ -993,6 +1120,176 @@ namespace XidiTest
     }
   }
 
+  // Changes buttons on both sides of the boundary between 64-bit words, including the last possible
+  // button, while one of them is filtered out. Events are expected for all of the other buttons, in
+  // order of increasing button number.
+  TEST_CASE(VirtualController_EventBuffer_ButtonsAcrossWords)
+  {
+    constexpr TControllerIdentifier kControllerIndex = 0;
+    constexpr uint32_t kEventBufferCapacity = 64;
+    constexpr EButton kChangedButtons[] = {
+        EButton::B1, EButton::B64, EButton::B65, EButton::B100, EButton::B128};
+    constexpr EButton kFilteredButton = EButton::B65;
+    constexpr EButton kExpectedEventButtons[] = {
+        EButton::B1, EButton::B64, EButton::B100, EButton::B128};
+
+    MockPhysicalController physicalController(kControllerIndex, kTestMapper);
+    VirtualController controller(kControllerIndex);
+
+    controller.SetEventBufferCapacity(kEventBufferCapacity);
+    controller.EventFilterAddAllElements();
+    controller.EventFilterRemoveElement({.type = EElementType::Button, .button = kFilteredButton});
+
+    Controller::SState newState = {};
+    for (const EButton changedButton : kChangedButtons)
+      newState[changedButton] = true;
+
+    TEST_ASSERT(true == controller.RefreshState(newState));
+    TEST_ASSERT(_countof(kExpectedEventButtons) == controller.GetEventBufferCount());
+
+    for (unsigned int i = 0; i < _countof(kExpectedEventButtons); ++i)
+    {
+      const StateChangeEventBuffer::SEventData& eventData = controller.GetEventBufferEvent(i).data;
+      TEST_ASSERT(EElementType::Button == eventData.element.type);
+      TEST_ASSERT(kExpectedEventButtons[i] == eventData.element.button);
+      TEST_ASSERT(true == eventData.value.button);
+    }
+  }
+
+  // Applies externally-supplied input to a virtual controller and verifies that it replaces only
+  // the elements it supplies, that it is not transformed by properties, and that it generates
+  // buffered events just like physical controller state changes.
+  TEST_CASE(VirtualController_EventBuffer_ExternalInput)
+  {
+    constexpr TControllerIdentifier kControllerIndex = 0;
+    constexpr uint32_t kEventBufferCapacity = 64;
+    constexpr int32_t kTestAxisRangeMin = 0;
+    constexpr int32_t kTestAxisRangeMax = 1000;
+    constexpr int32_t kTestAxisRangeNeutral = (kTestAxisRangeMin + kTestAxisRangeMax) / 2;
+
+    constexpr SPhysicalState kPhysicalState = {
+        .deviceStatus = EPhysicalDeviceStatus::Ok, .button = ButtonSet({EPhysicalButton::A})};
+
+    Controller::SStateOverlay externalInput = {};
+    externalInput.values[EAxis::X] = 12345;
+    externalInput.values[EButton::B4] = true;
+    externalInput.values[EPovDirection::Right] = true;
+    externalInput.axisPresent[static_cast<int>(EAxis::X)] = true;
+    externalInput.buttonPresent[static_cast<int>(EButton::B1)] = true;
+    externalInput.buttonPresent[static_cast<int>(EButton::B4)] = true;
+    externalInput.povDirectionPresent[static_cast<int>(EPovDirection::Right)] = true;
+
+    // Values come from the mapper at the top of this file.
+    constexpr Controller::SState kExpectedStateBefore = {
+        .axis =
+            {kTestAxisRangeNeutral,
+             kTestAxisRangeNeutral,
+             0,
+             kTestAxisRangeNeutral,
+             kTestAxisRangeNeutral,
+             0},
+        .button = 0b0001};
+    constexpr Controller::SState kExpectedStateAfter = {
+        .axis = {12345, kTestAxisRangeNeutral, 0, kTestAxisRangeNeutral, kTestAxisRangeNeutral, 0},
+        .button = 0b1000,
+        .povDirection = {.components = {false, false, false, true}}};
+
+    MockPhysicalController physicalController(kControllerIndex, kTestMapper);
+    VirtualController controller(kControllerIndex);
+
+    controller.SetAllAxisRange(kTestAxisRangeMin, kTestAxisRangeMax);
+    TEST_ASSERT(
+        true ==
+        controller.RefreshState(
+            kTestMapper.MapStatePhysicalToVirtual(kPhysicalState, kControllerIndex)));
+    TEST_ASSERT(controller.GetState() == kExpectedStateBefore);
+
+    controller.SetEventBufferCapacity(kEventBufferCapacity);
+    TEST_ASSERT(true == controller.RefreshState(externalInput));
+    TEST_ASSERT(controller.GetState() == kExpectedStateAfter);
+    TEST_ASSERT(false == controller.RefreshState(externalInput));
+
+    // One event each for axis X, button 1, button 4, and the POV.
+    TEST_ASSERT(4 == controller.GetEventBufferCount());
+
+    Controller::SState actualStateFromBufferedEvents = kExpectedStateBefore;
+    for (unsigned int i = 0; i < controller.GetEventBufferCount(); ++i)
+      ApplyUpdateToControllerState(
+          controller.GetEventBufferEvent(i).data, actualStateFromBufferedEvents);
+    TEST_ASSERT(actualStateFromBufferedEvents == kExpectedStateAfter);
+
+    TEST_ASSERT(true == controller.RefreshState(Controller::SStateOverlay()));
+    TEST_ASSERT(controller.GetState() == kExpectedStateBefore);
+  }
+
+  // Supplies a button press and release as two successive externally-supplied inputs, each with
+  // its own timestamp, as happens when a producer writes both to a ring before they are read.
+  // Verifies that both transitions appear in the event buffer with the producer's timestamps.
+  TEST_CASE(VirtualController_EventBuffer_ExternalInputTimestamp)
+  {
+    constexpr TControllerIdentifier kControllerIndex = 1;
+    constexpr uint32_t kEventBufferCapacity = 64;
+    constexpr uint32_t kPressTimestamp = 1000;
+    constexpr uint32_t kReleaseTimestamp = 1003;
+    constexpr Controller::SElementIdentifier kTestButton = {
+        .type = EElementType::Button, .button = EButton::B2};
+
+    Controller::SStateOverlay pressedInput = {};
+    pressedInput.values[EButton::B2] = true;
+    pressedInput.buttonPresent[static_cast<int>(EButton::B2)] = true;
+
+    Controller::SStateOverlay releasedInput = pressedInput;
+    releasedInput.values[EButton::B2] = false;
+
+    MockPhysicalController physicalController(kControllerIndex, kTestMapper);
+    VirtualController controller(kControllerIndex);
+
+    controller.SetEventBufferCapacity(kEventBufferCapacity);
+    TEST_ASSERT(true == controller.RefreshState(pressedInput, kPressTimestamp));
+    TEST_ASSERT(true == controller.RefreshState(releasedInput, kReleaseTimestamp));
+    TEST_ASSERT(2 == controller.GetEventBufferCount());
+
+    const auto& pressEvent = controller.GetEventBufferEvent(0);
+    TEST_ASSERT(pressEvent.data.element == kTestButton);
+    TEST_ASSERT(true == pressEvent.data.value.button);
+    TEST_ASSERT(kPressTimestamp == pressEvent.timestamp);
+
+    const auto& releaseEvent = controller.GetEventBufferEvent(1);
+    TEST_ASSERT(releaseEvent.data.element == kTestButton);
+    TEST_ASSERT(false == releaseEvent.data.value.button);
+    TEST_ASSERT(kReleaseTimestamp == releaseEvent.timestamp);
+  }
+
+  // Supplies externally-supplied input that carries a high-resolution capture time and reads the
+  // virtual controller state several times. Verifies that exactly one latency sample is recorded,
+  // because only the first read after a change observes the new input, and that input without a
+  // capture time does not record any samples.
+  TEST_CASE(VirtualController_ExternalInputLatency)
+  {
+    constexpr TControllerIdentifier kControllerIndex = 2;
+
+    Controller::SStateOverlay pressedInput = {};
+    pressedInput.values[EButton::B2] = true;
+    pressedInput.buttonPresent[static_cast<int>(EButton::B2)] = true;
+
+    Controller::SStateOverlay releasedInput = pressedInput;
+    releasedInput.values[EButton::B2] = false;
+
+    MockPhysicalController physicalController(kControllerIndex, kTestMapper);
+    VirtualController controller(kControllerIndex);
+    InputLatency::ResetSummary(kControllerIndex);
+
+    TEST_ASSERT(
+        true == controller.RefreshState(pressedInput, 1000, InputLatency::CaptureTimeNow()));
+    controller.GetState();
+    controller.GetState();
+    TEST_ASSERT(1 == InputLatency::GetSummary(kControllerIndex).sampleCount);
+
+    TEST_ASSERT(true == controller.RefreshState(releasedInput, 1001, 0));
+    controller.GetState();
+    TEST_ASSERT(1 == InputLatency::GetSummary(kControllerIndex).sampleCount);
+  }
+
   // Submits multiple physical state changes to the physical controller associated with a virtual
   // controller such that every single physical state change causes a virtual controller state
   // change. Enables state change notifications and verifies that each physical controller state
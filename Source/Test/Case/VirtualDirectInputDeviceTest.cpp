@@ -1129,6 +1129,60 @@ namespace XidiTest
             actualDataPacketResult, kExpectedDataPacketResult, sizeof(kExpectedDataPacketResult)));
   }
 
+  // Same as the nominal situation, except the controller's state changes after the data format is
+  // set, both because of new input and because of a property change. Each change is expected to be
+  // reflected in the data packet.
+  TEST_CASE(VirtualDirectInputDevice_GetDeviceState_StateChangedAfterDataFormatSet)
+  {
+    constexpr SPhysicalState kPhysicalState = {
+        .deviceStatus = EPhysicalDeviceStatus::Ok,
+        .stick = {-1234, 0, 5678, 0},
+        .button = ButtonSet({EPhysicalButton::A, EPhysicalButton::X})};
+
+    // Based on the mapper defined at the top of this file. POV is filled in to reflect its centered
+    // state.
+    constexpr STestDataPacket kExpectedDataPacketResult = {
+        .axisX = -1234,
+        .pov = EPovValue::Center,
+        .button = {
+            DataFormat::kButtonValuePressed,
+            DataFormat::kButtonValueNotPressed,
+            DataFormat::kButtonValuePressed,
+            DataFormat::kButtonValueNotPressed}};
+
+    MockPhysicalController physicalController(kTestControllerIdentifier, kTestMapper);
+    VirtualDirectInputDevice<ECharMode::W> diController(CreateTestVirtualController());
+    TEST_ASSERT(DI_OK == diController.SetDataFormat(&kTestFormatSpec));
+
+    STestDataPacket actualDataPacketResult;
+    FillMemory(&actualDataPacketResult, sizeof(actualDataPacketResult), 0xcd);
+    TEST_ASSERT(
+        DI_OK ==
+        diController.GetDeviceState(sizeof(actualDataPacketResult), &actualDataPacketResult));
+    TEST_ASSERT(EPovValue::Center == actualDataPacketResult.pov);
+    TEST_ASSERT(DataFormat::kButtonValueNotPressed == actualDataPacketResult.button[0]);
+
+    diController.GetVirtualController().RefreshState(
+        kTestMapper.MapStatePhysicalToVirtual(kPhysicalState, kTestControllerIdentifier));
+    TEST_ASSERT(
+        DI_OK ==
+        diController.GetDeviceState(sizeof(actualDataPacketResult), &actualDataPacketResult));
+    TEST_ASSERT(
+        0 ==
+        memcmp(
+            &actualDataPacketResult,
+            &kExpectedDataPacketResult,
+            sizeof(kExpectedDataPacketResult)));
+
+    // Shrinking the axis range scales the axis value by the same factor without any new input.
+    TEST_ASSERT(true == diController.GetVirtualController().SetAxisRange(EAxis::X, -100, 100));
+    TEST_ASSERT(
+        DI_OK ==
+        diController.GetDeviceState(sizeof(actualDataPacketResult), &actualDataPacketResult));
+    TEST_ASSERT(actualDataPacketResult.axisX > -100);
+    TEST_ASSERT(actualDataPacketResult.axisX < 0);
+  }
+
   // All inputs are valid except the size of the data packet passed during the method call is
   // smaller than the size that was originally specified. Method is expected to fail.
   TEST_CASE(VirtualDirectInputDevice_GetDeviceState_SizeTooSmall)
@@ -69,6 +69,11 @@ namespace XidiTest
     return contributionIter->second;
   }
 
+  int MockMouse::GetRelativeMovement(EMouseAxis axis) const
+  {
+    return virtualMouseRelativeMovement[(unsigned int)axis];
+  }
+
   void MockMouse::SubmitMouseButtonPressedState(EMouseButton button)
   {
     if ((unsigned int)button >= virtualMouseButtonState.max_size())
@@ -109,6 +114,11 @@ namespace XidiTest
     virtualMouseMovementContributionBySource[(unsigned int)axis][sourceIdentifier] =
         mouseMovementUnits;
   }
+
+  void MockMouse::SubmitMouseRelativeMovement(EMouseAxis axis, int mouseMovementPixels)
+  {
+    virtualMouseRelativeMovement[(unsigned int)axis] += mouseMovementPixels;
+  }
 } // namespace XidiTest
 
 namespace Xidi
@@ -151,5 +161,17 @@ namespace Xidi
 
       capturingVirtualMouse->SubmitMouseMovement(axis, mouseMovementUnits, sourceIdentifier);
     }
+
+    void SubmitMouseRelativeMovement(EMouseAxis axis, int mouseMovementPixels)
+    {
+      std::scoped_lock lock(captureGuard);
+
+      if (nullptr == capturingVirtualMouse)
+        TEST_FAILED_BECAUSE(
+            L"%s: No mock mouse is installed to capture a relative mouse movement event.",
+            __FUNCTIONW__);
+
+      capturingVirtualMouse->SubmitMouseRelativeMovement(axis, mouseMovementPixels);
+    }
   } // namespace Mouse
 } // namespace Xidi
@@ -34,12 +34,30 @@ namespace XidiTest
 
   /// Guards all mock physical state data structures, one per physical controller.
   /// Even in tests, additional threads may exist to wait for state changes.
-  static std::shared_mutex mockPhysicalStateGuard[kPhysicalControllerCount];
+  static std::shared_mutex mockPhysicalStateGuard[kMaxControllerCount];
 
   /// Holds pointers to all mock physical controller objects, one per physical controller.
   /// Each such object governs the behavior of the physical controller interface for a given
   /// physical controller.
-  static MockPhysicalController* mockPhysicalController[kPhysicalControllerCount];
+  static MockPhysicalController* mockPhysicalController[kMaxControllerCount];
+
+  /// Number of controllers reported by the physical controller interface. Tests are written
+  /// against the default number of controllers unless they override it.
+  static TControllerIdentifier mockControllerCount = kDefaultControllerCount;
+
+  MockControllerCount::MockControllerCount(TControllerIdentifier controllerCount)
+      : kPreviousControllerCount(mockControllerCount)
+  {
+    if ((0 == controllerCount) || (controllerCount > kMaxControllerCount))
+      TEST_FAILED_BECAUSE(L"%s: Invalid controller count (%u).", __FUNCTIONW__, controllerCount);
+
+    mockControllerCount = controllerCount;
+  }
+
+  MockControllerCount::~MockControllerCount(void)
+  {
+    mockControllerCount = kPreviousControllerCount;
+  }
 
   MockPhysicalController::MockPhysicalController(
       TControllerIdentifier controllerIdentifier,
@@ -50,12 +68,12 @@ namespace XidiTest
         kMockPhysicalStates(mockPhysicalStates),
         kMockPhysicalStateCount(mockPhysicalStateCount),
         currentPhysicalStateIndex(0),
-        advanceRequested(false),
         forceFeedbackDevice(0),
         mapper(mapper),
+        inputRegistration(),
         forceFeedbackRegistration()
   {
-    if (controllerIdentifier >= kPhysicalControllerCount)
+    if (controllerIdentifier >= GetControllerCount())
       TEST_FAILED_BECAUSE(
           L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -76,18 +94,6 @@ namespace XidiTest
     mockPhysicalController[kControllerIdentifier] = nullptr;
   }
 
-  void MockPhysicalController::AdvancePhysicalState(void)
-  {
-    if (kMockPhysicalStateCount == currentPhysicalStateIndex)
-      TEST_FAILED_BECAUSE(
-          L"%s: Test implementation error due to out-of-bounds physical state advancement for physical controller with identifier %u.",
-          __FUNCTIONW__,
-          kControllerIdentifier);
-
-    currentPhysicalStateIndex += 1;
-    advanceRequested = false;
-  }
-
   SCapabilities MockPhysicalController::GetControllerCapabilities(void) const
   {
     return mapper.GetCapabilities();
@@ -105,6 +111,12 @@ namespace XidiTest
     return mapper.MapStatePhysicalToVirtual(GetCurrentPhysicalState(), kControllerIdentifier);
   }
 
+  void MockPhysicalController::InsertInputRegistration(VirtualController* controllerToRegister)
+  {
+    inputRegistration.insert(controllerToRegister);
+    controllerToRegister->RefreshState(GetCurrentRawVirtualState());
+  }
+
   void MockPhysicalController::RequestAdvancePhysicalState(void)
   {
     std::unique_lock lock(mockPhysicalStateGuard[kControllerIdentifier]);
@@ -115,13 +127,14 @@ namespace XidiTest
           __FUNCTIONW__,
           kControllerIdentifier);
 
-    if (true == advanceRequested)
-      TEST_FAILED_BECAUSE(
-          L"%s: Test implementation error due to unconsumed advance request for physical controller with identifier %u.",
-          __FUNCTIONW__,
-          kControllerIdentifier);
+    currentPhysicalStateIndex += 1;
 
-    advanceRequested = true;
+    const SState newRawVirtualState = GetCurrentRawVirtualState();
+    for (VirtualController* virtualController : inputRegistration)
+    {
+      if (true == virtualController->RefreshState(newRawVirtualState))
+        virtualController->SignalStateChangeEvent();
+    }
   }
 } // namespace XidiTest
 
@@ -133,7 +146,7 @@ namespace Xidi
 
     SCapabilities GetControllerCapabilities(TControllerIdentifier controllerIdentifier)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetControllerCount())
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -148,9 +161,28 @@ namespace Xidi
             controllerIdentifier);
     }
 
+    TControllerIdentifier GetControllerCount(void)
+    {
+      return mockControllerCount;
+    }
+
+    SStateOverlay GetCurrentExternalInputOverlay(
+        TControllerIdentifier controllerIdentifier, uint64_t& sequence)
+    {
+      if (controllerIdentifier >= GetControllerCount())
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      sequence = 0;
+
+      // Mock physical controllers do not supply external input. Tests that exercise external input
+      // do so by refreshing virtual controller state directly.
+      return SStateOverlay();
+    }
+
     SPhysicalState GetCurrentPhysicalControllerState(TControllerIdentifier controllerIdentifier)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetControllerCount())
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -167,7 +199,7 @@ namespace Xidi
 
     SState GetCurrentRawVirtualControllerState(TControllerIdentifier controllerIdentifier)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetControllerCount())
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -182,10 +214,41 @@ namespace Xidi
             controllerIdentifier);
     }
 
+    void PhysicalControllerInputRegister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController)
+    {
+      if (controllerIdentifier >= GetControllerCount())
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      std::unique_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
+
+      if (nullptr != mockPhysicalController[controllerIdentifier])
+        mockPhysicalController[controllerIdentifier]->InsertInputRegistration(virtualController);
+      else
+        TEST_FAILED_BECAUSE(
+            L"%s: No mock physical controller associated with identifier %u.",
+            __FUNCTIONW__,
+            controllerIdentifier);
+    }
+
+    void PhysicalControllerInputUnregister(
+        TControllerIdentifier controllerIdentifier, VirtualController* virtualController)
+    {
+      if (controllerIdentifier >= GetControllerCount())
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      std::unique_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
+
+      if (nullptr != mockPhysicalController[controllerIdentifier])
+        mockPhysicalController[controllerIdentifier]->EraseInputRegistration(virtualController);
+    }
+
     ForceFeedback::Device* PhysicalControllerForceFeedbackRegister(
         TControllerIdentifier controllerIdentifier, const VirtualController* virtualController)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetControllerCount())
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -204,7 +267,7 @@ namespace Xidi
     void PhysicalControllerForceFeedbackUnregister(
         TControllerIdentifier controllerIdentifier, const VirtualController* virtualController)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetControllerCount())
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
@@ -217,77 +280,51 @@ namespace Xidi
       }
     }
 
+    bool WaitForExternalInputChange(
+        TControllerIdentifier controllerIdentifier,
+        uint64_t& sequence,
+        SExternalInput& input,
+        std::stop_token stopToken)
+    {
+      if (controllerIdentifier >= GetControllerCount())
+        TEST_FAILED_BECAUSE(
+            L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
+
+      while (false == stopToken.stop_requested())
+        Sleep(1);
+
+      return false;
+    }
+
     bool WaitForPhysicalControllerStateChange(
         TControllerIdentifier controllerIdentifier,
         SPhysicalState& state,
         std::stop_token stopToken)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetControllerCount())
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
+      // Mock physical state changes are delivered directly to registered virtual controllers, so
+      // there is never anything to wait for.
       while (false == stopToken.stop_requested())
-      {
         Sleep(1);
 
-        if (nullptr != mockPhysicalController[controllerIdentifier])
-        {
-          std::unique_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
-
-          if (nullptr != mockPhysicalController[controllerIdentifier])
-          {
-            if (mockPhysicalController[controllerIdentifier]->IsAdvanceStateRequested())
-            {
-              mockPhysicalController[controllerIdentifier]->AdvancePhysicalState();
-
-              SPhysicalState newState =
-                  mockPhysicalController[controllerIdentifier]->GetCurrentPhysicalState();
-              if (newState != state)
-              {
-                state = newState;
-                return true;
-              }
-            }
-          }
-        }
-      }
-
       return false;
     }
 
     bool WaitForRawVirtualControllerStateChange(
         TControllerIdentifier controllerIdentifier, SState& state, std::stop_token stopToken)
     {
-      if (controllerIdentifier >= kPhysicalControllerCount)
+      if (controllerIdentifier >= GetControllerCount())
         TEST_FAILED_BECAUSE(
             L"%s: Invalid controller identifier (%u).", __FUNCTIONW__, controllerIdentifier);
 
+      // Mock physical state changes are delivered directly to registered virtual controllers, so
+      // there is never anything to wait for.
       while (false == stopToken.stop_requested())
-      {
         Sleep(1);
 
-        if (nullptr != mockPhysicalController[controllerIdentifier])
-        {
-          std::unique_lock lock(mockPhysicalStateGuard[controllerIdentifier]);
-
-          if (nullptr != mockPhysicalController[controllerIdentifier])
-          {
-            if (mockPhysicalController[controllerIdentifier]->IsAdvanceStateRequested())
-            {
-              mockPhysicalController[controllerIdentifier]->AdvancePhysicalState();
-
-              SState newState =
-                  mockPhysicalController[controllerIdentifier]->GetCurrentRawVirtualState();
-              if (newState != state)
-              {
-                state = newState;
-                return true;
-              }
-            }
-          }
-        }
-      }
-
       return false;
     }
   } // namespace Controller
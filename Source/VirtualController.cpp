@@ -11,13 +11,16 @@
 
 #include "VirtualController.h"
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
 #include <cstdint>
-#include <stop_token>
-#include <thread>
+#include <utility>
 
 #include "ControllerTypes.h"
 #include "ForceFeedbackTypes.h"
 #include "ImportApiWinMM.h"
+#include "InputLatency.h"
 #include "Mapper.h"
 #include "Message.h"
 #include "PhysicalController.h"
@@ -26,100 +29,135 @@ namespace Xidi
 {
   namespace Controller
   {
-    /// Maps a value in one range to its corresponding value in another range.
-    /// Ranges are specified as origin values and displacements, essentially one-dimensional vectors
-    /// with direction either positive (maximum displacement value is greater than origin value) or
-    /// negative (maximum displacement value is less than origin value). It is not necessary that
-    /// the direction of the vectors be the same for both old and new range.
-    /// @param [in] oldRangeValue Raw value to transform in the old range.
-    /// @param [in] oldRangeOrigin Origin value of the old range.
-    /// @param [in] oldRangeDispMax Maximum displacement value in the old range.
-    /// @param [in] newRangeOrigin Origin value of the new range.
-    /// @param [in] newRangeDispMax Maximum displacement value in the new range.
-    /// @return Result of mapping the input value from the old range to the new range.
-    static inline int32_t MapValueInRangeToRange(
-        int32_t oldRangeValue,
-        int32_t oldRangeOrigin,
-        int32_t oldRangeDispMax,
-        int32_t newRangeOrigin,
-        int32_t newRangeDispMax)
-    {
-      const int64_t oldRangeValueDisp = (int64_t)oldRangeValue - (int64_t)oldRangeOrigin;
-      const int64_t newRangeMagnitudeMax = (int64_t)newRangeDispMax - (int64_t)newRangeOrigin;
-      const int64_t oldRangeMagnitudeMax = (int64_t)oldRangeDispMax - (int64_t)oldRangeOrigin;
-
-      return newRangeOrigin +
-          (int32_t)((oldRangeValueDisp * newRangeMagnitudeMax) / oldRangeMagnitudeMax);
-    }
-
-    /// Monitors for changes in an associated physical controller's state and, on state change,
-    /// causes a virtual controller to refresh its state. Intended to be the entry point for
-    /// per-virtual-controller background threads.
-    /// @param [in] thisController Controller object for which state is to be monitored.
-    /// @param [in] initialState Initial physical state of the controller. Used as the basis for
-    /// looking for changes.
-    /// @param [in] stopMonitoringToken Used to indicate that the monitoring should stop and the
-    /// thread should exit.
-    static void MonitorPhysicalControllerState(
-        VirtualController* thisController,
-        const SState& initialState,
-        std::stop_token stopMonitoringToken)
-    {
-      const TControllerIdentifier controllerIdentifier = thisController->GetIdentifier();
-      SState state = initialState;
-
-      while (false == stopMonitoringToken.stop_requested())
+    /// Number of bits needed to hold the product of a displacement from a deadzone cutoff and the
+    /// remainder of a ratio whose divisor is a span between cutoffs. Both are at most the largest
+    /// possible span, which is the distance between neutral and the most extreme analog value.
+    static constexpr uint32_t kRemainderProductBits = 30;
+
+    static_assert(
+        ((int64_t)(kAnalogValueNeutral - kAnalogValueMin) *
+         (int64_t)(kAnalogValueNeutral - kAnalogValueMin)) < (1ll << kRemainderProductBits),
+        "Remainder products must fit within the expected number of bits.");
+
+    /// Compiles the coefficients that transform raw values on one side of an axis. Raw values are
+    /// mapped linearly from the region between the deadzone and saturation cutoffs to the region
+    /// between neutral and the extreme of the reportable range, with the result truncated towards
+    /// neutral. The ratio between the two regions is split into a whole part and a remainder, and
+    /// the remainder is divided using a reciprocal that is precise enough to give an exact result
+    /// for every possible product, per Granlund and Montgomery's method of division by invariant
+    /// integers.
+    /// @param [in] direction Direction in which raw values on this side move away from neutral.
+    /// @param [in] deadzoneCutoff Deadzone cutoff on this side of the axis.
+    /// @param [in] saturationCutoff Saturation cutoff on this side of the axis.
+    /// @param [in] rangeNeutral Neutral value for the axis.
+    /// @param [in] rangeExtreme Reportable value for raw values at or beyond the saturation cutoff.
+    /// @return Compiled coefficients.
+    static VirtualController::SAxisTransformSide CompileAxisTransformSide(
+        int32_t direction,
+        int32_t deadzoneCutoff,
+        int32_t saturationCutoff,
+        int32_t rangeNeutral,
+        int32_t rangeExtreme)
+    {
+      // If the deadzone and saturation regions overlap then no raw values are scaled, and a span
+      // of 1 means that every raw value beyond the deadzone cutoff is saturated.
+      const uint64_t span = (uint64_t)std::max<int64_t>(
+          1, (int64_t)direction * ((int64_t)saturationCutoff - (int64_t)deadzoneCutoff));
+      const int64_t rangeMagnitude = (int64_t)rangeExtreme - (int64_t)rangeNeutral;
+      const uint64_t rangeMagnitudeAbsolute =
+          (uint64_t)((rangeMagnitude < 0) ? -rangeMagnitude : rangeMagnitude);
+      const uint32_t reciprocalShift = kRemainderProductBits + (uint32_t)std::bit_width(span - 1);
+
+      return {
+          .deadzoneCutoff = deadzoneCutoff,
+          .direction = direction,
+          .span = (int32_t)span,
+          .quotient = rangeMagnitudeAbsolute / span,
+          .remainder = (uint32_t)(rangeMagnitudeAbsolute % span),
+          .reciprocal = ((1ull << reciprocalShift) + span - 1) / span,
+          .reciprocalShift = reciprocalShift,
+          .negateMask = ((rangeMagnitude < 0) ? -1ll : 0ll)};
+    }
+
+    /// Invokes the specified function once for each bit that is set in a 64-bit word, in order of
+    /// increasing position. Takes time proportional to the number of set bits.
+    /// @param [in] bits Word whose set bits are to be visited.
+    /// @param [in] baseIndex Index that corresponds to the least significant bit of the word.
+    /// @param [in] bitFunction Function to invoke, which receives the index of each set bit.
+    template <typename BitFunction>
+    static inline void ForEachSetBit(uint64_t bits, unsigned int baseIndex, BitFunction bitFunction)
+    {
+      while (0 != bits)
       {
-        if (true ==
-            WaitForRawVirtualControllerStateChange(
-                controllerIdentifier, state, stopMonitoringToken))
-        {
-          if (true == thisController->RefreshState(state)) thisController->SignalStateChangeEvent();
-        }
+        bitFunction(baseIndex + (unsigned int)std::countr_zero(bits));
+        bits &= (bits - 1);
       }
     }
 
     /// Looks for differences between two virtual controller state objects and submits them as
     /// events to the specified event buffer. Events are only submitted if the associated virtual
-    /// controller element is included in the event filter.
+    /// controller element is included in the event filter. Elements are compared many at a time, so
+    /// that the cost depends mostly on the number of elements that changed.
     /// @param [in] oldState Old controller state, the baseline.
     /// @param [in] newState New controller state, which is compared with the old controller state.
     /// If different, controller element values submitted to the event buffer come from this object.
     /// @param [in] eventFilter Filter which specifies which virtual controller elements are allowed
     /// to generate events.
+    /// @param [in] timestamp Timestamp to apply to all submitted events.
     /// @param [in,out] eventBuffer Event buffer object to which events are submitted.
     static inline void SubmitStateChangeEvents(
         const SState& oldState,
         const SState& newState,
         const VirtualController::EventFilter& eventFilter,
+        uint32_t timestamp,
         StateChangeEventBuffer& eventBuffer)
     {
+      static_assert(
+          (unsigned int)EAxis::Count <= 64, "All axes must fit within a single event filter word.");
+
       if (true == eventBuffer.IsEnabled())
       {
-        const uint32_t timestamp = ImportApiWinMM::timeGetTime();
-
+        // Axes are all compared in a single pass with no branches, which produces one bit per axis
+        // that changed.
+        uint64_t axesChanged = 0;
         for (unsigned int i = 0; i < oldState.axis.size(); ++i)
-        {
-          if (oldState.axis[i] != newState.axis[i])
-          {
-            const SElementIdentifier axisElement = {.type = EElementType::Axis, .axis = (EAxis)i};
-
-            if (eventFilter.Contains(axisElement))
+          axesChanged |= ((uint64_t)(oldState.axis[i] != newState.axis[i]) << i);
+
+        ForEachSetBit(
+            axesChanged &
+                eventFilter.GetWord(VirtualController::EventFilter::kBaseIndexAxis),
+            0,
+            [&](unsigned int i) -> void
+            {
               eventBuffer.AppendEvent(
-                  {.element = axisElement, .value = {.axis = newState.axis[i]}}, timestamp);
-          }
-        }
-
-        for (unsigned int i = 0; i < oldState.button.size(); ++i)
+                  {.element = {.type = EElementType::Axis, .axis = (EAxis)i},
+                   .value = {.axis = newState.axis[i]}},
+                  timestamp);
+            });
+
+        // Buttons are compared one 64-bit word at a time, and only the words that contain changes
+        // need to be scanned for set bits.
+        const decltype(SState::button) buttonsChanged = (oldState.button ^ newState.button);
+        if (true == buttonsChanged.any())
         {
-          if (oldState.button[i] != newState.button[i])
+          for (unsigned int wordBase = 0; wordBase < buttonsChanged.size(); wordBase += 64)
           {
-            const SElementIdentifier buttonElement = {
-                .type = EElementType::Button, .button = (EButton)i};
-
-            if (eventFilter.Contains(buttonElement))
-              eventBuffer.AppendEvent(
-                  {.element = buttonElement, .value = {.button = newState.button[i]}}, timestamp);
+            const uint64_t buttonsChangedWord =
+                ((buttonsChanged >> wordBase) & decltype(SState::button)(ULLONG_MAX)).to_ullong();
+            if (0 == buttonsChangedWord) continue;
+
+            ForEachSetBit(
+                buttonsChangedWord &
+                    eventFilter.GetWord(
+                        VirtualController::EventFilter::kBaseIndexButton + wordBase),
+                wordBase,
+                [&](unsigned int i) -> void
+                {
+                  eventBuffer.AppendEvent(
+                      {.element = {.type = EElementType::Button, .button = (EButton)i},
+                       .value = {.button = newState.button[i]}},
+                      timestamp);
+                });
           }
         }
 
@@ -136,68 +174,57 @@ namespace Xidi
       }
     }
 
-    /// Transforms a raw axis value using the supplied axis properties.
+    /// Transforms a raw axis value using the supplied compiled axis properties. Gives exactly the
+    /// same result as scaling the raw value using integer division, but the only branch is the one
+    /// that selects between the transformed and raw values, which compilers can avoid.
     /// @param [in] axisValueRaw Raw axis value as obtained from a mapper.
-    /// @param [in] axisProperties Axis properties to apply.
+    /// @param [in] axisTransform Compiled axis properties to apply.
     /// @return Axis value that results from applying the transformation.
-    static int32_t TransformAxisValue(
-        int32_t axisValueRaw, const VirtualController::SAxisProperties& axisProperties)
+    static inline int32_t TransformAxisValue(
+        int32_t axisValueRaw, const VirtualController::SAxisTransform& axisTransform)
     {
-      if (true != axisProperties.transformationsEnabled) return axisValueRaw;
-
-      if (axisValueRaw > kAnalogValueNeutral)
-      {
-        if (axisValueRaw <= axisProperties.deadzoneRawCutoffPositive)
-          return axisProperties.rangeNeutral;
-        else if (axisValueRaw >= axisProperties.saturationRawCutoffPositive)
-          return axisProperties.rangeMax;
-        else
-          return MapValueInRangeToRange(
-              axisValueRaw,
-              axisProperties.deadzoneRawCutoffPositive,
-              axisProperties.saturationRawCutoffPositive,
-              axisProperties.rangeNeutral,
-              axisProperties.rangeMax);
-      }
-      else
-      {
-        if (axisValueRaw >= axisProperties.deadzoneRawCutoffNegative)
-          return axisProperties.rangeNeutral;
-        else if (axisValueRaw <= axisProperties.saturationRawCutoffNegative)
-          return axisProperties.rangeMin;
-        else
-          return MapValueInRangeToRange(
-              axisValueRaw,
-              axisProperties.deadzoneRawCutoffNegative,
-              axisProperties.saturationRawCutoffNegative,
-              axisProperties.rangeNeutral,
-              axisProperties.rangeMin);
-      }
+      // Raw values beyond the analog range are always saturated, so clamping them first does not
+      // change the result but does prevent overflow.
+      const int32_t axisValue = std::clamp(axisValueRaw, kAnalogValueMin, kAnalogValueMax);
+      const VirtualController::SAxisTransformSide& side =
+          axisTransform.side[(axisValue > kAnalogValueNeutral) ? 1 : 0];
+
+      const uint64_t displacement = (uint64_t)std::clamp(
+          side.direction * (axisValue - side.deadzoneCutoff), 0, side.span);
+      const int64_t magnitude = (int64_t)(
+          (displacement * side.quotient) +
+          (((displacement * side.remainder) * side.reciprocal) >> side.reciprocalShift));
+
+      // Adding as unsigned values wraps around the same way as the reportable range does.
+      const int32_t axisValueTransformed = (int32_t)(
+          (uint32_t)axisTransform.rangeNeutral +
+          (uint32_t)((magnitude ^ side.negateMask) - side.negateMask));
+
+      return ((true == axisTransform.transformationsEnabled) ? axisValueTransformed
+                                                              : axisValueRaw);
     }
 
     VirtualController::VirtualController(TControllerIdentifier controllerId)
         : kControllerIdentifier(controllerId),
+          kCapabilities(GetControllerCapabilities(controllerId)),
           controllerMutex(),
           eventBuffer(),
           eventFilter(),
           properties(),
+          axisTransforms(),
           stateRaw(),
+          stateExternalInput(),
           stateProcessed(),
+          pendingInputCaptureTime(0),
+          processedStateObserver(),
           stateChangeEventHandle(NULL),
-          physicalControllerMonitor(),
-          physicalControllerMonitorStop(),
           physicalControllerForceFeedbackBuffer()
     {
-      const SState initialState = GetCurrentRawVirtualControllerState(kControllerIdentifier);
+      CompileAllAxisTransforms();
 
-      RefreshState(initialState);
-      ReapplyProperties();
-
-      physicalControllerMonitor = std::thread(
-          MonitorPhysicalControllerState,
-          this,
-          initialState,
-          physicalControllerMonitorStop.get_token());
+      // Registering causes this controller's state to be refreshed to match the current input, and
+      // from then on it is refreshed whenever the input changes.
+      PhysicalControllerInputRegister(kControllerIdentifier, this);
 
       Message::OutputFormatted(
           Message::ESeverity::Info,
@@ -208,9 +235,7 @@ namespace Xidi
     VirtualController::~VirtualController(void)
     {
       ForceFeedbackUnregister();
-
-      physicalControllerMonitorStop.request_stop();
-      physicalControllerMonitor.join();
+      PhysicalControllerInputUnregister(kControllerIdentifier, this);
 
       Message::OutputFormatted(
           Message::ESeverity::Info,
@@ -220,15 +245,42 @@ namespace Xidi
 
     void VirtualController::ApplyProperties(SState& controllerState) const
     {
-      const SCapabilities capabilities = GetCapabilities();
-
-      for (int i = 0; i < capabilities.numAxes; ++i)
+      for (int i = 0; i < kCapabilities.numAxes; ++i)
       {
-        const EAxis axis = capabilities.axisCapabilities[i].type;
-        controllerState[axis] = TransformAxisValue(controllerState[axis], properties[axis]);
+        const EAxis axis = kCapabilities.axisCapabilities[i].type;
+        controllerState[axis] =
+            TransformAxisValue(controllerState[axis], axisTransforms[(int)axis]);
       }
     }
 
+    void VirtualController::CompileAxisTransform(EAxis axis)
+    {
+      const SAxisProperties& axisProperties = properties[axis];
+
+      axisTransforms[(int)axis] = {
+          .transformationsEnabled = axisProperties.transformationsEnabled,
+          .rangeNeutral = axisProperties.rangeNeutral,
+          .side = {
+              CompileAxisTransformSide(
+                  -1,
+                  axisProperties.deadzoneRawCutoffNegative,
+                  axisProperties.saturationRawCutoffNegative,
+                  axisProperties.rangeNeutral,
+                  axisProperties.rangeMin),
+              CompileAxisTransformSide(
+                  1,
+                  axisProperties.deadzoneRawCutoffPositive,
+                  axisProperties.saturationRawCutoffPositive,
+                  axisProperties.rangeNeutral,
+                  axisProperties.rangeMax)}};
+    }
+
+    void VirtualController::CompileAllAxisTransforms(void)
+    {
+      for (int i = 0; i < (int)EAxis::Count; ++i)
+        CompileAxisTransform((EAxis)i);
+    }
+
     bool VirtualController::ForceFeedbackRegister(void)
     {
       auto lock = Lock();
@@ -250,12 +302,13 @@ namespace Xidi
 
     SCapabilities VirtualController::GetCapabilities(void) const
     {
-      return GetControllerCapabilities(kControllerIdentifier);
+      return kCapabilities;
     }
 
     SState VirtualController::GetState(void)
     {
       auto lock = Lock();
+      RecordInputLatency();
       return stateProcessed;
     }
 
@@ -265,19 +318,61 @@ namespace Xidi
       eventBuffer.PopOldestEvents(numEventsToPop);
     }
 
+    void VirtualController::RecordInputLatency(void)
+    {
+      const uint32_t captureTime = pendingInputCaptureTime.exchange(0, std::memory_order_relaxed);
+      if (0 == captureTime) return;
+
+      InputLatency::RecordSample(kControllerIdentifier, captureTime);
+    }
+
     void VirtualController::ReapplyProperties(void)
     {
       stateProcessed = stateRaw;
       ApplyProperties(stateProcessed);
+      stateExternalInput.ApplyTo(stateProcessed);
+
+      if (nullptr != processedStateObserver) processedStateObserver(stateProcessed);
     }
 
     bool VirtualController::RefreshState(SState newStateRaw)
     {
       auto lock = Lock();
       stateRaw = newStateRaw;
+      return UpdateProcessedState(ImportApiWinMM::timeGetTime());
+    }
 
-      SState newStateProcessed = newStateRaw;
+    bool VirtualController::RefreshState(const SStateOverlay& newExternalInputOverlay)
+    {
+      return RefreshState(newExternalInputOverlay, ImportApiWinMM::timeGetTime());
+    }
+
+    bool VirtualController::RefreshState(
+        const SStateOverlay& newExternalInputOverlay, uint32_t timestamp)
+    {
+      return RefreshState(newExternalInputOverlay, timestamp, 0);
+    }
+
+    bool VirtualController::RefreshState(
+        const SStateOverlay& newExternalInputOverlay, uint32_t timestamp, uint32_t captureTime)
+    {
+      auto lock = Lock();
+      stateExternalInput = newExternalInputOverlay;
+      if (false == UpdateProcessedState(timestamp)) return false;
+
+      // Latency is measured from the oldest capture that the application has not yet seen, so a
+      // pending capture time is only replaced once it has been recorded.
+      uint32_t noPendingCaptureTime = 0;
+      pendingInputCaptureTime.compare_exchange_strong(
+          noPendingCaptureTime, captureTime, std::memory_order_relaxed);
+      return true;
+    }
+
+    bool VirtualController::UpdateProcessedState(uint32_t timestamp)
+    {
+      SState newStateProcessed = stateRaw;
       ApplyProperties(newStateProcessed);
+      stateExternalInput.ApplyTo(newStateProcessed);
 
       // Based on the mapper and the applied properties, a change in raw virtual controller state
       // might not necessarily mean a change in processed virtual controller state. For example,
@@ -286,8 +381,11 @@ namespace Xidi
       // influence the virtual controller state.
       if (newStateProcessed == stateProcessed) return false;
 
-      SubmitStateChangeEvents(stateProcessed, newStateProcessed, eventFilter, eventBuffer);
+      SubmitStateChangeEvents(
+          stateProcessed, newStateProcessed, eventFilter, timestamp, eventBuffer);
       stateProcessed = newStateProcessed;
+
+      if (nullptr != processedStateObserver) processedStateObserver(stateProcessed);
       return true;
     }
 
@@ -298,6 +396,7 @@ namespace Xidi
         auto lock = Lock();
 
         properties[axis].SetDeadzone(deadzone);
+        CompileAxisTransform(axis);
 
         ReapplyProperties();
         return true;
@@ -313,6 +412,7 @@ namespace Xidi
         auto lock = Lock();
 
         properties[axis].SetRange(rangeMin, rangeMax);
+        CompileAxisTransform(axis);
 
         ReapplyProperties();
         return true;
@@ -328,6 +428,7 @@ namespace Xidi
         auto lock = Lock();
 
         properties[axis].SetSaturation(saturation);
+        CompileAxisTransform(axis);
 
         ReapplyProperties();
         return true;
@@ -341,6 +442,7 @@ namespace Xidi
       auto lock = Lock();
 
       properties[axis].SetTransformationsEnabled(transformationsEnabled);
+      CompileAxisTransform(axis);
 
       ReapplyProperties();
     }
@@ -353,6 +455,7 @@ namespace Xidi
 
         for (auto& axis : properties.axis)
           axis.SetDeadzone(deadzone);
+        CompileAllAxisTransforms();
 
         ReapplyProperties();
         return true;
@@ -369,6 +472,7 @@ namespace Xidi
 
         for (auto& axis : properties.axis)
           axis.SetRange(rangeMin, rangeMax);
+        CompileAllAxisTransforms();
 
         ReapplyProperties();
         return true;
@@ -385,6 +489,7 @@ namespace Xidi
 
         for (auto& axis : properties.axis)
           axis.SetSaturation(saturation);
+        CompileAllAxisTransforms();
 
         ReapplyProperties();
         return true;
@@ -399,6 +504,7 @@ namespace Xidi
 
       for (auto& axis : properties.axis)
         axis.SetTransformationsEnabled(transformationsEnabled);
+      CompileAllAxisTransforms();
 
       ReapplyProperties();
     }
@@ -427,6 +533,14 @@ namespace Xidi
       return false;
     }
 
+    void VirtualController::SetProcessedStateObserver(TProcessedStateObserver observer)
+    {
+      auto lock = Lock();
+      processedStateObserver = std::move(observer);
+
+      if (nullptr != processedStateObserver) processedStateObserver(stateProcessed);
+    }
+
     void VirtualController::SetStateChangeEvent(HANDLE eventHandle)
     {
       stateChangeEventHandle = eventHandle;
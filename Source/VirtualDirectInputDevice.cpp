@@ -13,6 +13,7 @@
 #include "VirtualDirectInputDevice.h"
 
 #include <atomic>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
@@ -41,10 +42,6 @@
 #define _CRT_SECURE_NO_DEPRECATE
 #include <stdio.h>
 
-#include "cJSON.h"
-
-#define BUF_SIZE 1000000
-
 /// Logs a DirectInput interface method invocation and returns.
 #define LOG_INVOCATION_AND_RETURN(result, severity)                                                        \
   do                                                                                                       \
@@ -890,6 +887,7 @@ namespace Xidi
         controller(std::move(controller)),
         cooperativeLevel(ECooperativeLevel::Shared),
         dataFormat(),
+        dataPacket(),
         effectRegistry(),
         refCount(1),
         unusedProperties()
@@ -897,6 +895,9 @@ namespace Xidi
 
   template <ECharMode charMode> VirtualDirectInputDevice<charMode>::~VirtualDirectInputDevice(void)
   {
+    // The virtual controller outlives the data format and the data packet buffer, so it must stop
+    // rendering data packets before they are destroyed.
+    controller->SetProcessedStateObserver(nullptr);
     controller->ForceFeedbackUnregister();
   }
 
@@ -1712,6 +1713,8 @@ namespace Xidi
       LOG_INVOCATION_AND_RETURN(DIERR_NOTBUFFERED, kMethodSeverityForError);
 
     auto lock = controller->Lock();
+    controller->RecordInputLatency();
+
     const DWORD numEventsAffected = std::min(*pdwInOut, (DWORD)controller->GetEventBufferCount());
     const bool eventBufferOverflowed = controller->IsEventBufferOverflowed();
     const bool shouldPopEvents = (0 == (dwFlags & DIGDD_PEEK));
@@ -1778,8 +1781,6 @@ namespace Xidi
     LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
   }
 
-  HANDLE hMapFile;
-  char* jsonBuffer;
   bool runProgramOnce = false;
   
   template <ECharMode charMode> HRESULT VirtualDirectInputDevice<charMode>::GetDeviceState(
@@ -1814,153 +1815,16 @@ namespace Xidi
         (cbData < dataFormat->GetPacketSizeBytes()))
       LOG_INVOCATION_AND_RETURN(DIERR_INVALIDPARAM, kMethodSeverityForError);
 
-    bool writeDataPacketResult = false;
-    {
-      auto lock = controller->Lock();
-
-      Xidi::Controller::SState state = controller->GetState();
-
-      cJSON* jsonArray = cJSON_Parse(jsonBuffer);
-      
-      if (cJSON_GetErrorPtr() == NULL)
-      {
-        if (jsonArray != NULL)
-        {
-          cJSON* jsonObject = cJSON_GetArrayItem(jsonArray, controller->GetIdentifier());
-
-          for (int i=0; i < 128; i++) {
-            cJSON* buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, ("b" + std::to_string(i + 1)).c_str());
-            if (buttonFromJSON != NULL) state.button[(int)(Xidi::Controller::EButton)i] = buttonFromJSON->valueint;
-          }
-
-          cJSON* axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "X");
-          if (axisFromJSON != NULL)
-            state.axis[(int)Xidi::Controller::EAxis::X] = axisFromJSON->valueint;
-          axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Y");
-          if (axisFromJSON != NULL)
-            state.axis[(int)Xidi::Controller::EAxis::Y] = axisFromJSON->valueint;
-          axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Z");
-          if (axisFromJSON != NULL)
-            state.axis[(int)Xidi::Controller::EAxis::Z] = axisFromJSON->valueint;
-          axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "RotX");
-          if (axisFromJSON != NULL)
-            state.axis[(int)Xidi::Controller::EAxis::RotX] = axisFromJSON->valueint;
-          axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "RotY");
-          if (axisFromJSON != NULL)
-            state.axis[(int)Xidi::Controller::EAxis::RotY] = axisFromJSON->valueint;
-          axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "RotZ");
-          if (axisFromJSON != NULL)
-            state.axis[(int)Xidi::Controller::EAxis::RotZ] = axisFromJSON->valueint;
-
-          axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Slider");
-          if (axisFromJSON != NULL)
-            state.axis[(int)Xidi::Controller::EAxis::Slider] = axisFromJSON->valueint;
-
-          axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Dial");
-          if (axisFromJSON != NULL)
-            state.axis[(int)Xidi::Controller::EAxis::Dial] = axisFromJSON->valueint;
-
-          cJSON* directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Up");
-          if (directionFromJSON != NULL)
-            state.povDirection.components[(int)Xidi::Controller::EPovDirection::Up] =
-                directionFromJSON->valueint;
-          directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Down");
-          if (directionFromJSON != NULL)
-            state.povDirection.components[(int)Xidi::Controller::EPovDirection::Down] =
-                directionFromJSON->valueint;
-          directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Left");
-          if (directionFromJSON != NULL)
-            state.povDirection.components[(int)Xidi::Controller::EPovDirection::Left] =
-                directionFromJSON->valueint;
-          directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Right");
-          if (directionFromJSON != NULL)
-            state.povDirection.components[(int)Xidi::Controller::EPovDirection::Right] =
-                directionFromJSON->valueint;
-
-          if (controller->GetIdentifier() == 0)
-          {
-            cJSON* keyboardKeys = cJSON_GetObjectItem(jsonObject, "keyboard");
-
-            if (keyboardKeys != NULL)
-            {
-              cJSON* pressed = cJSON_GetObjectItem(keyboardKeys, "pressed");
-              for (int i = 0; i < cJSON_GetArraySize(pressed); ++i)
-              {
-                cJSON* currentKey = cJSON_GetArrayItem(pressed, i);
-                Xidi::Keyboard::SubmitKeyPressedState(currentKey->valueint);
-              }
-
-              cJSON* released = cJSON_GetObjectItem(keyboardKeys, "released");
-              for (int i = 0; i < cJSON_GetArraySize(released); ++i)
-              {
-                cJSON* currentKey = cJSON_GetArrayItem(released, i);
-                Xidi::Keyboard::SubmitKeyReleasedState(currentKey->valueint);
-              }
-            }
-
-            cJSON* mouseData = cJSON_GetObjectItem(jsonObject, "mouse");
+    // The data packet is rendered whenever the virtual controller's state changes, so supplying it
+    // does not require locking the virtual controller. Any extra space is zeroed, as if the
+    // application's buffer had been written in its entirety.
+    const TOffset packetSizeBytes = dataFormat->GetPacketSizeBytes();
+    controller->RecordInputLatency();
+    dataPacket.Read(lpvData, packetSizeBytes);
+    if (cbData > packetSizeBytes)
+      ZeroMemory(&((uint8_t*)lpvData)[packetSizeBytes], cbData - packetSizeBytes);
 
-            if (mouseData != NULL)
-            {
-              cJSON* isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "left");
-              if (isCurrentKeyPressed != NULL)
-                isCurrentKeyPressed->valueint ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::Left)
-                    : Xidi::Mouse::SubmitMouseButtonReleasedState(Xidi::Mouse::EMouseButton::Left);
-
-              isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "right");
-              if (isCurrentKeyPressed != NULL)
-                isCurrentKeyPressed->valueint
-                    ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::Right)
-                    : Xidi::Mouse::SubmitMouseButtonReleasedState(Xidi::Mouse::EMouseButton::Right);
-
-              isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "x1");
-              if (isCurrentKeyPressed != NULL)
-                isCurrentKeyPressed->valueint
-                    ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::X1)
-                    : Xidi::Mouse::SubmitMouseButtonReleasedState(Xidi::Mouse::EMouseButton::X1);
-
-              isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "x2");
-              if (isCurrentKeyPressed != NULL)
-                isCurrentKeyPressed->valueint
-                    ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::X2)
-                    : Xidi::Mouse::SubmitMouseButtonReleasedState(Xidi::Mouse::EMouseButton::X2);
-
-              isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "middle");
-              if (isCurrentKeyPressed != NULL)
-                isCurrentKeyPressed->valueint
-                    ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::Middle)
-                    : Xidi::Mouse::SubmitMouseButtonReleasedState(Xidi::Mouse::EMouseButton::Middle);
-
-              cJSON* mouseMove = cJSON_GetObjectItemCaseSensitive(mouseData, "mouseMove");
-              if (mouseMove->valueint != 0)
-              {
-                cJSON* mouseX = cJSON_GetObjectItemCaseSensitive(mouseData, "x");
-                Xidi::Mouse::SubmitMouseMovement(Xidi::Mouse::EMouseAxis::X, mouseX->valueint, 0);
-                cJSON* mouseY = cJSON_GetObjectItemCaseSensitive(mouseData, "y");
-                Xidi::Mouse::SubmitMouseMovement(Xidi::Mouse::EMouseAxis::Y, mouseY->valueint, 0);
-
-                cJSON* wheelX = cJSON_GetObjectItemCaseSensitive(mouseData, "wheelX");
-                Xidi::Mouse::SubmitMouseMovement(Xidi::Mouse::EMouseAxis::WheelHorizontal, wheelX->valueint, 0);
-                cJSON* wheelY = cJSON_GetObjectItemCaseSensitive(mouseData, "wheelY");
-                Xidi::Mouse::SubmitMouseMovement(Xidi::Mouse::EMouseAxis::WheelVertical, wheelY->valueint, 0);
-              }   
-            }
-          }
-        }
-      }
-
-      cJSON_Delete(jsonArray);
-
-      if (hMapFile == NULL)
-        hMapFile = OpenFileMapping(FILE_MAP_READ, FALSE, TEXT("Local\\XidiControllers"));
-
-      UnmapViewOfFile(jsonBuffer);
-      jsonBuffer = (char*)MapViewOfFile(hMapFile, FILE_MAP_READ, 0, 0, BUF_SIZE);
-
-      writeDataPacketResult = dataFormat->WriteDataPacket(lpvData, cbData, state);
-    }
-    LOG_INVOCATION_AND_RETURN(
-        ((true == writeDataPacketResult) ? DI_OK : DIERR_INVALIDPARAM), kMethodSeverity);
+    LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
   }
 
   template <ECharMode charMode> HRESULT VirtualDirectInputDevice<charMode>::GetEffectInfo(
@@ -2411,6 +2275,15 @@ namespace Xidi
     }
 
     dataFormat = std::move(newDataFormat);
+
+    // Rendering happens with the virtual controller's lock held, so it never overlaps with the
+    // data format being replaced. Setting the observer also renders the current state right away.
+    controller->SetProcessedStateObserver(
+        [this](const Controller::SState& controllerState) -> void
+        {
+          dataPacket.Render(*dataFormat, controllerState);
+        });
+
     LOG_INVOCATION_AND_RETURN(DI_OK, kMethodSeverity);
   }
 
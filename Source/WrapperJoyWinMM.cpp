@@ -29,13 +29,10 @@
 #include "ImportApiDirectInput.h"
 #include "ImportApiWinMM.h"
 #include "Message.h"
+#include "PhysicalController.h"
 #include "Strings.h"
 #include "VirtualController.h"
 
-#include "cJSON.h"
-
-#define BUF_SIZE 1000000
-
 /// Logs a WinMM device-specific function invocation.
 #define LOG_INVOCATION(severity, joyID, result)                                                    \
   Message::OutputFormatted(                                                                        \
@@ -88,8 +85,9 @@ namespace Xidi
       IDirectInput8* directInputInterface;
     };
 
-    /// Fixed set of virtual controllers.
-    static Controller::VirtualController* controllers[Controller::kPhysicalControllerCount];
+    /// Fixed set of virtual controllers. Only the number of controllers configured at startup are
+    /// used, and the rest are always `nullptr`.
+    static Controller::VirtualController* controllers[Controller::kMaxControllerCount];
 
     /// Maps from application-specified joystick index to the actual indices to present to WinMM or
     /// use internally. Negative values indicate XInput controllers, others indicate values to be
@@ -153,7 +151,7 @@ namespace Xidi
               .value_or(UINT64_MAX);
 
       const size_t numDevicesFromSystem = joySystemDeviceInfo.size();
-      const size_t numXInputVirtualDevices = _countof(controllers);
+      const size_t numXInputVirtualDevices = Controller::GetControllerCount();
       const size_t numDevicesTotal = numDevicesFromSystem + numXInputVirtualDevices;
 
       // Initialize the joystick index map with conservative defaults.
@@ -445,7 +443,7 @@ namespace Xidi
       // These will be in
       // HKCU\System\CurrentControlSet\Control\MediaProperties\PrivateProperties\Joystick\OEM\Xidi#
       // and contain the name of the controller.
-      for (int i = 0; i < _countof(controllers); ++i)
+      for (int i = 0; i < Controller::GetControllerCount(); ++i)
       {
         wchar_t valueData[64];
         const int valueDataCount = FillVirtualControllerName(
@@ -582,7 +580,8 @@ namespace Xidi
                         Strings::kStrConfigurationSettingWorkaroundsActiveVirtualControllerMask)
                     .value_or(UINT64_MAX);
 
-            for (Controller::TControllerIdentifier i = 0; i < _countof(controllers); ++i)
+            for (Controller::TControllerIdentifier i = 0; i < Controller::GetControllerCount();
+                 ++i)
             {
               controllers[i] = nullptr;
 
@@ -732,9 +731,6 @@ namespace Xidi
       return result;
     }
 
-    HANDLE hMapFile;
-    char* jsonBuffer;
-
     MMRESULT JoyGetPos(UINT uJoyID, LPJOYINFO pji)
     {
       Initialize();
@@ -746,186 +742,7 @@ namespace Xidi
         const Controller::TControllerIdentifier xJoyID =
             (Controller::TControllerIdentifier)((-realJoyID) - 1);
 
-        Controller::SState joyStateData = controllers[xJoyID]->GetState();
-
-        cJSON* jsonArray = cJSON_Parse(jsonBuffer);
-
-        if (cJSON_GetErrorPtr() == NULL)
-        {
-          if (jsonArray != NULL)
-          {
-            cJSON* jsonObject = cJSON_GetArrayItem(jsonArray, controllers[xJoyID]->GetIdentifier());
-
-            cJSON* buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b1");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B1] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b2");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B2] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b3");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B3] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b4");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B4] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b5");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B5] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b6");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B6] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b7");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B7] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b8");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B8] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b9");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B9] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b10");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B10] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b11");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B11] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b12");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B12] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b13");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B13] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b14");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B14] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b15");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B15] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b16");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B16] = buttonFromJSON->valueint;
-
-            cJSON* axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "X");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::X] = axisFromJSON->valueint;
-            axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Y");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::Y] = axisFromJSON->valueint;
-            axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Z");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::Z] = axisFromJSON->valueint;
-            axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "RotX");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::RotX] = axisFromJSON->valueint;
-            axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "RotY");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::RotY] = axisFromJSON->valueint;
-            axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "RotZ");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::RotZ] = axisFromJSON->valueint;
-
-            cJSON* directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Up");
-            if (directionFromJSON != NULL)
-              joyStateData.povDirection.components[(int)Xidi::Controller::EPovDirection::Up] =
-                  directionFromJSON->valueint;
-            directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Down");
-            if (directionFromJSON != NULL)
-              joyStateData.povDirection.components[(int)Xidi::Controller::EPovDirection::Down] =
-                  directionFromJSON->valueint;
-            directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Left");
-            if (directionFromJSON != NULL)
-              joyStateData.povDirection.components[(int)Xidi::Controller::EPovDirection::Left] =
-                  directionFromJSON->valueint;
-            directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Right");
-            if (directionFromJSON != NULL)
-              joyStateData.povDirection.components[(int)Xidi::Controller::EPovDirection::Right] =
-                  directionFromJSON->valueint;
-
-            if (controllers[xJoyID]->GetIdentifier() == 0)
-            {
-              cJSON* keyboardKeys = cJSON_GetObjectItem(jsonObject, "keyboard");
-
-              if (keyboardKeys != NULL)
-              {
-                cJSON* pressed = cJSON_GetObjectItem(keyboardKeys, "pressed");
-                for (int i = 0; i < cJSON_GetArraySize(pressed); ++i)
-                {
-                  cJSON* currentKey = cJSON_GetArrayItem(pressed, i);
-                  Xidi::Keyboard::SubmitKeyPressedState(currentKey->valueint);
-                }
-
-                cJSON* released = cJSON_GetObjectItem(keyboardKeys, "released");
-                for (int i = 0; i < cJSON_GetArraySize(released); ++i)
-                {
-                  cJSON* currentKey = cJSON_GetArrayItem(released, i);
-                  Xidi::Keyboard::SubmitKeyReleasedState(currentKey->valueint);
-                }
-              }
-
-              cJSON* mouseData = cJSON_GetObjectItem(jsonObject, "mouse");
-
-              if (mouseData != NULL)
-              {
-                cJSON* isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "left");
-                if (isCurrentKeyPressed != NULL)
-                  isCurrentKeyPressed->valueint
-                      ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::Left)
-                      : Xidi::Mouse::SubmitMouseButtonReleasedState(
-                            Xidi::Mouse::EMouseButton::Left);
-
-                isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "right");
-                if (isCurrentKeyPressed != NULL)
-                  isCurrentKeyPressed->valueint
-                      ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::Right)
-                      : Xidi::Mouse::SubmitMouseButtonReleasedState(
-                            Xidi::Mouse::EMouseButton::Right);
-
-                isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "x1");
-                if (isCurrentKeyPressed != NULL)
-                  isCurrentKeyPressed->valueint
-                      ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::X1)
-                      : Xidi::Mouse::SubmitMouseButtonReleasedState(Xidi::Mouse::EMouseButton::X1);
-
-                isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "x2");
-                if (isCurrentKeyPressed != NULL)
-                  isCurrentKeyPressed->valueint
-                      ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::X2)
-                      : Xidi::Mouse::SubmitMouseButtonReleasedState(Xidi::Mouse::EMouseButton::X2);
-
-                isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "middle");
-                if (isCurrentKeyPressed != NULL)
-                  isCurrentKeyPressed->valueint ? Xidi::Mouse::SubmitMouseButtonPressedState(
-                                                      Xidi::Mouse::EMouseButton::Middle)
-                                                : Xidi::Mouse::SubmitMouseButtonReleasedState(
-                                                      Xidi::Mouse::EMouseButton::Middle);
-
-                cJSON* mouseMove = cJSON_GetObjectItemCaseSensitive(mouseData, "mouseMove");
-                if (mouseMove->valueint != 0)
-                {
-                  cJSON* mouseX = cJSON_GetObjectItemCaseSensitive(mouseData, "x");
-                  Xidi::Mouse::SubmitMouseMovement(Xidi::Mouse::EMouseAxis::X, mouseX->valueint, 0);
-                  cJSON* mouseY = cJSON_GetObjectItemCaseSensitive(mouseData, "y");
-                  Xidi::Mouse::SubmitMouseMovement(Xidi::Mouse::EMouseAxis::Y, mouseY->valueint, 0);
-
-                  cJSON* wheelX = cJSON_GetObjectItemCaseSensitive(mouseData, "wheelX");
-                  Xidi::Mouse::SubmitMouseMovement(
-                      Xidi::Mouse::EMouseAxis::WheelHorizontal, wheelX->valueint, 0);
-                  cJSON* wheelY = cJSON_GetObjectItemCaseSensitive(mouseData, "wheelY");
-                  Xidi::Mouse::SubmitMouseMovement(
-                      Xidi::Mouse::EMouseAxis::WheelVertical, wheelY->valueint, 0);
-                }
-              }
-            }
-          }
-        }
-
-        cJSON_Delete(jsonArray);
-
-        if (hMapFile == NULL)
-          hMapFile = OpenFileMapping(FILE_MAP_READ, FALSE, TEXT("Local\\XidiControllers"));
-
-        UnmapViewOfFile(jsonBuffer);
-        jsonBuffer = (char*)MapViewOfFile(hMapFile, FILE_MAP_READ, 0, 0, BUF_SIZE);
+        const Controller::SState joyStateData = controllers[xJoyID]->GetState();
 
         pji->wXpos = (WORD)joyStateData[Controller::EAxis::X];
         pji->wYpos = (WORD)joyStateData[Controller::EAxis::Y];
@@ -968,186 +785,7 @@ namespace Xidi
           return result;
         }
 
-        Controller::SState joyStateData = controllers[xJoyID]->GetState();
-
-        cJSON* jsonArray = cJSON_Parse(jsonBuffer);
-
-        if (cJSON_GetErrorPtr() == NULL)
-        {
-          if (jsonArray != NULL)
-          {
-            cJSON* jsonObject = cJSON_GetArrayItem(jsonArray, controllers[xJoyID]->GetIdentifier());
-
-            cJSON* buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b1");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B1] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b2");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B2] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b3");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B3] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b4");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B4] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b5");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B5] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b6");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B6] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b7");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B7] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b8");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B8] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b9");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B9] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b10");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B10] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b11");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B11] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b12");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B12] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b13");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B13] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b14");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B14] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b15");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B15] = buttonFromJSON->valueint;
-            buttonFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "b16");
-            if (buttonFromJSON != NULL)
-              joyStateData.button[(int)Xidi::Controller::EButton::B16] = buttonFromJSON->valueint;
-
-            cJSON* axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "X");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::X] = axisFromJSON->valueint;
-            axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Y");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::Y] = axisFromJSON->valueint;
-            axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Z");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::Z] = axisFromJSON->valueint;
-            axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "RotX");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::RotX] = axisFromJSON->valueint;
-            axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "RotY");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::RotY] = axisFromJSON->valueint;
-            axisFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "RotZ");
-            if (axisFromJSON != NULL)
-              joyStateData.axis[(int)Xidi::Controller::EAxis::RotZ] = axisFromJSON->valueint;
-
-            cJSON* directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Up");
-            if (directionFromJSON != NULL)
-              joyStateData.povDirection.components[(int)Xidi::Controller::EPovDirection::Up] =
-                  directionFromJSON->valueint;
-            directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Down");
-            if (directionFromJSON != NULL)
-              joyStateData.povDirection.components[(int)Xidi::Controller::EPovDirection::Down] =
-                  directionFromJSON->valueint;
-            directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Left");
-            if (directionFromJSON != NULL)
-              joyStateData.povDirection.components[(int)Xidi::Controller::EPovDirection::Left] =
-                  directionFromJSON->valueint;
-            directionFromJSON = cJSON_GetObjectItemCaseSensitive(jsonObject, "Right");
-            if (directionFromJSON != NULL)
-              joyStateData.povDirection.components[(int)Xidi::Controller::EPovDirection::Right] =
-                  directionFromJSON->valueint;
-
-            if (controllers[xJoyID]->GetIdentifier() == 0)
-            {
-              cJSON* keyboardKeys = cJSON_GetObjectItem(jsonObject, "keyboard");
-
-              if (keyboardKeys != NULL)
-              {
-                cJSON* pressed = cJSON_GetObjectItem(keyboardKeys, "pressed");
-                for (int i = 0; i < cJSON_GetArraySize(pressed); ++i)
-                {
-                  cJSON* currentKey = cJSON_GetArrayItem(pressed, i);
-                  Xidi::Keyboard::SubmitKeyPressedState(currentKey->valueint);
-                }
-
-                cJSON* released = cJSON_GetObjectItem(keyboardKeys, "released");
-                for (int i = 0; i < cJSON_GetArraySize(released); ++i)
-                {
-                  cJSON* currentKey = cJSON_GetArrayItem(released, i);
-                  Xidi::Keyboard::SubmitKeyReleasedState(currentKey->valueint);
-                }
-              }
-
-              cJSON* mouseData = cJSON_GetObjectItem(jsonObject, "mouse");
-
-              if (mouseData != NULL)
-              {
-                cJSON* isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "left");
-                if (isCurrentKeyPressed != NULL)
-                  isCurrentKeyPressed->valueint
-                      ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::Left)
-                      : Xidi::Mouse::SubmitMouseButtonReleasedState(
-                            Xidi::Mouse::EMouseButton::Left);
-
-                isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "right");
-                if (isCurrentKeyPressed != NULL)
-                  isCurrentKeyPressed->valueint
-                      ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::Right)
-                      : Xidi::Mouse::SubmitMouseButtonReleasedState(
-                            Xidi::Mouse::EMouseButton::Right);
-
-                isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "x1");
-                if (isCurrentKeyPressed != NULL)
-                  isCurrentKeyPressed->valueint
-                      ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::X1)
-                      : Xidi::Mouse::SubmitMouseButtonReleasedState(Xidi::Mouse::EMouseButton::X1);
-
-                isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "x2");
-                if (isCurrentKeyPressed != NULL)
-                  isCurrentKeyPressed->valueint
-                      ? Xidi::Mouse::SubmitMouseButtonPressedState(Xidi::Mouse::EMouseButton::X2)
-                      : Xidi::Mouse::SubmitMouseButtonReleasedState(Xidi::Mouse::EMouseButton::X2);
-
-                isCurrentKeyPressed = cJSON_GetObjectItemCaseSensitive(mouseData, "middle");
-                if (isCurrentKeyPressed != NULL)
-                  isCurrentKeyPressed->valueint ? Xidi::Mouse::SubmitMouseButtonPressedState(
-                                                      Xidi::Mouse::EMouseButton::Middle)
-                                                : Xidi::Mouse::SubmitMouseButtonReleasedState(
-                                                      Xidi::Mouse::EMouseButton::Middle);
-
-                cJSON* mouseMove = cJSON_GetObjectItemCaseSensitive(mouseData, "mouseMove");
-                if (mouseMove->valueint != 0)
-                {
-                  cJSON* mouseX = cJSON_GetObjectItemCaseSensitive(mouseData, "x");
-                  Xidi::Mouse::SubmitMouseMovement(Xidi::Mouse::EMouseAxis::X, mouseX->valueint, 0);
-                  cJSON* mouseY = cJSON_GetObjectItemCaseSensitive(mouseData, "y");
-                  Xidi::Mouse::SubmitMouseMovement(Xidi::Mouse::EMouseAxis::Y, mouseY->valueint, 0);
-
-                  cJSON* wheelX = cJSON_GetObjectItemCaseSensitive(mouseData, "wheelX");
-                  Xidi::Mouse::SubmitMouseMovement(
-                      Xidi::Mouse::EMouseAxis::WheelHorizontal, wheelX->valueint, 0);
-                  cJSON* wheelY = cJSON_GetObjectItemCaseSensitive(mouseData, "wheelY");
-                  Xidi::Mouse::SubmitMouseMovement(
-                      Xidi::Mouse::EMouseAxis::WheelVertical, wheelY->valueint, 0);
-                }
-              }
-            }
-          }
-        }
-
-        cJSON_Delete(jsonArray);
-
-        if (hMapFile == NULL)
-          hMapFile = OpenFileMapping(FILE_MAP_READ, FALSE, TEXT("Local\\XidiControllers"));
-
-        UnmapViewOfFile(jsonBuffer);
-        jsonBuffer = (char*)MapViewOfFile(hMapFile, FILE_MAP_READ, 0, 0, BUF_SIZE);
+        const Controller::SState joyStateData = controllers[xJoyID]->GetState();
 
         const EPovValue joyStateDataPovValue =
             DataFormat::DirectInputPovValue(joyStateData.povDirection);
@@ -18,11 +18,12 @@
 
 #include "ApiWindows.h"
 #include "Configuration.h"
+#include "ControllerTypes.h"
+#include "SharedMemoryTypes.h"
 #include "Strings.h"
 #include "TemporaryBuffer.h"
 
 #ifndef XIDI_SKIP_MAPPERS
-#include "ControllerTypes.h"
 #include "ElementMapper.h"
 #include "Mapper.h"
 #include "MapperBuilder.h"
@@ -73,6 +74,9 @@ namespace Xidi
                   Strings::kStrConfigurationSettingLogEnabled, EValueType::Boolean),
               ConfigurationFileLayoutNameAndValueType(
                   Strings::kStrConfigurationSettingLogLevel, EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingLogPollTimingIntervalSeconds,
+                  EValueType::Integer),
           }),
       ConfigurationFileLayoutSection(
           Strings::kStrConfigurationSectionMapper,
@@ -83,9 +87,22 @@ namespace Xidi
       ConfigurationFileLayoutSection(
           Strings::kStrConfigurationSectionProperties,
           {
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingPropertiesControllerCount, EValueType::Integer),
               ConfigurationFileLayoutNameAndValueType(
                   Strings::kStrConfigurationSettingPropertiesMouseSpeedScalingFactorPercent,
                   EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingPropertiesAdaptivePolling, EValueType::Boolean),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingPropertiesActivePollingPeriodMilliseconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingPropertiesIdlePollingPeriodMilliseconds,
+                  EValueType::Integer),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingPropertiesIdlePollingDelayMilliseconds,
+                  EValueType::Integer),
               ConfigurationFileLayoutNameAndValueType(
                   Strings::kStrConfigurationSettingsPropertiesUseBuiltinProperties,
                   EValueType::Boolean),
@@ -114,6 +131,14 @@ namespace Xidi
                   Strings::kStrConfigurationSettingsPropertiesSaturationPercentTriggerRT,
                   EValueType::Integer),
           }),
+      ConfigurationFileLayoutSection(
+          Strings::kStrConfigurationSectionSharedMemory,
+          {
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingSharedMemoryButtonMerge, EValueType::String),
+              ConfigurationFileLayoutNameAndValueType(
+                  Strings::kStrConfigurationSettingSharedMemoryAxisMerge, EValueType::String),
+          }),
       ConfigurationFileLayoutSection(
           Strings::kStrConfigurationSectionWorkarounds,
           {
@@ -237,6 +262,53 @@ namespace Xidi
   EAction XidiConfigReader::ActionForValue(
       std::wstring_view section, std::wstring_view name, TIntegerView value)
   {
+    if ((Strings::kStrConfigurationSectionProperties == section) &&
+        (Strings::kStrConfigurationSettingPropertiesControllerCount == name))
+    {
+      // At least one controller must be presented, and no more than the maximum number that can
+      // be configured.
+      if ((value < 1) || (value > Controller::kMaxControllerCount))
+        return EAction::Error;
+      else
+        return EAction::Process;
+    }
+
+    if (Strings::kStrConfigurationSectionProperties == section)
+    {
+      if (Strings::kStrConfigurationSettingPropertiesActivePollingPeriodMilliseconds == name)
+      {
+        // Active polling period must be in the range of 1 to 5 inclusive.
+        // This ensures that polling while input is changing is never slower than fixed polling.
+
+        if ((value < 1) || (value > 5))
+          return EAction::Error;
+        else
+          return EAction::Process;
+      }
+      else if (Strings::kStrConfigurationSettingPropertiesIdlePollingPeriodMilliseconds == name)
+      {
+        // Idle polling period must be in the range of 5 to 100 inclusive.
+        // This ensures that polling never becomes so slow that resumed input is noticeably late.
+
+        if ((value < 5) || (value > 100))
+          return EAction::Error;
+        else
+          return EAction::Process;
+      }
+    }
+
+    if ((Strings::kStrConfigurationSectionLog == section) &&
+        (Strings::kStrConfigurationSettingLogPollTimingIntervalSeconds == name))
+    {
+      // Poll timing summary interval must be in the range of 0 to 3600 inclusive.
+      // A value of 0 disables periodic summaries, and anything longer than an hour is not useful.
+
+      if ((value < 0) || (value > 3600))
+        return EAction::Error;
+      else
+        return EAction::Process;
+    }
+
 #ifndef XIDI_SKIP_MAPPERS
     if (Strings::kStrConfigurationSectionProperties == section)
     {
@@ -376,13 +448,23 @@ namespace Xidi
         []() -> void
         {
           // Create the per-controller mapper settings types and submit them to the configuration
-          // file layout. These are gernerated dynamically based on the number of controllers the
-          // system supports.
-          for (Controller::TControllerIdentifier i = 0; i < Controller::kPhysicalControllerCount;
-               ++i)
+          // file layout. These are gernerated dynamically based on the maximum number of
+          // controllers that can be configured.
+          for (Controller::TControllerIdentifier i = 0; i < Controller::kMaxControllerCount; ++i)
             configurationFileLayout[Strings::kStrConfigurationSectionMapper]
                                    [Strings::MapperTypeConfigurationNameString(i)] =
                                        EValueType::String;
+
+          // Likewise for the per-channel and per-axis shared memory settings.
+          for (unsigned int i = 0; i < SharedMemory::kMaxChannelCount; ++i)
+            configurationFileLayout[Strings::kStrConfigurationSectionSharedMemory]
+                                   [Strings::SharedMemoryChannelConfigurationNameString(i)] =
+                                       EValueType::String;
+
+          for (int i = 0; i < static_cast<int>(Controller::EAxis::Count); ++i)
+            configurationFileLayout[Strings::kStrConfigurationSectionSharedMemory]
+                                   [Strings::SharedMemoryAxisMergeConfigurationNameString(
+                                       static_cast<Controller::EAxis>(i))] = EValueType::String;
         });
   }
 